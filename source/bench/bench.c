@@ -0,0 +1,318 @@
+/* -------------------------------------------------------------------------
+ * bench.c
+ * Benchmark of fmusim with a stored baseline, to catch slowdowns.
+ * Command syntax: see printHelp()
+ * Runs fmusim for every scenario of the scenario file, a line
+ *   <name> <arguments of fmusim>
+ * several times, pinned to one processor. Records wall time, steps,
+ * derivative evaluations, result rows per second and peak resident memory
+ * of every scenario in a JSON file, one scenario per line. If a baseline
+ * file of an earlier run is given, the wall times of each scenario are
+ * compared with the baseline: the ratio of the medians gets a bootstrap
+ * confidence interval, and a scenario is flagged as slower if the whole
+ * interval lies above 1 + BENCH_THRESHOLD. Exits with 1 if a scenario is
+ * slower or a run fails.
+ * Linux only: uses fork, sched_setaffinity and wait4.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+#define BUFSIZE 4096
+#define MAX_ARGS 64
+#define MAX_RUNS 100
+#define BENCH_OUTPUT "bench.out"     // output of the last fmusim run
+#define BENCH_RESULT "result.csv"    // written by fmusim
+#define BENCH_RESAMPLES 2000         // bootstrap resamples
+#define BENCH_CONFIDENCE 0.95
+#define BENCH_THRESHOLD 0.02         // relative slowdown that is ignored
+
+typedef struct {
+    char name[BUFSIZE];
+    int nRuns;
+    double wall[MAX_RUNS];           // seconds
+    long steps;
+    long derivatives;
+    long rows;
+    long maxRss;                     // kilobytes, maximum over the runs
+} Result;
+
+static void printHelp(const char* bench) {
+    printf("command syntax: %s <options> <fmusim> <scenarios> <results.json> <baseline.json>\n", bench);
+    printf("   <fmusim> ....... path to the simulator\n");
+    printf("   <scenarios> .... file with one scenario per line: <name> <arguments of fmusim>\n");
+    printf("   <results.json> . file to write the results to\n");
+    printf("   <baseline.json>  results of an earlier run to compare with, optional\n");
+    printf("options, each optional:\n");
+    printf("   -runs <n> ...... runs per scenario, defaults to 10\n");
+    printf("   -cpu <k> ....... processor to pin the runs to, defaults to 0\n");
+}
+
+static double wallClock() {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+}
+
+// -------------------------------------------------------------------------
+// Running
+
+// Run fmusim once with the given arguments, pinned to processor cpu.
+// Returns 0 to indicate error
+static int runOnce(const char* fmusim, char** args, int cpu, Result* r) {
+    pid_t pid;
+    int status, fd;
+    struct rusage usage;
+    cpu_set_t cpus;
+    double start = wallClock();
+    pid = fork();
+    if (pid == 0) {
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        sched_setaffinity(0, sizeof(cpus), &cpus);
+        fd = open(BENCH_OUTPUT, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) _exit(127);
+        dup2(fd, 1);
+        dup2(fd, 2);
+        args[0] = (char*)fmusim;
+        execv(fmusim, args);
+        _exit(127);
+    }
+    if (pid < 0 || wait4(pid, &status, 0, &usage) != pid) {
+        printf("error: Could not run %s\n", fmusim);
+        return 0;
+    }
+    r->wall[r->nRuns++] = wallClock() - start;
+    if (usage.ru_maxrss > r->maxRss) r->maxRss = usage.ru_maxrss;
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        printf("error: Scenario %s failed, see %s\n", r->name, BENCH_OUTPUT);
+        return 0;
+    }
+    return 1; // success
+}
+
+// read steps and derivative evaluations from the summary of the last run,
+// and count the rows of its result file
+static void readCounts(Result* r) {
+    char line[BUFSIZE];
+    int c;
+    FILE* file = fopen(BENCH_OUTPUT, "r");
+    r->steps = r->derivatives = r->rows = 0;
+    while (file && fgets(line, BUFSIZE, file)) {
+        sscanf(line, "  steps ............ %ld", &r->steps);
+        sscanf(line, "  derivatives ...... %ld", &r->derivatives);
+    }
+    if (file) fclose(file);
+    file = fopen(BENCH_RESULT, "r");
+    while (file && (c = fgetc(file)) != EOF) {
+        if (c == '\n') r->rows++;
+    }
+    if (file) fclose(file);
+    if (r->rows > 0) r->rows--; // the header
+}
+
+// Run the scenario of the given line nRuns times.
+// Returns 0 to indicate error
+static int runScenario(const char* fmusim, char* line, int nRuns, int cpu, Result* r) {
+    char* args[MAX_ARGS + 2];
+    int n = 1;
+    int i;
+    char* token = strtok(line, " \t\r\n");
+    memset(r, 0, sizeof(Result));
+    strncpy(r->name, token, BUFSIZE - 1);
+    while (n < MAX_ARGS && (token = strtok(NULL, " \t\r\n"))) args[n++] = token;
+    args[n] = NULL;
+    for (i=0; i<nRuns; i++) {
+        if (!runOnce(fmusim, args, cpu, r)) return 0;
+    }
+    readCounts(r);
+    return 1; // success
+}
+
+// -------------------------------------------------------------------------
+// Statistics
+
+static int compareDouble(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return x < y ? -1 : x > y ? 1 : 0;
+}
+
+static double median(const double* values, int n) {
+    double sorted[MAX_RUNS];
+    memcpy(sorted, values, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), compareDouble);
+    return n % 2 ? sorted[n/2] : (sorted[n/2 - 1] + sorted[n/2]) / 2;
+}
+
+// xorshift generator, seeded for reproducible intervals
+static unsigned long random32(unsigned long* state) {
+    unsigned long x = *state;
+    x ^= (x << 13) & 0xffffffffUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xffffffffUL;
+    return *state = x & 0xffffffffUL;
+}
+
+// median of a sample of n values drawn with replacement
+static double resampledMedian(const double* values, int n, unsigned long* state) {
+    double sample[MAX_RUNS];
+    int i;
+    for (i=0; i<n; i++) sample[i] = values[random32(state) % n];
+    return median(sample, n);
+}
+
+// bootstrap confidence interval [low, high] of the ratio of the median
+// wall times of r and the baseline b
+static void ratioInterval(Result* r, Result* b, double* low, double* high) {
+    static double ratios[BENCH_RESAMPLES];
+    unsigned long state = 2463534242UL;
+    int i;
+    for (i=0; i<BENCH_RESAMPLES; i++) {
+        ratios[i] = resampledMedian(r->wall, r->nRuns, &state)
+                  / resampledMedian(b->wall, b->nRuns, &state);
+    }
+    qsort(ratios, BENCH_RESAMPLES, sizeof(double), compareDouble);
+    *low = ratios[(int)(BENCH_RESAMPLES * (1 - BENCH_CONFIDENCE) / 2)];
+    *high = ratios[(int)(BENCH_RESAMPLES * (1 + BENCH_CONFIDENCE) / 2) - 1];
+}
+
+// -------------------------------------------------------------------------
+// Result files
+
+static void writeResult(FILE* file, Result* r) {
+    int i;
+    double m = median(r->wall, r->nRuns);
+    fprintf(file, "  {\"name\": \"%s\", \"median\": %.6f, \"steps\": %ld, \"derivatives\": %ld, "
+            "\"rows\": %ld, \"rowsPerSecond\": %.1f, \"maxRss\": %ld, \"wall\": [",
+            r->name, m, r->steps, r->derivatives, r->rows, m > 0 ? r->rows / m : 0, r->maxRss);
+    for (i=0; i<r->nRuns; i++) fprintf(file, "%s%.6f", i ? ", " : "", r->wall[i]);
+    fprintf(file, "]}");
+}
+
+// Read the scenario of the given name from a result file written by
+// writeResult. Returns 0 if not found
+static int readResult(const char* path, const char* name, Result* r) {
+    char line[BUFSIZE];
+    char key[BUFSIZE];
+    char* p;
+    char* end;
+    int found = 0;
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+    sprintf(key, "{\"name\": \"%.*s\",", BUFSIZE - 16, name);
+    memset(r, 0, sizeof(Result));
+    while (!found && fgets(line, BUFSIZE, file)) {
+        if (!strstr(line, key) || !(p = strstr(line, "\"wall\": ["))) continue;
+        p += strlen("\"wall\": [");
+        while (r->nRuns < MAX_RUNS) {
+            r->wall[r->nRuns] = strtod(p, &end);
+            if (end == p) break;
+            r->nRuns++;
+            p = end + 1;
+        }
+        found = r->nRuns > 0;
+    }
+    fclose(file);
+    return found;
+}
+
+// -------------------------------------------------------------------------
+// Main
+
+int main(int argc, char *argv[]) {
+    int i, n;
+    int nRuns = 10;
+    int cpu = 0;
+    int nSlower = 0, nFailed = 0, nScenarios = 0;
+    double low, high;
+    char line[BUFSIZE];
+    const char* baseline;
+    FILE* scenarios;
+    FILE* results;
+    Result r, b;
+
+    // parse and remove command line options, leaving the positional arguments
+    for (i=1, n=1; i<argc; i++) {
+        if (argv[i][0] != '-') {
+            argv[n++] = argv[i];
+            continue;
+        }
+        if (i+1 == argc) {
+            printf("error: Missing value of option %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+        if (!strcmp(argv[i], "-runs")) {
+            if (sscanf(argv[++i], "%d", &nRuns) != 1 || nRuns < 2 || nRuns > MAX_RUNS) {
+                printf("error: The given number of runs (%s) is not in 2..%d\n", argv[i], MAX_RUNS);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-cpu")) {
+            if (sscanf(argv[++i], "%d", &cpu) != 1 || cpu < 0) {
+                printf("error: The given processor (%s) is not valid\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            printf("error: Unknown option %s\n", argv[i]);
+            printHelp(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (n < 4) {
+        printHelp(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    baseline = n > 4 ? argv[4] : NULL;
+    scenarios = fopen(argv[2], "r");
+    results = fopen(argv[3], "w");
+    if (!scenarios || !results) {
+        printf("error: Could not open %s or %s\n", argv[2], argv[3]);
+        exit(EXIT_FAILURE);
+    }
+
+    fprintf(results, "{\"runs\": %d, \"cpu\": %d, \"scenarios\": [\n", nRuns, cpu);
+    printf("%-20s %10s %10s %10s %12s %8s  %s\n",
+            "scenario", "median[s]", "steps", "rows", "rows/s", "RSS[kB]", "vs baseline");
+    while (fgets(line, BUFSIZE, scenarios)) {
+        if (line[0] == '#' || strspn(line, " \t\r\n") == strlen(line)) continue;
+        if (!runScenario(argv[1], line, nRuns, cpu, &r)) {
+            nFailed++;
+            continue;
+        }
+        fprintf(results, "%s", nScenarios++ > 0 ? ",\n" : "");
+        writeResult(results, &r);
+        printf("%-20s %10.4f %10ld %10ld %12.0f %8ld", r.name, median(r.wall, r.nRuns),
+                r.steps, r.rows, r.rows / median(r.wall, r.nRuns), r.maxRss);
+        if (baseline && readResult(baseline, r.name, &b)) {
+            ratioInterval(&r, &b, &low, &high);
+            printf("  x%.3f [%.3f, %.3f]", median(r.wall, r.nRuns) / median(b.wall, b.nRuns), low, high);
+            if (low > 1 + BENCH_THRESHOLD) {
+                printf(" SLOWER");
+                nSlower++;
+            }
+            else if (high < 1 - BENCH_THRESHOLD) printf(" faster");
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    fprintf(results, "\n]}\n");
+    fclose(results);
+    fclose(scenarios);
+    printf("%d scenarios, %d failed, %d slower than the baseline, results in %s\n",
+            nScenarios + nFailed, nFailed, nSlower, argv[3]);
+    return nSlower || nFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -46,6 +46,19 @@
 // define initial state vector as vector of value references
 #define STATES { h_, v_ }
 
+// define the table of variables returned by fmiGetModelVariables,
+// in the order of modelDescription.xml
+// fields: name, vr, type, causality, variability, alias, hasStart, start,
+// start of a string, nominal
+#define MODEL_VARIABLES { \
+    { "h",      h_,     fmiTypeReal, fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias,      fmiTrue,  1,    NULL, 1 }, \
+    { "der(h)", der_h_, fmiTypeReal, fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias,      fmiFalse, 0,    NULL, 1 }, \
+    { "v",      v_,     fmiTypeReal, fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias,      fmiFalse, 0,    NULL, 1 }, \
+    { "der(v)", der_v_, fmiTypeReal, fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias,      fmiFalse, 0,    NULL, 1 }, \
+    { "g",      g_,     fmiTypeReal, fmiCausalityInternal, fmiVariabilityParameter,  fmiNegatedAlias, fmiTrue,  9.81, NULL, 1 }, \
+    { "e",      e_,     fmiTypeReal, fmiCausalityInternal, fmiVariabilityParameter,  fmiNoAlias,      fmiTrue,  0.7,  NULL, 1 } \
+}
+
 // called by fmiInstantiateModel
 // Set values for all variables that define a start value
 // Settings used unless changed by fmiSetX before fmiInitialize
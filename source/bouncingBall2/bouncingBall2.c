@@ -0,0 +1,303 @@
+/* ---------------------------------------------------------------------------*
+ * Sample implementation of an FMU of FMI 2.0 Model Exchange - the bouncing
+ * ball of ../bouncingBall, written directly against the FMI 2.0 functions.
+ * Equations:
+ *  der(h) = v;
+ *  der(v) = -g;
+ *  when h<0 then v := -e * v;
+ *  where
+ *    h      height [m], used as state, start = 1
+ *    v      velocity of ball [m/s], used as state
+ *    der(h) velocity of ball [m/s]
+ *    der(v) acceleration of ball [m/s2]
+ *    e      a dimensionless parameter, start = 0.7
+ * FMI 2.0 has no negated aliases, so g is fixed at 9.81 here and not a
+ * variable. The variables and results are those of ../bouncingBall, so
+ * that the FMI 2.0 loader of fmusim can be checked against the FMI 1.0
+ * model. The FMUstate is a copy of the values of the model, and can be
+ * serialized as is.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * ---------------------------------------------------------------------------*/
+
+#include <string.h>
+#include "fmu2.h"
+
+#define MODEL_GUID "{8c4e810f-3df3-4a00-8276-176fa3c9f011}"
+
+// value references, as in ../bouncingBall
+#define h_      0
+#define der_h_  1
+#define v_      2
+#define der_v_  3
+#define e_      4
+#define NUMBER_OF_REALS 5
+#define NUMBER_OF_STATES 2
+
+#define G 9.81
+
+// offset for event indicator, adds hysteresis and prevents z=0 at restart
+#define EPS_INDICATORS 1e-14
+
+// the values of the model, which make up its FMUstate
+typedef struct {
+    fmi2Real r[NUMBER_OF_REALS];
+    fmi2Boolean pos;                 // 1 if h was positive at the last event
+    fmi2Real time;
+} ModelState;
+
+typedef struct {
+    ModelState s;
+    char instanceName[64];
+    const fmi2CallbackFunctions* functions;
+    fmi2Boolean loggingOn;
+} ModelInstance;
+
+#define r(vr) (comp->s.r[vr])
+
+static fmi2Status invalidVr(ModelInstance* comp, const char* f, fmi2ValueReference vr) {
+    comp->functions->logger(comp->functions->componentEnvironment, comp->instanceName,
+            fmi2Error, "error", "%s: Illegal value reference %u.", f, vr);
+    return fmi2Error;
+}
+
+// -------------------------------------------------------------------------
+// Creation and destruction
+
+const char* fmi2GetTypesPlatform() {
+    return "default";
+}
+
+const char* fmi2GetVersion() {
+    return "2.0";
+}
+
+fmi2Status fmi2SetDebugLogging(fmi2Component c, fmi2Boolean loggingOn,
+        size_t nCategories, const fmi2String categories[]) {
+    ((ModelInstance*)c)->loggingOn = loggingOn;
+    return fmi2OK;
+}
+
+fmi2Component fmi2Instantiate(fmi2String instanceName, fmi2Type fmuType, fmi2String fmuGUID,
+        fmi2String fmuResourceLocation, const fmi2CallbackFunctions* functions,
+        fmi2Boolean visible, fmi2Boolean loggingOn) {
+    ModelInstance* comp;
+    if (!functions || !functions->logger || !functions->allocateMemory) return NULL;
+    if (fmuType != fmi2ModelExchange || strcmp(fmuGUID, MODEL_GUID)) {
+        functions->logger(functions->componentEnvironment, instanceName, fmi2Error, "error",
+                "fmi2Instantiate: Wrong GUID %s. Expected %s.", fmuGUID, MODEL_GUID);
+        return NULL;
+    }
+    comp = (ModelInstance*)functions->allocateMemory(1, sizeof(ModelInstance));
+    if (!comp) return NULL;
+    strncpy(comp->instanceName, instanceName, sizeof(comp->instanceName) - 1);
+    comp->functions = functions;
+    comp->loggingOn = loggingOn;
+    r(h_) = 1;
+    r(v_) = 0;
+    r(der_v_) = -G;
+    r(e_) = 0.7;
+    comp->s.pos = r(h_) > 0;
+    return comp;
+}
+
+void fmi2FreeInstance(fmi2Component c) {
+    ModelInstance* comp = (ModelInstance*)c;
+    if (comp) comp->functions->freeMemory(comp);
+}
+
+// -------------------------------------------------------------------------
+// Initialization and modes
+
+fmi2Status fmi2SetupExperiment(fmi2Component c, fmi2Boolean toleranceDefined, fmi2Real tolerance,
+        fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime) {
+    ((ModelInstance*)c)->s.time = startTime;
+    return fmi2OK;
+}
+
+fmi2Status fmi2EnterInitializationMode(fmi2Component c) {
+    return fmi2OK;
+}
+
+fmi2Status fmi2ExitInitializationMode(fmi2Component c) {
+    ModelInstance* comp = (ModelInstance*)c;
+    comp->s.pos = r(h_) > 0;
+    return fmi2OK;
+}
+
+fmi2Status fmi2EnterEventMode(fmi2Component c) {
+    return fmi2OK;
+}
+
+// the ball bounces if it was above the ground at the last event
+fmi2Status fmi2NewDiscreteStates(fmi2Component c, fmi2EventInfo* eventInfo) {
+    ModelInstance* comp = (ModelInstance*)c;
+    memset(eventInfo, 0, sizeof(fmi2EventInfo));
+    if (comp->s.pos && r(h_) <= 0) {
+        r(v_) = - r(e_) * r(v_);
+        eventInfo->valuesOfContinuousStatesChanged = fmi2True;
+    }
+    comp->s.pos = r(h_) > 0;
+    return fmi2OK;
+}
+
+fmi2Status fmi2EnterContinuousTimeMode(fmi2Component c) {
+    return fmi2OK;
+}
+
+fmi2Status fmi2CompletedIntegratorStep(fmi2Component c, fmi2Boolean noSetFMUStatePriorToCurrentPoint,
+        fmi2Boolean* enterEventMode, fmi2Boolean* terminateSimulation) {
+    *enterEventMode = fmi2False;
+    *terminateSimulation = fmi2False;
+    return fmi2OK;
+}
+
+fmi2Status fmi2Terminate(fmi2Component c) {
+    return fmi2OK;
+}
+
+fmi2Status fmi2Reset(fmi2Component c) {
+    ModelInstance* comp = (ModelInstance*)c;
+    memset(&comp->s, 0, sizeof(ModelState));
+    r(h_) = 1;
+    r(der_v_) = -G;
+    r(e_) = 0.7;
+    comp->s.pos = r(h_) > 0;
+    return fmi2OK;
+}
+
+// -------------------------------------------------------------------------
+// Values
+
+fmi2Status fmi2GetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real value[]) {
+    ModelInstance* comp = (ModelInstance*)c;
+    size_t i;
+    for (i=0; i<nvr; i++) {
+        switch (vr[i]) {
+            case h_     : value[i] = r(h_); break;
+            case der_h_ : value[i] = r(v_); break;
+            case v_     : value[i] = r(v_); break;
+            case der_v_ : value[i] = r(der_v_); break;
+            case e_     : value[i] = r(e_); break;
+            default: return invalidVr(comp, "fmi2GetReal", vr[i]);
+        }
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetReal(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real value[]) {
+    ModelInstance* comp = (ModelInstance*)c;
+    size_t i;
+    for (i=0; i<nvr; i++) {
+        if (vr[i] != h_ && vr[i] != v_ && vr[i] != e_) return invalidVr(comp, "fmi2SetReal", vr[i]);
+        r(vr[i]) = value[i];
+    }
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]) {
+    return nvr > 0 ? invalidVr((ModelInstance*)c, "fmi2GetInteger", vr[0]) : fmi2OK;
+}
+
+fmi2Status fmi2SetInteger(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]) {
+    return nvr > 0 ? invalidVr((ModelInstance*)c, "fmi2SetInteger", vr[0]) : fmi2OK;
+}
+
+fmi2Status fmi2GetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]) {
+    return nvr > 0 ? invalidVr((ModelInstance*)c, "fmi2GetBoolean", vr[0]) : fmi2OK;
+}
+
+fmi2Status fmi2SetBoolean(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]) {
+    return nvr > 0 ? invalidVr((ModelInstance*)c, "fmi2SetBoolean", vr[0]) : fmi2OK;
+}
+
+fmi2Status fmi2GetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String value[]) {
+    return nvr > 0 ? invalidVr((ModelInstance*)c, "fmi2GetString", vr[0]) : fmi2OK;
+}
+
+fmi2Status fmi2SetString(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String value[]) {
+    return nvr > 0 ? invalidVr((ModelInstance*)c, "fmi2SetString", vr[0]) : fmi2OK;
+}
+
+// -------------------------------------------------------------------------
+// Continuous states and event indicators
+
+fmi2Status fmi2SetTime(fmi2Component c, fmi2Real time) {
+    ((ModelInstance*)c)->s.time = time;
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetContinuousStates(fmi2Component c, const fmi2Real x[], size_t nx) {
+    ModelInstance* comp = (ModelInstance*)c;
+    r(h_) = x[0];
+    r(v_) = x[1];
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetContinuousStates(fmi2Component c, fmi2Real x[], size_t nx) {
+    ModelInstance* comp = (ModelInstance*)c;
+    x[0] = r(h_);
+    x[1] = r(v_);
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetDerivatives(fmi2Component c, fmi2Real derivatives[], size_t nx) {
+    ModelInstance* comp = (ModelInstance*)c;
+    derivatives[0] = r(v_);
+    derivatives[1] = r(der_v_);
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetEventIndicators(fmi2Component c, fmi2Real eventIndicators[], size_t ni) {
+    ModelInstance* comp = (ModelInstance*)c;
+    eventIndicators[0] = r(h_) + (comp->s.pos ? EPS_INDICATORS : -EPS_INDICATORS);
+    return fmi2OK;
+}
+
+fmi2Status fmi2GetNominalsOfContinuousStates(fmi2Component c, fmi2Real x_nominal[], size_t nx) {
+    x_nominal[0] = 1;
+    x_nominal[1] = 1;
+    return fmi2OK;
+}
+
+// -------------------------------------------------------------------------
+// FMUstate
+
+fmi2Status fmi2GetFMUstate(fmi2Component c, fmi2FMUstate* state) {
+    ModelInstance* comp = (ModelInstance*)c;
+    if (!*state) *state = comp->functions->allocateMemory(1, sizeof(ModelState));
+    if (!*state) return fmi2Error;
+    memcpy(*state, &comp->s, sizeof(ModelState));
+    return fmi2OK;
+}
+
+fmi2Status fmi2SetFMUstate(fmi2Component c, fmi2FMUstate state) {
+    memcpy(&((ModelInstance*)c)->s, state, sizeof(ModelState));
+    return fmi2OK;
+}
+
+fmi2Status fmi2FreeFMUstate(fmi2Component c, fmi2FMUstate* state) {
+    ((ModelInstance*)c)->functions->freeMemory(*state);
+    *state = NULL;
+    return fmi2OK;
+}
+
+fmi2Status fmi2SerializedFMUstateSize(fmi2Component c, fmi2FMUstate state, size_t* size) {
+    *size = sizeof(ModelState);
+    return fmi2OK;
+}
+
+fmi2Status fmi2SerializeFMUstate(fmi2Component c, fmi2FMUstate state, fmi2Byte bytes[], size_t size) {
+    if (size < sizeof(ModelState)) return fmi2Error;
+    memcpy(bytes, state, sizeof(ModelState));
+    return fmi2OK;
+}
+
+fmi2Status fmi2DeSerializeFMUstate(fmi2Component c, const fmi2Byte bytes[], size_t size,
+        fmi2FMUstate* state) {
+    ModelInstance* comp = (ModelInstance*)c;
+    if (size < sizeof(ModelState)) return fmi2Error;
+    *state = comp->functions->allocateMemory(1, sizeof(ModelState));
+    if (!*state) return fmi2Error;
+    memcpy(*state, bytes, sizeof(ModelState));
+    return fmi2OK;
+}
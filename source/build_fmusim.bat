@@ -11,7 +11,7 @@ if defined VS90COMNTOOLS (call "%VS90COMNTOOLS%\vsvars32.bat") else ^
 if defined VS80COMNTOOLS (call "%VS80COMNTOOLS%\vsvars32.bat") else ^
 goto noCompiler
 
-set SRC=main.c xml_parser.c stack.c fmuinit.c fmusim.c fmuio.c fmuzip.c
+set SRC=main.c xml_parser.c stack.c fmuinit.c fmusim.c fmuio.c fmuzip.c solver.c tune.c fmuthread.c fmusched.c timewheel.c cosim.c journal.c sweep.c dataset.c stop.c stats.c counters.c precision.c sink.c csvtable.c input.c fmu2.c trace.c costmodel.c jobs.c diagnostics.c activity.c
 
 rem create fmusim.exe in the fmusim dir
 pushd fmusim
@@ -0,0 +1,654 @@
+/* -------------------------------------------------------------------------
+ * compare.c
+ * Comparison of result files of fmusim with reference results.
+ * Command syntax: see printHelp()
+ * Each pair of files, a reference and a result, is read as a stream, in
+ * blocks of CMP_BLOCK rows of the result. The reference is interpolated
+ * linearly at the times of the result rows. At an event, the reference has
+ * two rows with the same time; a result value there may match either of
+ * them. Columns are matched by name; a column of the result passes if
+ *   |value - reference| <= atol + rtol * |reference|
+ * in every row. The check of a block runs column by column over contiguous
+ * arrays, in loops without branches that the compiler vectorizes. Pairs of
+ * files are compared in parallel on a pool of threads. With fewer pairs
+ * than threads, the columns of a pair are split into groups of at least
+ * CMP_GROUP columns, compared by separate tasks that each stream the pair
+ * but parse only the values of their columns. For each column, the largest
+ * error and the first violation of the tolerance are reported.
+ * Files are CSV files as written by fmusim: the separator is ';' with a
+ * decimal comma, or ',' with a decimal point, and time is the first column.
+ * Binary files written by fmusim -binary are read too, see sink.c; their
+ * String columns are read as NaN.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "fmuthread.h"
+
+#define BUFSIZE 4096
+#define CMP_BLOCK 1024               // result rows checked together
+#define CMP_ATOL 1e-6
+#define CMP_RTOL 1e-4
+#define CMP_GROUP 8                  // minimum number of columns of a task
+#define BINARY_MAGIC "FMUSIMB1"      // see sink.c
+#define BINARY_STRING 3              // type code of String columns
+
+// a CSV or binary result file read row by row
+typedef struct {
+    const char* path;
+    FILE* file;
+    int binary;                      // 1 for a binary file
+    int* types;                      // type code of each column of a binary file
+    char separator;
+    char* line;
+    int size;
+    int nColumns;
+    char** names;
+    char* parse;                     // 1 for the columns to parse, NULL for all
+    double* row;                     // values of the current row
+} ResultStream;
+
+// tolerance of a column given on the command line
+typedef struct {
+    const char* name;
+    double atol;
+    double rtol;
+} Tolerance;
+
+// comparison of one column
+typedef struct {
+    const char* name;
+    int ref;                         // column in the reference, -1 if missing
+    double atol;
+    double rtol;
+    double maxError;
+    double maxTime;                  // time of the largest error
+    long nViolations;
+    double firstTime;                // time of the first violation
+    double firstValue;
+    double firstRef;
+} ColumnResult;
+
+// comparison of a pair of files
+typedef struct {
+    const char* refPath;
+    const char* path;
+    int ok;                          // 1 if all columns pass
+    char message[BUFSIZE];           // why the files could not be compared
+    int nColumns;
+    ColumnResult* columns;
+    long nRows;
+    long nOutside;                   // rows outside the time range of the reference
+} FileResult;
+
+// comparison of a group of columns of a pair of files
+typedef struct {
+    FileResult* f;
+    int first;                       // first column of the group
+    int n;                           // number of columns of the group
+} Task;
+
+// work shared by the threads
+typedef struct {
+    FileResult* files;
+    int nFiles;
+    Task* tasks;
+    int nTasks;
+    int next;                        // index of the next task
+    Mutex mutex;
+    Tolerance* tolerances;
+    int nTolerances;
+    double atol;
+    double rtol;
+} CompareQueue;
+
+static void printHelp(const char* compare) {
+    printf("command syntax: %s <options> <reference> <result> ...\n", compare);
+    printf("   <reference> <result>  pairs of CSV or binary files, as many as needed\n");
+    printf("options, each optional:\n");
+    printf("   -list <file> ... read more pairs from file, one pair per line\n");
+    printf("   -atol <a> ...... absolute tolerance, defaults to %g\n", CMP_ATOL);
+    printf("   -rtol <r> ...... relative tolerance, defaults to %g\n", CMP_RTOL);
+    printf("   -tol <name>:<a>:<r>  tolerances of the named column, may be given several times\n");
+    printf("   -threads <n> ... number of threads, defaults to number of processors\n");
+}
+
+// -------------------------------------------------------------------------
+// Reading
+
+// Read a line of any length into s->line, which is empty for a blank line.
+// Returns 0 at end of file
+static int readLine(ResultStream* s) {
+    int n = 0;
+    int found = 0;
+    char* b;
+    while (fgets(s->line + n, s->size - n, s->file)) {
+        found = 1;
+        n += strlen(s->line + n);
+        if (n > 0 && s->line[n-1] == '\n') break;
+        b = (char*)realloc(s->line, 2 * s->size);
+        if (!b) return 0;
+        s->line = b;
+        s->size *= 2;
+    }
+    while (n > 0 && (s->line[n-1] == '\n' || s->line[n-1] == '\r')) s->line[--n] = '\0';
+    return found;
+}
+
+// Read the header of the binary file s. Returns 0 to indicate error
+static int binaryOpen(ResultStream* s) {
+    int k, n;
+    if (fread(&s->nColumns, sizeof(int), 1, s->file) != 1 || s->nColumns < 0) return 0;
+    s->nColumns++;
+    s->names = (char**)calloc(s->nColumns, sizeof(char*));
+    s->types = (int*)calloc(s->nColumns, sizeof(int));
+    s->row = (double*)calloc(s->nColumns, sizeof(double));
+    if (!s->names || !s->types || !s->row) return 0;
+    s->names[0] = strdup("time");
+    for (k=1; k<s->nColumns; k++) {
+        if (fread(&s->types[k], sizeof(int), 1, s->file) != 1
+                || fread(&n, sizeof(int), 1, s->file) != 1 || n < 0) return 0;
+        s->names[k] = (char*)calloc(n + 1, 1);
+        if (!s->names[k] || (int)fread(s->names[k], 1, n, s->file) != n) return 0;
+    }
+    return 1; // success
+}
+
+// Open the result file at path and read its header.
+// Returns 0 to indicate error, with a message of BUFSIZE chars in message
+static int streamOpen(ResultStream* s, const char* path, char* message) {
+    char* p;
+    char* end;
+    char magic[8];
+    s->path = path;
+    s->size = BUFSIZE;
+    s->file = fopen(path, "rb");
+    s->line = (char*)malloc(s->size);
+    s->binary = s->file && fread(magic, 1, 8, s->file) == 8 && !memcmp(magic, BINARY_MAGIC, 8);
+    if (s->binary) {
+        if (binaryOpen(s)) return 1; // success
+        sprintf(message, "could not read %.*s", BUFSIZE - 32, path);
+        return 0;
+    }
+    if (s->file) rewind(s->file);
+    if (!s->file || !s->line || !readLine(s) || !s->line[0]) {
+        sprintf(message, "could not read %.*s", BUFSIZE - 32, path);
+        return 0;
+    }
+    s->separator = strchr(s->line, ';') ? ';' : strchr(s->line, '\t') ? '\t' : ',';
+    for (p = s->line; p; p = strchr(p, s->separator)) {
+        s->nColumns++;
+        p++;
+    }
+    s->names = (char**)calloc(s->nColumns, sizeof(char*));
+    s->row = (double*)calloc(s->nColumns, sizeof(double));
+    if (!s->names || !s->row) {
+        sprintf(message, "out of memory");
+        return 0;
+    }
+    s->nColumns = 0;
+    for (p = s->line; p; p = end ? end + 1 : NULL) {
+        end = strchr(p, s->separator);
+        if (end) *end = '\0';
+        s->names[s->nColumns++] = strdup(p);
+    }
+    if (strcmp(s->names[0], "time")) {
+        sprintf(message, "first column of %.*s is not time", BUFSIZE - 40, path);
+        return 0;
+    }
+    return 1; // success
+}
+
+// Read the next row of the binary file s into s->row.
+// Returns 0 at end of file, -1 for an incomplete row
+static int binaryNext(ResultStream* s) {
+    int k, n;
+    if (fread(s->row, sizeof(double), 1, s->file) != 1) return 0;
+    for (k=1; k<s->nColumns; k++) {
+        if (s->types[k] == 0) {
+            if (fread(&s->row[k], sizeof(double), 1, s->file) != 1) return -1;
+            continue;
+        }
+        if (fread(&n, sizeof(int), 1, s->file) != 1) return -1;
+        s->row[k] = n;
+        if (s->types[k] != BINARY_STRING) continue;
+        if (n < 0 || fseek(s->file, n, SEEK_CUR)) return -1;
+        s->row[k] = HUGE_VAL - HUGE_VAL; // NaN
+    }
+    return 1;
+}
+
+// Read the next row into s->row, skipping blank lines. Only time and the
+// columns flagged in s->parse are parsed, if given.
+// Returns 0 at end of file, -1 for a row that is not numbers
+static int streamNext(ResultStream* s) {
+    int k;
+    char* p;
+    char* end;
+    if (s->binary) return binaryNext(s);
+    do {
+        if (!readLine(s)) return 0;
+    } while (!s->line[0]);
+    p = s->line;
+    if (s->separator != ',') {
+        for (end = p; *end; end++) if (*end == ',') *end = '.';
+    }
+    for (k=0; k<s->nColumns; k++) {
+        if (k > 0 && s->parse && !s->parse[k]) {
+            end = k+1 < s->nColumns ? strchr(p, s->separator) : p + strlen(p);
+            if (!end) return -1;
+        }
+        else {
+            s->row[k] = strtod(p, &end);
+            if (end == p || *end != (k+1 < s->nColumns ? s->separator : '\0')) return -1;
+        }
+        p = end + 1;
+    }
+    return 1;
+}
+
+static void streamClose(ResultStream* s) {
+    int k;
+    if (s->file) fclose(s->file);
+    for (k=0; s->names && k<s->nColumns; k++) free(s->names[k]);
+    if (s->names) free(s->names);
+    if (s->types) free(s->types);
+    if (s->parse) free(s->parse);
+    if (s->row) free(s->row);
+    if (s->line) free(s->line);
+}
+
+// -------------------------------------------------------------------------
+// Checking
+
+// Compute the error of n values v against the candidates a and b of the
+// reference, and the excess over the tolerance: positive if violated.
+// The reference value nearer to v is stored in a.
+static void checkColumn(const double* v, double* a, const double* b, double* error,
+        double* excess, int n, double atol, double rtol) {
+    int i;
+    for (i=0; i<n; i++) {
+        double ea = fabs(v[i] - a[i]);
+        double eb = fabs(v[i] - b[i]);
+        double e = ea < eb ? ea : eb;
+        double r = ea < eb ? a[i] : b[i];
+        error[i] = e;
+        excess[i] = e - atol - rtol * fabs(r);
+        a[i] = r;
+    }
+}
+
+// Add the errors of a block of n rows at the given times to column c
+static void collect(ColumnResult* c, const double* times, const double* v, const double* r,
+        const double* error, const double* excess, int n) {
+    int i;
+    for (i=0; i<n; i++) {
+        int bothNaN = v[i] != v[i] && r[i] != r[i];
+        int violated = bothNaN ? 0 : !(excess[i] <= 0); // NaN violates
+        if (!bothNaN && !(error[i] <= c->maxError)) {
+            c->maxError = error[i] == error[i] ? error[i] : HUGE_VAL;
+            c->maxTime = times[i];
+        }
+        if (violated && c->nViolations++ == 0) {
+            c->firstTime = times[i];
+            c->firstValue = v[i];
+            c->firstRef = r[i];
+        }
+    }
+}
+
+// Match the columns of the result file of f with its reference.
+// Returns 0 to indicate error, with a message in f
+static int matchColumns(CompareQueue* q, FileResult* f) {
+    ResultStream ref, res;
+    int i, k;
+    int ok = 0;
+    memset(&ref, 0, sizeof(ResultStream));
+    memset(&res, 0, sizeof(ResultStream));
+    if (streamOpen(&ref, f->refPath, f->message) && streamOpen(&res, f->path, f->message)) {
+        f->nColumns = res.nColumns - 1;
+        f->columns = (ColumnResult*)calloc(f->nColumns + 1, sizeof(ColumnResult));
+        if (f->columns) ok = 1;
+        else sprintf(f->message, "out of memory");
+    }
+    for (k=0; ok && k<f->nColumns; k++) {
+        ColumnResult* c = &f->columns[k];
+        c->name = strdup(res.names[k+1]);
+        c->ref = -1;
+        c->atol = q->atol;
+        c->rtol = q->rtol;
+        for (i=1; i<ref.nColumns; i++) {
+            if (!strcmp(ref.names[i], c->name)) c->ref = i;
+        }
+        for (i=0; i<q->nTolerances; i++) {
+            if (strcmp(q->tolerances[i].name, c->name)) continue;
+            c->atol = q->tolerances[i].atol;
+            c->rtol = q->tolerances[i].rtol;
+        }
+    }
+    streamClose(&ref);
+    streamClose(&res);
+    return ok;
+}
+
+// Compare the columns of task t with the reference, streaming both files.
+// Only the task of the first group counts the rows.
+static void compareFiles(CompareQueue* q, Task* t) {
+    FileResult* f = t->f;
+    ColumnResult* columns = f->columns + t->first;
+    ResultStream ref, res;
+    int k, n, status;
+    double* mem;
+    double *times, *values, *a, *b, *error, *excess;
+    double *prev, *prev2, *next;     // reference rows around the current time
+    int hasNext, hasPrev = 0, hasPrev2 = 0;
+    int refOk = 1;
+    long nRows = 0, nOutside = 0;
+    char message[BUFSIZE];
+    message[0] = '\0';
+    memset(&ref, 0, sizeof(ResultStream));
+    memset(&res, 0, sizeof(ResultStream));
+    mem = NULL;
+    if (!streamOpen(&ref, f->refPath, message) || !streamOpen(&res, f->path, message)) {
+        goto done;
+    }
+    if (res.nColumns != f->nColumns + 1) {
+        sprintf(message, "%.*s changed while being compared", BUFSIZE - 40, f->path);
+        goto done;
+    }
+
+    // parse only time and the columns of the group
+    ref.parse = (char*)calloc(ref.nColumns, sizeof(char));
+    res.parse = (char*)calloc(res.nColumns, sizeof(char));
+    mem = (double*)malloc(((size_t)6 * CMP_BLOCK * (t->n + 1) + 3 * ref.nColumns)
+            * sizeof(double));
+    if (!ref.parse || !res.parse || !mem) {
+        sprintf(message, "out of memory");
+        goto done;
+    }
+    for (k=0; k<t->n; k++) {
+        res.parse[t->first + k + 1] = 1;
+        if (columns[k].ref >= 0) ref.parse[columns[k].ref] = 1;
+    }
+    times = mem;
+    values = times + CMP_BLOCK;      // column-major: CMP_BLOCK values per column
+    a = values + (size_t)CMP_BLOCK * t->n;
+    b = a + (size_t)CMP_BLOCK * t->n;
+    error = b + (size_t)CMP_BLOCK * t->n;
+    excess = error + CMP_BLOCK;
+    prev = excess + CMP_BLOCK;
+    prev2 = prev + ref.nColumns;
+    next = prev2 + ref.nColumns;
+
+    hasNext = streamNext(&ref) == 1;
+    if (hasNext) memcpy(next, ref.row, ref.nColumns * sizeof(double));
+    for (status = 1; status == 1; ) {
+        // read a block of result rows, and the reference values at their times
+        for (n=0; n<CMP_BLOCK && (status = streamNext(&res)) == 1; ) {
+            double time = res.row[0];
+            double w;
+            // prev becomes the last reference row at or before time
+            while (hasNext && next[0] <= time) {
+                if (hasPrev) memcpy(prev2, prev, ref.nColumns * sizeof(double));
+                hasPrev2 = hasPrev;
+                memcpy(prev, next, ref.nColumns * sizeof(double));
+                hasPrev = 1;
+                refOk = (status = streamNext(&ref)) >= 0;
+                hasNext = status == 1;
+                if (hasNext) memcpy(next, ref.row, ref.nColumns * sizeof(double));
+                status = 1;
+            }
+            if (!refOk) break;
+            if (!hasPrev || (!hasNext && time > prev[0])) {
+                nOutside++;
+                continue;
+            }
+            w = hasNext && next[0] > prev[0] ? (time - prev[0]) / (next[0] - prev[0]) : 0;
+            times[n] = time;
+            for (k=0; k<t->n; k++) {
+                ColumnResult* c = &columns[k];
+                size_t j = (size_t)k * CMP_BLOCK + n;
+                if (c->ref < 0) continue;
+                values[j] = res.row[t->first + k + 1];
+                a[j] = w > 0 ? prev[c->ref] + w * (next[c->ref] - prev[c->ref]) : prev[c->ref];
+                // at an event, the row before the event is a candidate too
+                b[j] = hasPrev2 && prev2[0] == time ? prev2[c->ref] : a[j];
+            }
+            n++;
+        }
+        if (!refOk || status < 0) {
+            sprintf(message, "%s has a row that is not numbers or incomplete",
+                    refOk ? "result" : "reference");
+            break;
+        }
+        for (k=0; k<t->n; k++) {
+            ColumnResult* c = &columns[k];
+            size_t j = (size_t)k * CMP_BLOCK;
+            if (c->ref < 0) continue;
+            checkColumn(values + j, a + j, b + j, error, excess, n, c->atol, c->rtol);
+            collect(c, times, values + j, a + j, error, excess, n);
+        }
+        nRows += n;
+    }
+    if (t->first == 0) {
+        f->nRows = nRows;
+        f->nOutside = nOutside;
+    }
+done:
+    // the groups of a file share its message
+    if (message[0]) {
+        mutexLock(&q->mutex);
+        if (!f->message[0]) strcpy(f->message, message);
+        mutexUnlock(&q->mutex);
+    }
+    if (mem) free(mem);
+    streamClose(&ref);
+    streamClose(&res);
+}
+
+static void compareWorker(void* arg) {
+    CompareQueue* q = (CompareQueue*)arg;
+    Task* t;
+    for (;;) {
+        mutexLock(&q->mutex);
+        t = q->next < q->nTasks ? &q->tasks[q->next++] : NULL;
+        mutexUnlock(&q->mutex);
+        if (!t) return;
+        compareFiles(q, t);
+    }
+}
+
+// Split the columns of the files into tasks, in groups of at least CMP_GROUP
+// columns when there are fewer files than threads.
+// Returns 0 to indicate error
+static int splitTasks(CompareQueue* q, int nThreads) {
+    int i, k, g, nGroups;
+    int perFile = (nThreads + q->nFiles - 1) / q->nFiles;
+    q->tasks = (Task*)calloc((size_t)q->nFiles * perFile, sizeof(Task));
+    if (!q->tasks) return 0;
+    for (i=0; i<q->nFiles; i++) {
+        FileResult* f = &q->files[i];
+        if (!matchColumns(q, f)) continue;
+        nGroups = f->nColumns / CMP_GROUP;
+        if (nGroups > perFile) nGroups = perFile;
+        if (nGroups < 1) nGroups = 1;
+        for (g=0, k=0; g<nGroups; g++) {
+            Task* t = &q->tasks[q->nTasks++];
+            t->f = f;
+            t->first = k;
+            t->n = (f->nColumns - k) / (nGroups - g);
+            k += t->n;
+        }
+    }
+    return 1; // success
+}
+
+// Set f->ok from the results of its columns
+static void setVerdict(FileResult* f) {
+    int k, nc = 0;
+    f->ok = 0;
+    if (f->message[0]) return;
+    f->ok = 1;
+    for (k=0; k<f->nColumns; k++) {
+        if (f->columns[k].ref < 0 || f->columns[k].nViolations > 0) f->ok = 0;
+        else nc++;
+    }
+    if (nc == 0 && f->nColumns > 0) f->ok = 0;
+}
+
+// -------------------------------------------------------------------------
+// Main
+
+static void printResult(FileResult* f) {
+    int k;
+    printf("%s %s %s\n", f->ok ? "PASS" : "FAIL", f->refPath, f->path);
+    if (f->message[0]) {
+        printf("  error: %s\n", f->message);
+        return;
+    }
+    printf("  %ld rows compared", f->nRows);
+    if (f->nOutside > 0) printf(", %ld rows outside the time range of the reference", f->nOutside);
+    printf("\n");
+    for (k=0; k<f->nColumns; k++) {
+        ColumnResult* c = &f->columns[k];
+        if (c->ref < 0) {
+            printf("  %-24s missing in reference\n", c->name);
+            continue;
+        }
+        printf("  %-24s max error %-12.4g at t=%-12g", c->name, c->maxError, c->maxTime);
+        if (c->nViolations > 0) {
+            printf(" %ld violations, first at t=%.16g: %.16g, reference %.16g",
+                    c->nViolations, c->firstTime, c->firstValue, c->firstRef);
+        }
+        printf("\n");
+    }
+}
+
+// Add the pair of files to q. Returns 0 to indicate error
+static int addPair(CompareQueue* q, const char* refPath, const char* path) {
+    FileResult* files = (FileResult*)realloc(q->files, (q->nFiles + 1) * sizeof(FileResult));
+    if (!files) return 0;
+    q->files = files;
+    memset(&files[q->nFiles], 0, sizeof(FileResult));
+    files[q->nFiles].refPath = strdup(refPath);
+    files[q->nFiles].path = strdup(path);
+    q->nFiles++;
+    return 1; // success
+}
+
+// Returns 0 to indicate error
+static int readList(CompareQueue* q, const char* path) {
+    char line[BUFSIZE];
+    char refPath[BUFSIZE];
+    char resPath[BUFSIZE];
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("error: Could not open list %s\n", path);
+        return 0;
+    }
+    while (fgets(line, BUFSIZE, file)) {
+        if (sscanf(line, "%s %s", refPath, resPath) != 2) continue;
+        if (!addPair(q, refPath, resPath)) return 0;
+    }
+    fclose(file);
+    return 1; // success
+}
+
+int main(int argc, char *argv[]) {
+    int i, n, nFailed = 0;
+    int nThreads = threadCount();
+    Thread* threads;
+    CompareQueue q;
+    char* p;
+
+    memset(&q, 0, sizeof(CompareQueue));
+    q.atol = CMP_ATOL;
+    q.rtol = CMP_RTOL;
+    q.tolerances = (Tolerance*)calloc(argc, sizeof(Tolerance));
+    for (i=1, n=1; i<argc; i++) {
+        if (argv[i][0] != '-') {
+            argv[n++] = argv[i];
+            continue;
+        }
+        if (i+1 == argc) {
+            printf("error: Missing value of option %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+        if (!strcmp(argv[i], "-list")) {
+            if (!readList(&q, argv[++i])) exit(EXIT_FAILURE);
+        }
+        else if (!strcmp(argv[i], "-atol")) {
+            if (sscanf(argv[++i], "%lf", &q.atol) != 1 || q.atol < 0) {
+                printf("error: The given absolute tolerance (%s) is not valid\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-rtol")) {
+            if (sscanf(argv[++i], "%lf", &q.rtol) != 1 || q.rtol < 0) {
+                printf("error: The given relative tolerance (%s) is not valid\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-tol")) {
+            Tolerance* t = &q.tolerances[q.nTolerances++];
+            t->name = argv[++i];
+            p = strrchr(argv[i], ':');
+            if (p) *p = '\0';
+            if (!p || sscanf(p+1, "%lf", &t->rtol) != 1 || !(p = strrchr(argv[i], ':'))
+                    || sscanf(p+1, "%lf", &t->atol) != 1) {
+                printf("error: The given tolerance (%s) is not <name>:<a>:<r>\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+            *p = '\0';
+        }
+        else if (!strcmp(argv[i], "-threads")) {
+            if (sscanf(argv[++i], "%d", &nThreads) != 1 || nThreads <= 0) {
+                printf("error: The given number of threads (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            printf("error: Unknown option %s\n", argv[i]);
+            printHelp(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (n % 2 == 0) {
+        printf("error: %s has no result to compare with\n", argv[n-1]);
+        exit(EXIT_FAILURE);
+    }
+    for (i=1; i<n; i+=2) {
+        if (!addPair(&q, argv[i], argv[i+1])) exit(EXIT_FAILURE);
+    }
+    if (q.nFiles == 0) {
+        printHelp(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    // compare the pairs on a pool of threads
+    if (!splitTasks(&q, nThreads)) {
+        printf("error: Out of memory\n");
+        exit(EXIT_FAILURE);
+    }
+    if (nThreads > q.nTasks) nThreads = q.nTasks;
+    threads = (Thread*)calloc(nThreads, sizeof(Thread));
+    mutexInit(&q.mutex);
+    for (i=1; i<nThreads; i++) {
+        if (!threadCreate(&threads[i], compareWorker, &q)) break;
+    }
+    compareWorker(&q);
+    while (--i > 0) threadJoin(threads[i]);
+    mutexFree(&q.mutex);
+
+    for (i=0; i<q.nFiles; i++) {
+        setVerdict(&q.files[i]);
+        printResult(&q.files[i]);
+        if (!q.files[i].ok) nFailed++;
+    }
+    printf("%d of %d comparisons failed\n", nFailed, q.nFiles);
+    return nFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
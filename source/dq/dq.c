@@ -33,6 +33,16 @@
 // define state vector as vector of value references
 #define STATES { x_ }
 
+// define the table of variables returned by fmiGetModelVariables,
+// in the order of modelDescription.xml
+// fields: name, vr, type, causality, variability, alias, hasStart, start,
+// start of a string, nominal
+#define MODEL_VARIABLES { \
+    { "x",      x_,     fmiTypeReal, fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias, fmiTrue,  1, NULL, 1 }, \
+    { "der(x)", der_x_, fmiTypeReal, fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias, fmiFalse, 0, NULL, 1 }, \
+    { "k",      k_,     fmiTypeReal, fmiCausalityInternal, fmiVariabilityParameter,  fmiNoAlias, fmiTrue,  1, NULL, 1 } \
+}
+
 // called by fmiInstantiateModel
 // Set values for all variables that define a start value
 // Settings used unless changed by fmiSetX before fmiInitialize
@@ -0,0 +1,339 @@
+/* -------------------------------------------------------------------------
+ * activity.c
+ * Activity of the variables of a simulation result.
+ * An activity sink follows each column of the rows it receives: the number
+ * of changes of its value and, for numbers, its range and its variation,
+ * the sum of the changes from row to row. The time scale of a column is
+ * its range divided by its mean rate of change, the variation divided by
+ * the duration of the result. A column is constant if it never changes,
+ * slow if its time scale is at least the duration divided by ACTIVITY_SLOW,
+ * and fast otherwise. The class thus depends on the run, not on the step
+ * size or the interval of the rows. The time scale of a string is the
+ * duration divided by its changes.
+ * At the end, the sink writes the profile, a CSV file with the columns
+ *   name, activity, changes, min, max, timescale
+ * and one line per column, where activity is constant, slow or fast and
+ * the time scale is empty for constant columns. It also reports the
+ * fastest columns.
+ * A select sink passes only the columns that are not constant in a given
+ * profile to another sink. Columns missing in the profile are passed.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "activity.h"
+#include "fmuio.h"
+
+#define BUFSIZE 4096
+
+static const char* activityNames[] = { "constant", "slow", "fast" };
+
+// -------------------------------------------------------------------------
+// Activity sink
+
+// the activity of one column
+typedef struct {
+    int nChanges;
+    double last;                     // value of the last row, for numbers
+    char* lastString;                // value of the last row, for strings
+    double min;
+    double max;
+    double variation;                // sum of the absolute changes
+} Activity;
+
+typedef struct {
+    Sink sink;
+    const char* path;
+    char separator;
+    long nRows;
+    double tFirst;
+    double tLast;
+    Activity* columns;
+} ActivitySink;
+
+static double numberOf(Elm type, SinkValue v) {
+    switch (type) {
+        case elm_Real:    return v.r;
+        case elm_Boolean: return v.b;
+        default:          return v.i;
+    }
+}
+
+static int activityBegin(Sink* s, Schema* schema) {
+    ActivitySink* as = (ActivitySink*)s;
+    as->columns = (Activity*)calloc(schema->nColumns + 1, sizeof(Activity));
+    if (!as->columns) return fmuError("out of memory");
+    return 1; // success
+}
+
+static int activityWrite(Sink* s, Schema* schema, RowBatch* batch) {
+    ActivitySink* as = (ActivitySink*)s;
+    int i, k;
+    double d;
+    for (i=0; i<batch->nRows; i++) {
+        SinkValue* v = batch->values + i * schema->nColumns;
+        for (k=0; k<schema->nColumns; k++) {
+            Activity* a = &as->columns[k];
+            if (schema->types[k] == elm_String) {
+                if (as->nRows > 0 && !strcmp(a->lastString, v[k].s)) continue;
+                if (as->nRows > 0) a->nChanges++;
+                if (a->lastString) free(a->lastString);
+                if (!(a->lastString = strdup(v[k].s))) return fmuError("out of memory");
+                continue;
+            }
+            d = numberOf(schema->types[k], v[k]);
+            if (as->nRows == 0) {
+                a->min = a->max = a->last = d;
+                continue;
+            }
+            if (d == a->last) continue;
+            a->nChanges++;
+            a->variation += d > a->last ? d - a->last : a->last - d;
+            if (d < a->min) a->min = d;
+            if (d > a->max) a->max = d;
+            a->last = d;
+        }
+        if (as->nRows++ == 0) as->tFirst = batch->times[i];
+        as->tLast = batch->times[i];
+    }
+    return 1; // success
+}
+
+// the time scale of column k, 0 if it is constant
+static double timeScale(ActivitySink* as, Schema* schema, int k) {
+    Activity* a = &as->columns[k];
+    double duration = as->tLast - as->tFirst;
+    if (a->nChanges == 0) return 0;
+    if (schema->types[k] == elm_String || a->variation == 0) return duration / a->nChanges;
+    return (a->max - a->min) * duration / a->variation;
+}
+
+static ActivityClass classOf(ActivitySink* as, Schema* schema, int k) {
+    double duration = as->tLast - as->tFirst;
+    if (as->columns[k].nChanges == 0) return act_constant;
+    return timeScale(as, schema, k) >= duration / ACTIVITY_SLOW ? act_slow : act_fast;
+}
+
+// write a number to a CSV file, with decimal comma unless separator is ','
+static void printReal(FILE* file, double r, char separator) {
+    char buffer[32];
+    char* comma;
+    sprintf(buffer, "%.6g", r);
+    comma = separator == ',' ? NULL : strchr(buffer, '.');
+    if (comma) *comma = ',';
+    fprintf(file, "%c%s", separator, buffer);
+}
+
+// print the fastest columns, those with the smallest time scale
+static void printFastest(ActivitySink* as, Schema* schema) {
+    int i, k, best;
+    char* ranked = (char*)calloc(schema->nColumns + 1, 1);
+    if (!ranked) return;
+    for (i=0; i<ACTIVITY_RANKED; i++) {
+        for (best=-1, k=0; k<schema->nColumns; k++) {
+            if (ranked[k] || as->columns[k].nChanges == 0) continue;
+            if (best < 0 || timeScale(as, schema, k) < timeScale(as, schema, best)) best = k;
+        }
+        if (best < 0) break;
+        ranked[best] = 1;
+        if (i == 0) printf("  fastest columns:\n");
+        printf("    %-16s time scale %g, %d changes\n", schema->names[best],
+                timeScale(as, schema, best), as->columns[best].nChanges);
+    }
+    free(ranked);
+}
+
+static int activityEnd(Sink* s, Schema* schema) {
+    ActivitySink* as = (ActivitySink*)s;
+    int k;
+    int count[3] = { 0, 0, 0 };
+    int ok;
+    char sep = as->separator;
+    FILE* file = schema->failed ? NULL : fopen(as->path, "w");
+    if (file) {
+        fprintf(file, "name%cactivity%cchanges%cmin%cmax%ctimescale\n", sep, sep, sep, sep, sep);
+        for (k=0; k<schema->nColumns; k++) {
+            Activity* a = &as->columns[k];
+            ActivityClass c = classOf(as, schema, k);
+            count[c]++;
+            fprintf(file, "%s%c%s%c%d", schema->names[k], sep, activityNames[c], sep, a->nChanges);
+            if (schema->types[k] == elm_String) fprintf(file, "%c%c", sep, sep);
+            else {
+                printReal(file, a->min, sep);
+                printReal(file, a->max, sep);
+            }
+            if (c == act_constant) fputc(sep, file);
+            else printReal(file, timeScale(as, schema, k), sep);
+            fputc('\n', file);
+        }
+    }
+    ok = file && fclose(file) == 0;
+    if (ok) {
+        printf("Activity profile '%s' written: %ld rows, %d columns, %d constant, %d slow, %d fast\n",
+                as->path, as->nRows, schema->nColumns, count[act_constant], count[act_slow], count[act_fast]);
+        printFastest(as, schema);
+    }
+    else if (!schema->failed) printf("error: could not write %s\n", as->path);
+    for (k=0; k<schema->nColumns; k++) {
+        if (as->columns[k].lastString) free(as->columns[k].lastString);
+    }
+    free(as->columns);
+    free(as);
+    return ok;
+}
+
+Sink* activitySink(const char* path, char separator) {
+    ActivitySink* as = (ActivitySink*)calloc(1, sizeof(ActivitySink));
+    if (!as) return NULL;
+    as->sink.begin = activityBegin;
+    as->sink.write = activityWrite;
+    as->sink.end = activityEnd;
+    as->path = path;
+    as->separator = separator;
+    return &as->sink;
+}
+
+// -------------------------------------------------------------------------
+// Profile
+
+static int compareEntries(const void* a, const void* b) {
+    return strcmp(((ActivityEntry*)a)->name, ((ActivityEntry*)b)->name);
+}
+
+// Read the profile written by an activity sink.
+// Returns NULL to indicate error
+ActivityProfile* activityLoad(const char* path, char separator) {
+    char line[BUFSIZE];
+    char* field;
+    int c, size = 0;
+    ActivityEntry* entries;
+    ActivityProfile* p;
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        printf("error: Could not open activity profile %s\n", path);
+        return NULL;
+    }
+    p = (ActivityProfile*)calloc(1, sizeof(ActivityProfile));
+    if (!p) {
+        fclose(file);
+        fmuError("out of memory");
+        return NULL;
+    }
+    fgets(line, BUFSIZE, file); // the names of the columns
+    while (fgets(line, BUFSIZE, file)) {
+        if (!(field = strchr(line, separator))) continue;
+        *field++ = '\0';
+        for (c=0; c<3 && strncmp(field, activityNames[c], strlen(activityNames[c])); c++);
+        if (c == 3) {
+            printf("error: Unknown activity of %s in %s\n", line, path);
+            break;
+        }
+        if (p->n == size) {
+            size = 2 * size + 64;
+            entries = (ActivityEntry*)realloc(p->entries, size * sizeof(ActivityEntry));
+            if (!entries) break;
+            p->entries = entries;
+        }
+        if (!(p->entries[p->n].name = strdup(line))) break;
+        p->entries[p->n++].activity = (ActivityClass)c;
+    }
+    if (!feof(file)) {
+        fclose(file);
+        activityFree(p);
+        fmuError("could not read the activity profile");
+        return NULL;
+    }
+    fclose(file);
+    qsort(p->entries, p->n, sizeof(ActivityEntry), compareEntries);
+    return p;
+}
+
+void activityFree(ActivityProfile* p) {
+    int i;
+    for (i=0; i<p->n; i++) free(p->entries[i].name);
+    if (p->entries) free(p->entries);
+    free(p);
+}
+
+// -------------------------------------------------------------------------
+// Select sink
+
+typedef struct {
+    Sink sink;
+    Sink* target;
+    ActivityProfile* profile;
+    Schema schema;                   // of the selected columns
+    int* columns;                    // column of each selected column
+    RowBatch out;
+} SelectSink;
+
+// 1 if the column is not constant in the profile, or missing there
+static int isSelected(ActivityProfile* p, const char* name) {
+    ActivityEntry key;
+    ActivityEntry* e;
+    key.name = (char*)name;
+    e = (ActivityEntry*)bsearch(&key, p->entries, p->n, sizeof(ActivityEntry), compareEntries);
+    return !e || e->activity != act_constant;
+}
+
+static int selectBegin(Sink* s, Schema* schema) {
+    SelectSink* ss = (SelectSink*)s;
+    int k;
+    int n = schema->nColumns;
+    ss->schema.names = (const char**)calloc(n + 1, sizeof(char*));
+    ss->schema.types = (Elm*)calloc(n + 1, sizeof(Elm));
+    ss->columns = (int*)calloc(n + 1, sizeof(int));
+    ss->out.times = (double*)calloc(OUTPUT_BATCH, sizeof(double));
+    ss->out.values = (SinkValue*)calloc(OUTPUT_BATCH * n + 1, sizeof(SinkValue));
+    if (!ss->schema.names || !ss->schema.types || !ss->columns || !ss->out.times || !ss->out.values)
+        return fmuError("out of memory");
+    for (k=0; k<n; k++) {
+        if (!isSelected(ss->profile, schema->names[k])) continue;
+        ss->columns[ss->schema.nColumns] = k;
+        ss->schema.names[ss->schema.nColumns] = schema->names[k];
+        ss->schema.types[ss->schema.nColumns++] = schema->types[k];
+    }
+    return ss->target->begin(ss->target, &ss->schema);
+}
+
+static int selectWrite(Sink* s, Schema* schema, RowBatch* batch) {
+    SelectSink* ss = (SelectSink*)s;
+    int i, k;
+    int nc = ss->schema.nColumns;
+    for (i=0; i<batch->nRows; i++) {
+        SinkValue* v = batch->values + i * schema->nColumns;
+        SinkValue* out = ss->out.values + i * nc;
+        for (k=0; k<nc; k++) out[k] = v[ss->columns[k]];
+        ss->out.times[i] = batch->times[i];
+    }
+    ss->out.nRows = batch->nRows;
+    return ss->target->write(ss->target, &ss->schema, &ss->out);
+}
+
+static int selectEnd(Sink* s, Schema* schema) {
+    SelectSink* ss = (SelectSink*)s;
+    int ok;
+    ss->schema.failed = schema->failed;
+    ok = ss->target->end(ss->target, &ss->schema);
+    if (ss->schema.names) free(ss->schema.names);
+    if (ss->schema.types) free(ss->schema.types);
+    if (ss->columns) free(ss->columns);
+    if (ss->out.times) free(ss->out.times);
+    if (ss->out.values) free(ss->out.values);
+    free(ss);
+    return ok;
+}
+
+Sink* selectSink(Sink* target, ActivityProfile* profile) {
+    SelectSink* ss = (SelectSink*)calloc(1, sizeof(SelectSink));
+    if (!ss) return NULL;
+    ss->sink.begin = selectBegin;
+    ss->sink.write = selectWrite;
+    ss->sink.end = selectEnd;
+    ss->target = target;
+    ss->profile = profile;
+    return &ss->sink;
+}
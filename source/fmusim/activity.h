@@ -0,0 +1,41 @@
+/* -------------------------------------------------------------------------
+ * activity.h
+ * Activity of the variables of a simulation result: how often and how fast
+ * each column changes, saved as a profile that later runs use to select
+ * the columns of their result
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef activity_h
+#define activity_h
+
+#include "sink.h"
+
+#define ACTIVITY_SLOW 10             // a column is slow from a time scale of duration / ACTIVITY_SLOW
+#define ACTIVITY_RANKED 5            // number of fastest columns reported
+
+typedef enum {
+    act_constant,                    // never changes
+    act_slow,                        // changes little over the run
+    act_fast
+} ActivityClass;
+
+// a column of a profile
+typedef struct {
+    char* name;
+    ActivityClass activity;
+} ActivityEntry;
+
+// the classes of the columns of an earlier run, sorted by name
+typedef struct {
+    int n;
+    ActivityEntry* entries;
+} ActivityProfile;
+
+Sink* activitySink(const char* path, char separator);
+ActivityProfile* activityLoad(const char* path, char separator);
+void activityFree(ActivityProfile* p);
+Sink* selectSink(Sink* target, ActivityProfile* profile);
+
+#endif // activity_h
@@ -0,0 +1,604 @@
+/* -------------------------------------------------------------------------
+ * cosim.c
+ * Simulation of several connected FMUs.
+ * A system file lists the FMUs and the connections between their variables:
+ *   # comment
+ *   fmu <name> <path to fmu, relative to the system file>
+ *   connect <name>.<variable> <name>.<variable>
+ * Each FMU is integrated by its own solver. Values are exchanged at
+ * communication points, every hComm seconds. Before the simulation, the
+ * connections are compiled into routes: one for each pair of FMUs and base
+ * type, with the value references stored in arrays. An exchange then takes
+ * one get and one set call per route. Values passed through an FMU, i.e.
+ * connected to an input that is also the source of another connection,
+ * are routed directly from their origin.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "cosim.h"
+#include "fmuinit.h"
+#include "fmuio.h"
+
+#ifndef _MSC_VER
+#define TRUE 1
+#define FALSE 0
+#define min(a,b) (a>b ? b : a)
+#define max(a,b) (a>b ? a : b)
+#endif
+
+#define RESULT_FILE "result.csv"
+#define BUFSIZE 4096
+
+// A connection resolved to value references
+typedef struct {
+    int src;
+    int dst;
+    Elm type;
+    fmiValueReference srcVr;
+    fmiValueReference dstVr;
+    char negate;
+} Link;
+
+// -------------------------------------------------------------------------
+// Loading a system
+
+// Returns -1 if there is no component of the given name
+static int getComponent(CoSystem* sys, const char* name, int n) {
+    int i;
+    for (i=0; i<sys->nComponents; i++) {
+        if (strlen(sys->components[i].name) == n && !strncmp(sys->components[i].name, name, n))
+            return i;
+    }
+    return -1;
+}
+
+// Returns 0 to indicate error
+static int addComponent(CoSystem* sys, const char* systemFileName, const char* name,
+        const char* path) {
+    Component* c;
+    char* fmuPath;
+    int ok;
+    if (strchr(name, '.') || getComponent(sys, name, strlen(name)) != -1) {
+        printf("error: Illegal or duplicate FMU name %s\n", name);
+        return 0;
+    }
+    c = (Component*)realloc(sys->components, (sys->nComponents + 1) * sizeof(Component));
+    if (!c) return fmuError("out of memory");
+    sys->components = c;
+    c = &sys->components[sys->nComponents];
+    memset(c, 0, sizeof(Component));
+    c->name = strdup(name);
+    fmuPath = resolvePath(systemFileName, path);
+    ok = c->name && fmuPath && fmuLoad(fmuPath, &c->fmu);
+    free(fmuPath);
+    sys->nComponents++; // also if loading failed, for coFree
+    return ok;
+}
+
+// Returns NULL if ref is not of the form <name>.<variable> or not found
+static ScalarVariable* getConnector(CoSystem* sys, const char* ref, int* component) {
+    ScalarVariable* sv = NULL;
+    const char* dot = strchr(ref, '.');
+    *component = dot ? getComponent(sys, ref, dot - ref) : -1;
+    if (*component != -1)
+        sv = getVariableByName(sys->components[*component].fmu.modelDescription, dot + 1);
+    if (!sv) printf("error: Variable %s not found\n", ref);
+    return sv;
+}
+
+// Returns 0 to indicate error
+static int addConnection(CoSystem* sys, const char* from, const char* to) {
+    Connection con;
+    Connection* cons;
+    con.srcVar = getConnector(sys, from, &con.src);
+    con.dstVar = getConnector(sys, to, &con.dst);
+    if (!con.srcVar || !con.dstVar) return 0;
+    cons = (Connection*)realloc(sys->connections, (sys->nConnections + 1) * sizeof(Connection));
+    if (!cons) return fmuError("out of memory");
+    sys->connections = cons;
+    sys->connections[sys->nConnections++] = con;
+    return 1; // success
+}
+
+// Read the system file and load all FMUs listed there.
+// Returns NULL to indicate failure
+CoSystem* coLoad(const char* systemFileName) {
+    char line[BUFSIZE];
+    char keyword[BUFSIZE];
+    char arg1[BUFSIZE];
+    char arg2[BUFSIZE];
+    int n, ok = 1;
+    int lineNumber = 0;
+    CoSystem* sys;
+    FILE* file = fopen(systemFileName, "r");
+    if (!file) {
+        printf("error: Could not open system file %s\n", systemFileName);
+        return NULL;
+    }
+    sys = (CoSystem*)calloc(1, sizeof(CoSystem));
+    if (!sys) {
+        fclose(file);
+        fmuError("out of memory");
+        return NULL;
+    }
+    while (ok && fgets(line, BUFSIZE, file)) {
+        lineNumber++;
+        n = sscanf(line, "%s %s %s", keyword, arg1, arg2);
+        if (n <= 0 || keyword[0] == '#') continue;
+        if (n == 3 && !strcmp(keyword, "fmu"))
+            ok = addComponent(sys, systemFileName, arg1, arg2);
+        else if (n == 3 && !strcmp(keyword, "connect"))
+            ok = addConnection(sys, arg1, arg2);
+        else {
+            printf("error: Syntax error in %s at line %d\n", systemFileName, lineNumber);
+            ok = 0;
+        }
+    }
+    fclose(file);
+    if (ok && sys->nComponents == 0) {
+        printf("error: No fmu in system file %s\n", systemFileName);
+        ok = 0;
+    }
+    if (!ok) {
+        coFree(sys);
+        return NULL;
+    }
+    return sys;
+}
+
+// -------------------------------------------------------------------------
+// Compiling the connections into routes
+
+static Elm getBaseType(ScalarVariable* sv) {
+    return sv->typeSpec->type == elm_Enumeration ? elm_Integer : sv->typeSpec->type;
+}
+
+static int sizeOfType(Elm type) {
+    switch (type) {
+        case elm_Real:    return sizeof(fmiReal);
+        case elm_Integer: return sizeof(fmiInteger);
+        case elm_Boolean: return sizeof(fmiBoolean);
+        default:          return sizeof(fmiString);
+    }
+}
+
+// order of links in routes: by source, destination, type and source vr
+static int compareLinks(const void* a, const void* b) {
+    const Link* x = (const Link*)a;
+    const Link* y = (const Link*)b;
+    if (x->src != y->src) return x->src - y->src;
+    if (x->dst != y->dst) return x->dst - y->dst;
+    if (x->type != y->type) return x->type - y->type;
+    return x->srcVr < y->srcVr ? -1 : x->srcVr > y->srcVr ? 1 : 0;
+}
+
+// Returns -1 if no link sets the given variable
+static int findLinkTo(Link* links, int n, int dst, Elm type, fmiValueReference vr) {
+    int i;
+    for (i=0; i<n; i++) {
+        if (links[i].dst == dst && links[i].type == type && links[i].dstVr == vr) return i;
+    }
+    return -1;
+}
+
+// Resolve the connections to value references, route values passed through
+// an FMU directly from their origin, and group them into routes.
+// Returns 0 to indicate error
+int coCompile(CoSystem* sys) {
+    int i, j, k, n;
+    int nBypassed = 0;
+    int nLinks = sys->nConnections;
+    Link* links = (Link*)calloc(nLinks + 1, sizeof(Link));
+    if (!links) return fmuError("out of memory");
+
+    // resolve aliases
+    for (i=0; i<nLinks; i++) {
+        Connection* con = &sys->connections[i];
+        Link* l = &links[i];
+        l->src = con->src;
+        l->dst = con->dst;
+        l->type = getBaseType(con->srcVar);
+        l->srcVr = getValueReference(con->srcVar);
+        l->dstVr = getValueReference(con->dstVar);
+        l->negate = (getAlias(con->srcVar) == enu_negatedAlias)
+                 != (getAlias(con->dstVar) == enu_negatedAlias);
+        if (l->type != getBaseType(con->dstVar)) {
+            printf("error: Connection of %s to %s of different type\n",
+                    getName(con->srcVar), getName(con->dstVar));
+            free(links);
+            return 0;
+        }
+        if (findLinkTo(links, i, l->dst, l->type, l->dstVr) != -1) {
+            printf("error: Variable %s.%s is connected twice\n",
+                    sys->components[l->dst].name, getName(con->dstVar));
+            free(links);
+            return 0;
+        }
+    }
+
+    // eliminate pass-throughs: take the value from the origin of the chain
+    for (i=0; i<nLinks; i++) {
+        Link* l = &links[i];
+        for (n=0; (j = findLinkTo(links, nLinks, l->src, l->type, l->srcVr)) != -1; n++) {
+            if (n == nLinks || j == i) {
+                printf("error: Connections form a loop at %s.%s\n",
+                        sys->components[l->dst].name, getName(sys->connections[i].dstVar));
+                free(links);
+                return 0;
+            }
+            l->src = links[j].src;
+            l->srcVr = links[j].srcVr;
+            l->negate = l->negate != links[j].negate;
+            nBypassed++;
+        }
+    }
+
+    // group the links into routes
+    qsort(links, nLinks, sizeof(Link), compareLinks);
+    sys->routes = (Route*)calloc(nLinks + 1, sizeof(Route));
+    if (!sys->routes) {
+        free(links);
+        return fmuError("out of memory");
+    }
+    for (i=0; i<nLinks; i=j) {
+        Route* r = &sys->routes[sys->nRoutes++];
+        int negate = 0;
+        for (j=i; j<nLinks && links[j].src == links[i].src && links[j].dst == links[i].dst
+                && links[j].type == links[i].type; j++) {
+            negate = negate || links[j].negate;
+        }
+        r->src = links[i].src;
+        r->dst = links[i].dst;
+        r->type = links[i].type;
+        r->n = j - i;
+        r->srcVr = (fmiValueReference*)calloc(r->n, sizeof(fmiValueReference));
+        r->dstVr = (fmiValueReference*)calloc(r->n, sizeof(fmiValueReference));
+        r->values = calloc(r->n, sizeOfType(r->type));
+        if (negate) r->negate = (char*)calloc(r->n, sizeof(char));
+        if (!r->srcVr || !r->dstVr || !r->values || (negate && !r->negate)) {
+            free(links);
+            return fmuError("out of memory");
+        }
+        for (k=0; k<r->n; k++) {
+            r->srcVr[k] = links[i+k].srcVr;
+            r->dstVr[k] = links[i+k].dstVr;
+            if (r->negate) r->negate[k] = links[i+k].negate;
+        }
+    }
+    free(links);
+    printf("Compiled %d connections into %d routes, %d pass-throughs bypassed\n",
+            sys->nConnections, sys->nRoutes, nBypassed);
+    return 1; // success
+}
+
+// -------------------------------------------------------------------------
+// Exchange of values
+
+static fmiStatus getRoute(CoSystem* sys, Route* r) {
+    Component* c = &sys->components[r->src];
+    switch (r->type) {
+        case elm_Real:    return c->fmu.getReal   (c->sim.c, r->srcVr, r->n, (fmiReal*)r->values);
+        case elm_Integer: return c->fmu.getInteger(c->sim.c, r->srcVr, r->n, (fmiInteger*)r->values);
+        case elm_Boolean: return c->fmu.getBoolean(c->sim.c, r->srcVr, r->n, (fmiBoolean*)r->values);
+        default:          return c->fmu.getString (c->sim.c, r->srcVr, r->n, (fmiString*)r->values);
+    }
+}
+
+static fmiStatus setRoute(CoSystem* sys, Route* r) {
+    int k;
+    Component* c = &sys->components[r->dst];
+    if (r->negate) for (k=0; k<r->n; k++) {
+        if (!r->negate[k]) continue;
+        switch (r->type) {
+            case elm_Real:    ((fmiReal*)r->values)[k]    = -((fmiReal*)r->values)[k]; break;
+            case elm_Integer: ((fmiInteger*)r->values)[k] = -((fmiInteger*)r->values)[k]; break;
+            case elm_Boolean: ((fmiBoolean*)r->values)[k] = !((fmiBoolean*)r->values)[k]; break;
+            default:          break; // strings are never negated
+        }
+    }
+    switch (r->type) {
+        case elm_Real:    return c->fmu.setReal   (c->sim.c, r->dstVr, r->n, (fmiReal*)r->values);
+        case elm_Integer: return c->fmu.setInteger(c->sim.c, r->dstVr, r->n, (fmiInteger*)r->values);
+        case elm_Boolean: return c->fmu.setBoolean(c->sim.c, r->dstVr, r->n, (fmiBoolean*)r->values);
+        default:          return c->fmu.setString (c->sim.c, r->dstVr, r->n, (fmiString*)r->values);
+    }
+}
+
+// Returns 0 to indicate error
+static int getValues(CoSystem* sys) {
+    int i;
+    for (i=0; i<sys->nRoutes; i++) {
+        if (getRoute(sys, &sys->routes[i]) > fmiWarning)
+            return fmuError("could not get connected values");
+    }
+    return 1; // success
+}
+
+// Returns 0 to indicate error
+static int setValues(CoSystem* sys) {
+    int i;
+    for (i=0; i<sys->nRoutes; i++) {
+        if (setRoute(sys, &sys->routes[i]) > fmiWarning)
+            return fmuError("could not set connected values");
+    }
+    return 1; // success
+}
+
+// Copy all connected values: first get all of them, then set them.
+// Returns 0 to indicate error
+int coExchange(CoSystem* sys) {
+    return getValues(sys) && setValues(sys);
+}
+
+// -------------------------------------------------------------------------
+// Adaptive communication step
+// The inputs of an FMU are held constant during a communication step.
+// The coupling error of a step is estimated by comparing the Real values
+// got at its end with their extrapolation from the previous exchanges:
+// linear if there are two of them, constant otherwise. The step is
+// rejected if the error exceeds the tolerance, and all FMUs are rolled back
+// to its start. As saving the FMUs costs a get call per base type and FMU,
+// a snapshot is taken only if the error predicted from the last step
+// might exceed the tolerance.
+
+#define COMM_SAFETY 0.6       // factor applied to the optimal step size
+#define COMM_GROW 2.0         // maximum growth of the step size per step
+#define COMM_SHRINK 0.2       // maximum reduction of the step size per step
+#define COMM_RISK 0.75        // predicted error, relative to tolerance, that requires a snapshot
+#define COMM_MAX 100          // maximum step size, relative to the initial one
+
+// Returns 0 to indicate error
+static int initHistory(CoSystem* sys) {
+    int i;
+    for (i=0; i<sys->nRoutes; i++) {
+        Route* r = &sys->routes[i];
+        if (r->type != elm_Real) continue;
+        r->last = (fmiReal*)calloc(r->n, sizeof(fmiReal));
+        r->prev = (fmiReal*)calloc(r->n, sizeof(fmiReal));
+        if (!r->last || !r->prev) return fmuError("out of memory");
+    }
+    return 1; // success
+}
+
+// Shift the values got by the last call to getValues into the history
+static void pushHistory(CoSystem* sys) {
+    int i;
+    fmiReal* tmp;
+    for (i=0; i<sys->nRoutes; i++) {
+        Route* r = &sys->routes[i];
+        if (r->type != elm_Real) continue;
+        tmp = r->prev;
+        r->prev = r->last;
+        r->last = tmp;
+        memcpy(r->last, r->values, r->n * sizeof(fmiReal));
+    }
+}
+
+// Deviation of the values got by the last call to getValues at time t from
+// their extrapolation, relative to the tolerance. order is 1 for constant
+// and 2 for linear extrapolation from the exchanges at tLast and tPrev.
+static double couplingError(CoSystem* sys, double t, double tLast, double tPrev,
+        int order, double tolerance) {
+    int i, k;
+    double u, predicted, err = 0;
+    for (i=0; i<sys->nRoutes; i++) {
+        Route* r = &sys->routes[i];
+        if (r->type != elm_Real) continue;
+        for (k=0; k<r->n; k++) {
+            u = ((fmiReal*)r->values)[k];
+            predicted = r->last[k];
+            if (order == 2) predicted += (r->last[k] - r->prev[k]) * (t - tLast) / (tLast - tPrev);
+            err = max(err, fabs(u - predicted) / (tolerance * (1 + fabs(u))));
+        }
+    }
+    return err;
+}
+
+// step size for an error err of a step of size H
+static double controlStep(double H, double err, int order) {
+    double factor = err > 0 ? COMM_SAFETY * pow(1 / err, 1.0 / order) : COMM_GROW;
+    return H * min(COMM_GROW, max(COMM_SHRINK, factor));
+}
+
+// Returns 0 to indicate error
+static int saveComponents(CoSystem* sys) {
+    int i;
+    for (i=0; i<sys->nComponents; i++) {
+        Component* c = &sys->components[i];
+        if (!c->snapshot) c->snapshot = simSnapshotNew(&c->sim);
+        if (!c->snapshot || !simSave(&c->sim, c->snapshot)) return 0;
+    }
+    return 1; // success
+}
+
+// Returns 0 to indicate error
+static int restoreComponents(CoSystem* sys) {
+    int i;
+    for (i=0; i<sys->nComponents; i++) {
+        Component* c = &sys->components[i];
+        if (!simRestore(&c->sim, c->snapshot)) return 0;
+    }
+    return 1; // success
+}
+
+// -------------------------------------------------------------------------
+// Simulation
+
+static void outputSystemRow(CoSystem* sys, double time, FILE* file, char separator, int header) {
+    int i;
+    outputTime(time, file, separator, header);
+    for (i=0; i<sys->nComponents; i++) {
+        Component* c = &sys->components[i];
+        outputColumns(&c->fmu, c->sim.c, file, separator, header, c->name);
+    }
+    fprintf(file, "\n");
+}
+
+// simulate the system from 0 to tEnd. Each FMU uses the given method and
+// step size h, connected values are exchanged every hComm. If tolerance
+// is positive, the communication step starts with hComm and is adapted
+// between h and COMM_MAX * hComm to keep the coupling error below tolerance.
+// Returns 0 to indicate error
+int fmuCoSimulate(CoSystem* sys, double tEnd, double h, double hComm, double tolerance,
+        Method method, fmiBoolean loggingOn, char separator) {
+    int i;
+    double time = 0;
+    double tNext;
+    double H = hComm;                // current communication step size
+    double hMin = h;
+    double hMax = COMM_MAX * hComm;
+    double hLast = 0;                // size of the last accepted step
+    double hUsedMin = 0, hUsedMax = 0;
+    double tLast = 0, tPrev = 0;     // times of the last two exchanges
+    double err = 0, errLast = 0;
+    int order = 1;                   // of the extrapolation
+    int nHistory = 0;                // number of exchanges in the history
+    int saved, cautious = FALSE;     // take a snapshot regardless of the prediction
+    int nExchanges = 0, nRejected = 0, nSnapshots = 0, nUnguarded = 0;
+    int nSteps = 0, nTimeEvents = 0, nStateEvents = 0, nStepEvents = 0;
+    fmiBoolean terminated = FALSE;
+    FILE* file;
+
+    if (!coCompile(sys)) return 0;
+    if (tolerance > 0 && !initHistory(sys)) return 0;
+    for (i=0; tolerance > 0 && i<sys->nComponents; i++) {
+        if (!simHasModelState(&sys->components[i].fmu)) {
+            printf("error: Rolling back steps requires FMUs that export their model state, %s does not\n",
+                    sys->components[i].name);
+            return 0;
+        }
+    }
+    for (i=0; i<sys->nComponents; i++) {
+        Component* c = &sys->components[i];
+        if (!simInstantiate(&c->sim, &c->fmu, c->name, method, h, loggingOn)) return 0;
+    }
+    if (!(file=fopen(RESULT_FILE, "w"))) {
+        printf("could not write %s\n", RESULT_FILE);
+        return 0; // failure
+    }
+
+    // set the inputs from the start values of the outputs and initialize
+    if (!coExchange(sys)) return 0;
+    for (i=0; i<sys->nComponents; i++) {
+        if (!simInitialize(&sys->components[i].sim, time)) return 0;
+        terminated = terminated || sys->components[i].sim.terminated;
+    }
+    if (!getValues(sys)) return 0;
+    if (tolerance > 0) {
+        pushHistory(sys);
+        nHistory = 1;
+    }
+    if (!setValues(sys)) return 0;
+    outputSystemRow(sys, time, file, separator, TRUE);
+    outputSystemRow(sys, time, file, separator, FALSE);
+
+    // enter the simulation loop
+    while (time < tEnd && !terminated) {
+        tNext = min(time + H, tEnd);
+
+        // save the FMUs if the step might be rejected
+        saved = FALSE;
+        if (tolerance > 0 && H > hMin && (nHistory < 2 || cautious
+                || errLast * pow(H / hLast, order) > COMM_RISK)) {
+            if (!saveComponents(sys)) return 0;
+            saved = TRUE;
+            nSnapshots++;
+        }
+
+        for (i=0; i<sys->nComponents; i++) {
+            SimInstance* sim = &sys->components[i].sim;
+            while (sim->time < tNext && !sim->terminated) {
+                if (!simDoStep(sim, tNext)) return 0;
+            }
+        }
+        if (!getValues(sys)) return 0;
+
+        // accept or reject the step, and select the size of the next one
+        if (tolerance > 0) {
+            order = nHistory < 2 ? 1 : 2;
+            err = couplingError(sys, tNext, tLast, tPrev, order, tolerance);
+            if (err > 1 && saved) {
+                if (!restoreComponents(sys)) return 0;
+                H = max(hMin, controlStep(tNext - time, err, order));
+                cautious = TRUE;
+                nRejected++;
+                continue;
+            }
+            if (err > 1) nUnguarded++;
+            pushHistory(sys);
+            nHistory++;
+            tPrev = tLast;
+            tLast = tNext;
+            hLast = tNext - time;
+            errLast = err;
+            cautious = err > 1;
+            if (nExchanges == 0 || hLast < hUsedMin) hUsedMin = hLast;
+            if (hLast > hUsedMax) hUsedMax = hLast;
+            H = min(hMax, max(hMin, controlStep(hLast, err, order)));
+        }
+        if (!setValues(sys)) return 0;
+        time = tNext;
+        nExchanges++;
+        outputSystemRow(sys, time, file, separator, FALSE);
+        for (i=0; i<sys->nComponents; i++) {
+            terminated = terminated || sys->components[i].sim.terminated;
+        }
+    }
+    fclose(file);
+
+    // print simulation summary
+    for (i=0; i<sys->nComponents; i++) {
+        SimInstance* sim = &sys->components[i].sim;
+        nSteps += sim->nSteps;
+        nTimeEvents += sim->nTimeEvents;
+        nStateEvents += sim->nStateEvents;
+        nStepEvents += sim->nStepEvents;
+    }
+    printf("Simulation of %d FMUs from 0 to %g terminated successful\n", sys->nComponents, time);
+    printf("  exchanges ........ %d\n", nExchanges);
+    if (tolerance > 0) {
+        printf("  communication step %g .. %g\n", hUsedMin, hUsedMax);
+        printf("  rejected steps ... %d\n", nRejected);
+        printf("  snapshots ........ %d\n", nSnapshots);
+        printf("  unguarded errors . %d\n", nUnguarded);
+    }
+    else printf("  communication step %g\n", hComm);
+    printf("  steps ............ %d\n", nSteps);
+    printf("  fixed step size .. %g\n", h);
+    printf("  method ........... %s\n", mthNames[method]);
+    printf("  time events ...... %d\n", nTimeEvents);
+    printf("  state events ..... %d\n", nStateEvents);
+    printf("  step events ...... %d\n", nStepEvents);
+    printf("CSV file '%s' written.\n", RESULT_FILE);
+    return 1; // success
+}
+
+// release the instances and FMUs of the system and the system itself
+void coFree(CoSystem* sys) {
+    int i;
+    for (i=0; i<sys->nComponents; i++) {
+        Component* c = &sys->components[i];
+        simFree(&c->sim);
+        if (c->snapshot) simSnapshotFree(c->snapshot);
+        if (c->fmu.modelDescription) fmuFree(&c->fmu);
+        free(c->name);
+    }
+    for (i=0; i<sys->nRoutes; i++) {
+        Route* r = &sys->routes[i];
+        free(r->srcVr);
+        free(r->dstVr);
+        free(r->values);
+        if (r->negate) free(r->negate);
+        if (r->last) free(r->last);
+        if (r->prev) free(r->prev);
+    }
+    if (sys->components) free(sys->components);
+    if (sys->connections) free(sys->connections);
+    if (sys->routes) free(sys->routes);
+    free(sys);
+}
@@ -0,0 +1,64 @@
+/* -------------------------------------------------------------------------
+ * cosim.h
+ * Simulation of several connected FMUs
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef cosim_h
+#define cosim_h
+
+#include "fmusim.h"
+
+#define SYSTEM_SUFFIX ".sys"
+
+// One simulated FMU of a system
+typedef struct {
+    char* name;                   // unique instance name
+    FMU fmu;
+    SimInstance sim;
+    SimSnapshot* snapshot;        // for rolling back a step, NULL until needed
+} Component;
+
+// A connection from an output to an input, as given in the system file
+typedef struct {
+    int src;                      // index of the source component
+    int dst;                      // index of the destination component
+    ScalarVariable* srcVar;
+    ScalarVariable* dstVar;
+} Connection;
+
+// Values of one base type, copied from one component to another
+// by one get and one set call per exchange
+typedef struct {
+    int src;                      // index of the source component
+    int dst;                      // index of the destination component
+    Elm type;                     // elm_Real, elm_Integer, elm_Boolean or elm_String
+    int n;                        // number of values
+    fmiValueReference* srcVr;     // value references in the source, ascending
+    fmiValueReference* dstVr;     // corresponding value references in the destination
+    char* negate;                 // 1 for values to be negated, NULL if there are none
+    void* values;                 // buffer for n values of the type
+    fmiReal* last;                // Real values of the last two exchanges, to
+    fmiReal* prev;                // extrapolate them, NULL if not adapting
+} Route;
+
+// FMUs and their connections
+typedef struct {
+    Component* components;
+    int nComponents;
+    Connection* connections;
+    int nConnections;
+    Route* routes;                // compiled from the connections
+    int nRoutes;
+} CoSystem;
+
+CoSystem* coLoad(const char* systemFileName);
+int coCompile(CoSystem* sys);
+int coExchange(CoSystem* sys);
+void coFree(CoSystem* sys);
+
+int fmuCoSimulate(CoSystem* sys, double tEnd, double h, double hComm, double tolerance,
+        Method method, fmiBoolean loggingOn, char separator);
+
+#endif // cosim_h
@@ -0,0 +1,131 @@
+/* -------------------------------------------------------------------------
+ * costmodel.c
+ * Prediction of the cost of the cases of a sweep from their parameters.
+ * The cost of a finished case, the wall time spent on it, is added as a
+ * sample. The model is a least-squares fit of the cost, linear in the
+ * parameters, which are standardized over all cases of the sweep so that
+ * the fit does not depend on their units. The normal equations are
+ * accumulated with every sample, hence a fit costs the same however many
+ * cases have finished. A small ridge term keeps the equations solvable
+ * while there are fewer samples than parameters, or parameters that do
+ * not vary among the finished cases.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "costmodel.h"
+#include "fmuio.h"
+
+// Returns NULL to indicate error
+CostModel* cmNew(Sweep* sweep) {
+    int i, j;
+    double d;
+    int n = sweep->nParameters + 1;
+    CostModel* m = (CostModel*)calloc(1, sizeof(CostModel));
+    if (!m) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    m->sweep = sweep;
+    m->nFeatures = n;
+    m->mean = (double*)calloc(n, sizeof(double));
+    m->scale = (double*)calloc(n, sizeof(double));
+    m->normal = (double*)calloc(n * (n + 1), sizeof(double));
+    m->coef = (double*)calloc(n, sizeof(double));
+    if (!m->mean || !m->scale || !m->normal || !m->coef) {
+        cmFree(m);
+        fmuError("out of memory");
+        return NULL;
+    }
+    for (j=0; j<sweep->nParameters; j++) {
+        for (i=0; i<sweep->nCases; i++) m->mean[j] += sweep->values[i * sweep->nParameters + j];
+        m->mean[j] /= sweep->nCases;
+        for (i=0; i<sweep->nCases; i++) {
+            d = sweep->values[i * sweep->nParameters + j] - m->mean[j];
+            m->scale[j] += d * d;
+        }
+        m->scale[j] = sqrt(m->scale[j] / sweep->nCases);
+        if (m->scale[j] == 0) m->scale[j] = 1;
+    }
+    return m;
+}
+
+// the standardized parameters of case id, and a constant 1
+static void features(CostModel* m, int id, double* x) {
+    int j;
+    int np = m->sweep->nParameters;
+    for (j=0; j<np; j++) x[j] = (m->sweep->values[id * np + j] - m->mean[j]) / m->scale[j];
+    x[np] = 1;
+}
+
+// add the cost of the finished case id
+void cmAdd(CostModel* m, int id, double cost) {
+    int i, j;
+    int n = m->nFeatures;
+    double x[64];
+    double* px = n <= 64 ? x : (double*)malloc(n * sizeof(double));
+    if (!px) return; // the sample is lost
+    features(m, id, px);
+    for (i=0; i<n; i++) {
+        for (j=0; j<n; j++) m->normal[i * (n + 1) + j] += px[i] * px[j];
+        m->normal[i * (n + 1) + n] += px[i] * cost;
+    }
+    m->nSamples++;
+    if (px != x) free(px);
+}
+
+// Solve the normal equations by Gaussian elimination with partial pivoting.
+// Returns 0 if there are no samples or memory is out, keeping the last fit
+int cmFit(CostModel* m) {
+    int i, j, k, p;
+    int n = m->nFeatures;
+    double f, t;
+    double* a;
+    if (m->nSamples == 0) return 0;
+    a = (double*)malloc(n * (n + 1) * sizeof(double));
+    if (!a) return 0;
+    memcpy(a, m->normal, n * (n + 1) * sizeof(double));
+    for (i=0; i<n; i++) a[i * (n + 1) + i] += CM_RIDGE * m->nSamples;
+    for (k=0; k<n; k++) {
+        for (p=k, i=k+1; i<n; i++) {
+            if (fabs(a[i * (n + 1) + k]) > fabs(a[p * (n + 1) + k])) p = i;
+        }
+        for (j=k; j<=n; j++) {
+            t = a[k * (n + 1) + j];
+            a[k * (n + 1) + j] = a[p * (n + 1) + j];
+            a[p * (n + 1) + j] = t;
+        }
+        for (i=k+1; i<n; i++) {
+            f = a[i * (n + 1) + k] / a[k * (n + 1) + k];
+            for (j=k; j<=n; j++) a[i * (n + 1) + j] -= f * a[k * (n + 1) + j];
+        }
+    }
+    for (i=n-1; i>=0; i--) {
+        t = a[i * (n + 1) + n];
+        for (j=i+1; j<n; j++) t -= a[i * (n + 1) + j] * m->coef[j];
+        m->coef[i] = t / a[i * (n + 1) + i];
+    }
+    free(a);
+    m->nFits++;
+    return 1; // success
+}
+
+// predicted cost of case id, 0 before the first fit
+double cmPredict(CostModel* m, int id) {
+    int j;
+    double cost = 0;
+    int np = m->sweep->nParameters;
+    for (j=0; j<np; j++) cost += m->coef[j] * (m->sweep->values[id * np + j] - m->mean[j]) / m->scale[j];
+    return cost + m->coef[np];
+}
+
+void cmFree(CostModel* m) {
+    if (m->mean) free(m->mean);
+    if (m->scale) free(m->scale);
+    if (m->normal) free(m->normal);
+    if (m->coef) free(m->coef);
+    free(m);
+}
@@ -0,0 +1,34 @@
+/* -------------------------------------------------------------------------
+ * costmodel.h
+ * Prediction of the cost of the cases of a sweep from their parameters,
+ * learned from the cases finished so far
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef costmodel_h
+#define costmodel_h
+
+#include "sweep.h"
+
+#define CM_RIDGE 1e-6                // regularization, relative to the number of samples
+
+// least-squares fit of the cost, linear in the standardized parameters
+typedef struct {
+    Sweep* sweep;
+    int nFeatures;                   // the parameters and a constant
+    double* mean;                    // of each parameter over all cases
+    double* scale;                   // standard deviation of each parameter, or 1
+    double* normal;                  // normal equations, nFeatures rows of nFeatures + 1
+    double* coef;                    // coefficients of the last fit
+    int nSamples;                    // number of cases added
+    int nFits;
+} CostModel;
+
+CostModel* cmNew(Sweep* sweep);
+void cmAdd(CostModel* m, int id, double cost);
+int cmFit(CostModel* m);
+double cmPredict(CostModel* m, int id);
+void cmFree(CostModel* m);
+
+#endif // costmodel_h
@@ -0,0 +1,162 @@
+/* -------------------------------------------------------------------------
+ * counters.c
+ * Hardware performance counters of the phases of a simulation.
+ * On Linux, cycles, instructions, cache misses and branch misses of the
+ * calling thread are counted with perf_event_open, as one group that is read
+ * with a single system call at the begin and the end of each phase. The
+ * differences are summed per phase. Counters that the processor or the
+ * kernel does not provide, e.g. in a virtual machine or with a restrictive
+ * perf_event_paranoid setting, are left out; without any counter, only
+ * the calls of each phase are counted. Other platforms only count calls.
+ * The counts include the cost of reading the counters, about one system
+ * call per phase.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "counters.h"
+#include "fmuio.h"
+
+#ifdef __linux__
+#include <unistd.h>
+#include <errno.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#endif
+
+static const char* phaseNames[] = {
+    "derivatives", "event indicators", "event update", "output"
+};
+
+static const char* counterNames[] = {
+    "cycles", "instructions", "cache misses", "branch misses"
+};
+
+#ifdef __linux__
+
+static const unsigned long long counterConfigs[] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+// Returns -1 to indicate error
+static int openCounter(Counter k, int group) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = counterConfigs[k];
+    attr.disabled = group == -1;     // the leader starts the group
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group, 0);
+}
+
+// read the current values of the group into values
+static int readCounters(Counters* c, unsigned long long* values) {
+    int k;
+    unsigned long long buffer[NUMBER_OF_COUNTERS + 1]; // number of values, values
+    if (read(c->leader, buffer, sizeof(buffer)) <= 0) return 0;
+    for (k=0; k<NUMBER_OF_COUNTERS; k++) {
+        values[k] = c->index[k] >= 0 ? buffer[1 + c->index[k]] : 0;
+    }
+    return 1; // success
+}
+
+#endif
+
+// Open the counters of the calling thread. Never returns NULL unless out of
+// memory: if no hardware counter is available, calls are counted anyway.
+Counters* countersOpen() {
+    int k;
+    Counters* c = (Counters*)calloc(1, sizeof(Counters));
+    if (!c) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    c->leader = -1;
+    for (k=0; k<NUMBER_OF_COUNTERS; k++) {
+        c->fd[k] = -1;
+        c->index[k] = -1;
+    }
+#ifdef __linux__
+    for (k=0; k<NUMBER_OF_COUNTERS; k++) {
+        c->fd[k] = openCounter((Counter)k, c->leader);
+        if (c->fd[k] < 0) {
+            if (c->leader != -1) printf("warning: Hardware counter %s not available: %s\n",
+                    counterNames[k], strerror(errno));
+            else if (k == 0) printf("warning: Hardware counters not available: %s\n",
+                    strerror(errno));
+            continue;
+        }
+        if (c->leader == -1) c->leader = c->fd[k];
+        c->index[k] = c->nOpen++;
+    }
+    if (c->leader != -1) {
+        ioctl(c->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        c->available = 1;
+    }
+#else
+    printf("warning: Hardware counters are not supported on this platform\n");
+#endif
+    return c;
+}
+
+// start a phase
+void countersBegin(Counters* c) {
+#ifdef __linux__
+    if (c->available && !readCounters(c, c->start)) c->available = 0;
+#endif
+}
+
+// end the phase started last, and add its counts to the given phase
+void countersEnd(Counters* c, Phase phase) {
+#ifdef __linux__
+    int k;
+    unsigned long long values[NUMBER_OF_COUNTERS];
+    if (c->available && readCounters(c, values)) {
+        for (k=0; k<NUMBER_OF_COUNTERS; k++)
+            c->totals[phase][k] += values[k] - c->start[k];
+    }
+#endif
+    c->calls[phase]++;
+}
+
+// print the counts of all phases, for the simulation summary
+void countersPrint(Counters* c) {
+    int p, k;
+    printf("  hardware counters:\n");
+    printf("  %-17s %10s", "phase", "calls");
+    for (k=0; k<NUMBER_OF_COUNTERS; k++) {
+        if (c->index[k] >= 0) printf(" %14s", counterNames[k]);
+    }
+    if (c->available && c->index[ctCycles] >= 0 && c->index[ctInstructions] >= 0) printf("    IPC");
+    printf("\n");
+    for (p=0; p<NUMBER_OF_PHASES; p++) {
+        printf("  %-17s %10ld", phaseNames[p], c->calls[p]);
+        for (k=0; k<NUMBER_OF_COUNTERS; k++) {
+            if (c->index[k] >= 0) printf(" %14llu", c->totals[p][k]);
+        }
+        if (c->available && c->index[ctCycles] >= 0 && c->index[ctInstructions] >= 0) {
+            printf(" %6.2f", c->totals[p][ctCycles] > 0
+                    ? (double)c->totals[p][ctInstructions] / c->totals[p][ctCycles] : 0.0);
+        }
+        printf("\n");
+    }
+    if (!c->available) printf("  (hardware counters not available, calls only)\n");
+}
+
+void countersClose(Counters* c) {
+#ifdef __linux__
+    int k;
+    for (k=0; k<NUMBER_OF_COUNTERS; k++) {
+        if (c->fd[k] >= 0) close(c->fd[k]);
+    }
+#endif
+    free(c);
+}
@@ -0,0 +1,41 @@
+/* -------------------------------------------------------------------------
+ * counters.h
+ * Hardware performance counters of the phases of a simulation
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef counters_h
+#define counters_h
+
+typedef enum {
+    phDerivatives,                   // integration step, evaluating derivatives
+    phIndicators,                    // evaluation of the event indicators
+    phEventUpdate,                   // event iteration of the fmu
+    phOutput,                        // formatting and writing the result rows
+    NUMBER_OF_PHASES
+} Phase;
+
+typedef enum {
+    ctCycles, ctInstructions, ctCacheMisses, ctBranchMisses,
+    NUMBER_OF_COUNTERS
+} Counter;
+
+typedef struct {
+    int available;                   // 0 if no counter could be opened
+    int fd[NUMBER_OF_COUNTERS];      // -1 for counters not available
+    int leader;                      // fd of the first counter opened, or -1
+    int index[NUMBER_OF_COUNTERS];   // position in a read of the group, or -1
+    int nOpen;
+    unsigned long long start[NUMBER_OF_COUNTERS]; // at the begin of a phase
+    unsigned long long totals[NUMBER_OF_PHASES][NUMBER_OF_COUNTERS];
+    long calls[NUMBER_OF_PHASES];
+} Counters;
+
+Counters* countersOpen();
+void countersBegin(Counters* c);
+void countersEnd(Counters* c, Phase phase);
+void countersPrint(Counters* c);
+void countersClose(Counters* c);
+
+#endif // counters_h
@@ -0,0 +1,357 @@
+/* -------------------------------------------------------------------------
+ * csvtable.c
+ * Reading of large CSV files of numbers into columns.
+ * The first line names the columns, each following line holds a number for
+ * each column. If the separator is not ',', a ',' is the decimal point, as
+ * in the result file written by fmusim.
+ * The file is mapped into memory and cut into one chunk per thread at line
+ * ends. The threads first count the rows of their chunk, which gives the
+ * first row of each chunk, and then parse their rows in parallel into the
+ * columns. Line ends are found with memchr, which the C library implements
+ * with vector instructions. Numbers of up to 19 significant digits with a
+ * decimal exponent of at most 22 are converted exactly by one multiplication
+ * or division with an exact power of ten; other numbers, nan and inf are
+ * left to strtod.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "csvtable.h"
+#include "fmuthread.h"
+
+#ifdef _MSC_VER
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+#define CSV_DIGITS 19                // significant digits that fit a 64-bit mantissa
+#define CSV_TOKEN 64                 // longest number passed to strtod
+#define CSV_CHUNK_MIN 65536          // smallest chunk of a thread, in bytes
+
+// the lines of the file parsed by one thread
+typedef struct {
+    CsvTable* table;
+    const char* begin;
+    const char* end;
+    char separator;
+    char decimal;
+    long firstRow;
+    long nRows;
+    long badRow;                     // first row that is not numbers, or -1
+} CsvChunk;
+
+// the powers of ten that are exact doubles
+static const double powers[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// -------------------------------------------------------------------------
+// Mapping the file
+
+// Map the file at path into memory. Returns NULL to indicate error
+static const char* mapFile(const char* path, size_t* size) {
+#ifdef _MSC_VER
+    char* data;
+    FILE* file = fopen(path, "rb");
+    if (!file) return NULL;
+    fseek(file, 0, SEEK_END);
+    *size = ftell(file);
+    rewind(file);
+    data = (char*)malloc(*size + 1);
+    if (data && fread(data, 1, *size, file) != *size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(file);
+    return data;
+#else
+    struct stat st;
+    void* data;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    if (fstat(fd, &st) || st.st_size == 0) {
+        close(fd);
+        return NULL;
+    }
+    *size = st.st_size;
+    data = mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) return NULL;
+    madvise(data, *size, MADV_SEQUENTIAL);
+    return (const char*)data;
+#endif
+}
+
+static void unmapFile(const char* data, size_t size) {
+#ifdef _MSC_VER
+    free((char*)data);
+#else
+    munmap((void*)data, size);
+#endif
+}
+
+// -------------------------------------------------------------------------
+// Parsing
+
+// Parse the number at p with strtod. Returns its end, or NULL to indicate error
+static const char* parseSlow(const char* p, const char* end, char separator, char decimal,
+        double* value) {
+    char token[CSV_TOKEN];
+    char* stop;
+    int n = 0;
+    while (p + n < end && p[n] != separator && p[n] != '\r' && n < CSV_TOKEN - 1) {
+        token[n] = p[n] == decimal ? '.' : p[n];
+        n++;
+    }
+    token[n] = '\0';
+    *value = strtod(token, &stop);
+    return n > 0 && stop == token + n ? p + n : NULL;
+}
+
+// Parse the number at p, ending at end or a separator.
+// Returns its end, or NULL to indicate error
+static const char* parseNumber(const char* p, const char* end, char separator, char decimal,
+        double* value) {
+    const char* start = p;
+    unsigned long long m = 0;
+    int digits = 0;                  // significant digits in m
+    int exp10 = 0;
+    int truncated = 0;               // 1 if digits were dropped from m
+    int negative = 0;
+    int any = 0;
+    int e = 0;
+    int eNegative = 0;
+    if (p < end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+    for (; p < end && *p >= '0' && *p <= '9'; p++, any = 1) {
+        if (digits < CSV_DIGITS) {
+            m = 10 * m + (*p - '0');
+            if (m) digits++;
+        }
+        else {
+            exp10++;
+            if (*p != '0') truncated = 1;
+        }
+    }
+    if (p < end && *p == decimal) {
+        for (p++; p < end && *p >= '0' && *p <= '9'; p++, any = 1) {
+            if (digits < CSV_DIGITS) {
+                m = 10 * m + (*p - '0');
+                if (m) digits++;
+                exp10--;
+            }
+            else if (*p != '0') truncated = 1;
+        }
+    }
+    if (any && p < end && (*p == 'e' || *p == 'E')) {
+        p++;
+        if (p < end && (*p == '-' || *p == '+')) eNegative = *p++ == '-';
+        if (p == end || *p < '0' || *p > '9') return NULL;
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (e < 10000) e = 10 * e + (*p - '0');
+        }
+        exp10 += eNegative ? -e : e;
+    }
+    if (!any || (p < end && *p != separator && *p != '\r'))
+        return parseSlow(start, end, separator, decimal, value);
+    if (truncated || m > (1ULL << 53) || exp10 < -22 || exp10 > 22)
+        return parseSlow(start, p, separator, decimal, value);
+    *value = exp10 < 0 ? (double)m / powers[-exp10] : (double)m * powers[exp10];
+    if (negative) *value = -*value;
+    return p;
+}
+
+// 1 if the line is empty
+static int isBlank(const char* p, const char* eol) {
+    return eol == p || (eol - p == 1 && *p == '\r');
+}
+
+// Parse the line as row of the table. Returns 0 to indicate error
+static int parseRow(CsvChunk* c, const char* p, const char* eol, long row) {
+    int k;
+    int n = c->table->nColumns;
+    for (k=0; k<n; k++) {
+        p = parseNumber(p, eol, c->separator, c->decimal, &c->table->columns[k][row]);
+        if (!p) return 0;
+        if (k+1 == n) break;
+        if (p == eol || *p != c->separator) return 0;
+        p++;
+    }
+    while (p < eol && *p == '\r') p++;
+    return p == eol;
+}
+
+static void countRows(void* arg) {
+    CsvChunk* c = (CsvChunk*)arg;
+    const char* p;
+    const char* eol;
+    for (p = c->begin; p < c->end; p = eol + 1) {
+        eol = (const char*)memchr(p, '\n', c->end - p);
+        if (!eol) eol = c->end;
+        if (!isBlank(p, eol)) c->nRows++;
+    }
+}
+
+static void parseRows(void* arg) {
+    CsvChunk* c = (CsvChunk*)arg;
+    const char* p;
+    const char* eol;
+    long row = c->firstRow;
+    for (p = c->begin; p < c->end; p = eol + 1) {
+        eol = (const char*)memchr(p, '\n', c->end - p);
+        if (!eol) eol = c->end;
+        if (isBlank(p, eol)) continue;
+        if (!parseRow(c, p, eol, row)) {
+            c->badRow = row;
+            return;
+        }
+        row++;
+    }
+}
+
+// run f for each chunk, on a thread per chunk
+static void runChunks(CsvChunk* chunks, int n, ThreadFunction f) {
+    Thread* threads = (Thread*)calloc(n, sizeof(Thread));
+    int i, k;
+    for (i=1; threads && i<n; i++) {
+        if (!threadCreate(&threads[i], f, &chunks[i])) break;
+    }
+    for (k=i; k<n; k++) f(&chunks[k]); // no thread started
+    f(&chunks[0]);
+    while (--i > 0) threadJoin(threads[i]);
+    if (threads) free(threads);
+}
+
+// Read the names of the columns from the first line, and detect the
+// separator if it is 0. Returns the start of the next line, or NULL to
+// indicate error
+static const char* parseHeader(CsvTable* t, const char* p, const char* end, char* separator) {
+    const char* eol = (const char*)memchr(p, '\n', end - p);
+    const char* q;
+    const char* stop;
+    int n;
+    if (!eol) eol = end;
+    n = eol > p && eol[-1] == '\r' ? eol - p - 1 : eol - p;
+    if (*separator == 0) {
+        *separator = memchr(p, ';', n) ? ';' : memchr(p, '\t', n) ? '\t' : ',';
+    }
+    for (q = p, t->nColumns = 1; q < p + n; q++) {
+        if (*q == *separator) t->nColumns++;
+    }
+    t->names = (char**)calloc(t->nColumns, sizeof(char*));
+    if (!t->names) return NULL;
+    for (q = p, t->nColumns = 0; ; q = stop + 1) {
+        stop = (const char*)memchr(q, *separator, p + n - q);
+        if (!stop) stop = p + n;
+        t->names[t->nColumns] = (char*)calloc(stop - q + 1, sizeof(char));
+        if (!t->names[t->nColumns]) return NULL;
+        memcpy(t->names[t->nColumns++], q, stop - q);
+        if (stop == p + n) break;
+    }
+    return eol < end ? eol + 1 : end;
+}
+
+// Read the CSV file at path with the given separator, or with the separator
+// found in its first line if separator is 0, using up to nThreads threads.
+// Returns NULL to indicate error
+CsvTable* csvRead(const char* path, char separator, int nThreads) {
+    size_t size;
+    const char* data = mapFile(path, &size);
+    const char* body;
+    const char* end = data + size;
+    CsvTable* t;
+    CsvChunk* chunks;
+    int i, k, n;
+    int ok = 0;
+    long row;
+    if (!data) {
+        printf("error: Could not read CSV file %s\n", path);
+        return NULL;
+    }
+    t = (CsvTable*)calloc(1, sizeof(CsvTable));
+    if (!t || !(body = parseHeader(t, data, end, &separator))) {
+        printf("error: out of memory\n");
+        unmapFile(data, size);
+        if (t) csvFree(t);
+        return NULL;
+    }
+
+    // cut the body into chunks at line ends
+    n = (int)((end - body) / CSV_CHUNK_MIN) + 1;
+    if (n > nThreads) n = nThreads;
+    if (n < 1) n = 1;
+    chunks = (CsvChunk*)calloc(n, sizeof(CsvChunk));
+    if (!chunks) {
+        printf("error: out of memory\n");
+        unmapFile(data, size);
+        csvFree(t);
+        return NULL;
+    }
+    for (i=0; i<n; i++) {
+        const char* p = body + (end - body) / n * i;
+        if (i > 0) {
+            if (p < chunks[i-1].begin) p = chunks[i-1].begin;
+            p = (const char*)memchr(p, '\n', end - p);
+            p = p ? p + 1 : end;
+            chunks[i-1].end = p;
+        }
+        chunks[i].table = t;
+        chunks[i].begin = p;
+        chunks[i].end = end;
+        chunks[i].separator = separator;
+        chunks[i].decimal = separator == ',' ? '.' : ',';
+        chunks[i].badRow = -1;
+    }
+
+    // count the rows, then parse them into the columns
+    runChunks(chunks, n, countRows);
+    for (i=0, row=0; i<n; i++) {
+        chunks[i].firstRow = row;
+        row += chunks[i].nRows;
+    }
+    t->nRows = row;
+    t->columns = (double**)calloc(t->nColumns, sizeof(double*));
+    for (k=0; t->columns && k<t->nColumns; k++) {
+        if (!(t->columns[k] = (double*)malloc((t->nRows + 1) * sizeof(double)))) break;
+    }
+    if (!t->columns || k < t->nColumns) printf("error: out of memory\n");
+    else {
+        runChunks(chunks, n, parseRows);
+        for (i=0; i<n && chunks[i].badRow < 0; i++);
+        if (i < n) printf("error: Row %ld of CSV file %s is not %d numbers\n",
+                chunks[i].badRow + 1, path, t->nColumns);
+        ok = i == n;
+    }
+    free(chunks);
+    unmapFile(data, size);
+    if (!ok) {
+        csvFree(t);
+        return NULL;
+    }
+    return t;
+}
+
+// Returns the index of the column of the given name, or -1 if not found
+int csvColumn(CsvTable* t, const char* name) {
+    int k;
+    for (k=0; k<t->nColumns; k++) {
+        if (!strcmp(t->names[k], name)) return k;
+    }
+    return -1;
+}
+
+void csvFree(CsvTable* t) {
+    int k;
+    for (k=0; t->names && k<t->nColumns; k++) if (t->names[k]) free(t->names[k]);
+    for (k=0; t->columns && k<t->nColumns; k++) if (t->columns[k]) free(t->columns[k]);
+    if (t->names) free(t->names);
+    if (t->columns) free(t->columns);
+    free(t);
+}
@@ -0,0 +1,22 @@
+/* -------------------------------------------------------------------------
+ * csvtable.h
+ * Reading of large CSV files of numbers into columns
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef csvtable_h
+#define csvtable_h
+
+typedef struct {
+    int nColumns;
+    char** names;                    // from the first line
+    long nRows;
+    double** columns;                // nRows values of each column
+} CsvTable;
+
+CsvTable* csvRead(const char* path, char separator, int nThreads);
+int csvColumn(CsvTable* t, const char* name);
+void csvFree(CsvTable* t);
+
+#endif // csvtable_h
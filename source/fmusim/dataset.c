@@ -0,0 +1,499 @@
+/* -------------------------------------------------------------------------
+ * dataset.c
+ * Columnar output of the trajectories of all cases of an ensemble run.
+ * The dataset is a directory with one file per partition and an index.
+ * Case id goes to partition id % nPartitions, into slot id / nPartitions.
+ * Every case has room for nRows rows, at multiples of dt from firstRow * dt
+ * up to tEnd. firstRow is 0, unless the cases branch from a common prefix
+ * simulated once. Then the rows of the prefix, up to the branch time, are
+ * written once to the prefix file, a partition file without slots that
+ * holds firstRow rows of each column after the names.
+ * A partition file holds, in native byte order:
+ *   char[8]            magic "FMUDS002"
+ *   int64[8]           partition (-1 for the prefix file), nPartitions,
+ *                      capacity (number of slots), nRows, nColumns,
+ *                      nParameters, nCases, firstRow
+ *   double             dt
+ *   char[]             names of the columns and parameters, each terminated
+ *                      by '\0', padded with '\0' to a multiple of 8 bytes
+ *   int64[capacity]    case id of each slot, -1 if empty
+ *   int64[capacity]    number of rows of each slot
+ *   double[nParameters][capacity]      parameter values of each slot
+ *   double[nColumns][capacity * nRows] values of each column
+ * Row r of slot k of a column is at index k * nRows + r, unwritten rows are
+ * NaN. Hence the values of a column at a given time for all cases of a
+ * partition are one strided read. The index file lists the partition, slot,
+ * first row and number of rows of each case, and the prefix file holds the
+ * common rows before.
+ * The trajectory of a case is handed over when the case is finished. Cases
+ * are collected in blocks of DS_BLOCK consecutive slots, and a block is
+ * written when it is complete, with one write per column. dsSync writes
+ * the slots of incomplete blocks too, without touching the other slots, and
+ * syncs the files; this is done before cases are recorded in a journal, so
+ * the dataset holds every journaled case when resuming. Each partition
+ * has its own lock, so workers finishing cases of different partitions
+ * do not wait for each other.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef _MSC_VER
+#define _FILE_OFFSET_BITS 64
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include "dataset.h"
+#include "fmuio.h"
+
+#ifdef _MSC_VER
+#include <direct.h>
+#include <io.h>
+#define fseek64 _fseeki64
+#define makeDir(path) _mkdir(path)
+#define fsync _commit
+#define fileno _fileno
+#else
+#include <sys/types.h>
+#include <unistd.h>
+#define fseek64 fseeko
+#define makeDir(path) mkdir(path, 0777)
+#endif
+
+// -------------------------------------------------------------------------
+// File layout
+
+static long long parametersOffset(Dataset* ds, DsPartition* p) {
+    return ds->headerSize + 2 * p->capacity * (long long)sizeof(long long);
+}
+
+static long long columnOffset(Dataset* ds, DsPartition* p, int column) {
+    int nParameters = ds->sweep ? ds->sweep->nParameters : 0;
+    return parametersOffset(ds, p) + (long long)nParameters * p->capacity * sizeof(double)
+            + (long long)column * p->capacity * ds->nRows * sizeof(double);
+}
+
+// Returns 0 to indicate error
+static int writeAt(FILE* file, long long offset, const void* data, size_t size, size_t n) {
+    return fseek64(file, offset, SEEK_SET) == 0 && fwrite(data, size, n, file) == n;
+}
+
+// Write the slots first to first + n - 1 of partition p except their values.
+// Returns 0 to indicate error
+static int writeSlots(Dataset* ds, DsPartition* p, int first, int n) {
+    int k;
+    int nParameters = ds->sweep ? ds->sweep->nParameters : 0;
+    int ok = writeAt(p->file, ds->headerSize + first * (long long)sizeof(long long),
+                p->caseIds + first, sizeof(long long), n)
+            && writeAt(p->file, ds->headerSize + (p->capacity + first) * (long long)sizeof(long long),
+                p->caseRows + first, sizeof(long long), n);
+    for (k=0; k<nParameters && ok; k++) {
+        ok = writeAt(p->file, parametersOffset(ds, p) + ((long long)k * p->capacity + first) * sizeof(double),
+                p->parameters + k * p->capacity + first, sizeof(double), n);
+    }
+    return ok;
+}
+
+// Build the header of partition i, or of the prefix file for i = -1,
+// of ds->headerSize bytes.
+// Returns NULL to indicate error
+static char* buildHeader(Dataset* ds, int i) {
+    int k, n;
+    long long fields[8];
+    int nParameters = ds->sweep ? ds->sweep->nParameters : 0;
+    char* header = (char*)calloc((size_t)ds->headerSize, 1);
+    char* p;
+    if (!header) return NULL;
+    memcpy(header, DS_MAGIC, 8);
+    fields[0] = i;
+    fields[1] = ds->nPartitions;
+    fields[2] = i >= 0 ? ds->partitions[i].capacity : 0;
+    fields[3] = ds->nRows;
+    fields[4] = ds->nColumns;
+    fields[5] = nParameters;
+    fields[6] = ds->nCases;
+    fields[7] = ds->firstRow;
+    memcpy(header + 8, fields, sizeof(fields));
+    memcpy(header + 8 + sizeof(fields), &ds->dt, sizeof(double));
+    p = header + 16 + sizeof(fields);
+    for (k=0; k<ds->nColumns + nParameters; k++) {
+        const char* name = k < ds->nColumns ? ds->names[k]
+                : getName(ds->sweep->parameters[k - ds->nColumns]);
+        n = strlen(name) + 1;
+        memcpy(p, name, n);
+        p += n;
+    }
+    return header;
+}
+
+static long long getHeaderSize(Dataset* ds) {
+    int k;
+    int nParameters = ds->sweep ? ds->sweep->nParameters : 0;
+    long long n = 16 + 8 * sizeof(long long);
+    for (k=0; k<ds->nColumns; k++) n += strlen(ds->names[k]) + 1;
+    for (k=0; k<nParameters; k++) n += strlen(getName(ds->sweep->parameters[k])) + 1;
+    return (n + 7) / 8 * 8;
+}
+
+// -------------------------------------------------------------------------
+// Opening
+
+// Select the columns: time and all non-alias variables that are not strings,
+// ordered by type. Returns 0 to indicate error
+static int initColumns(Dataset* ds, ModelDescription* md) {
+    int i, k, n;
+    ScalarVariable** vars = md->modelVariables;
+    Elm types[] = { elm_Real, elm_Integer, elm_Enumeration, elm_Boolean };
+    for (n=0; vars[n]; n++);
+    ds->names = (const char**)calloc(n + 1, sizeof(char*));
+    ds->types = (Elm*)calloc(n + 1, sizeof(Elm));
+    ds->vrs = (fmiValueReference*)calloc(n + 1, sizeof(fmiValueReference));
+    if (!ds->names || !ds->types || !ds->vrs) return fmuError("out of memory");
+    ds->names[0] = "time";
+    ds->types[0] = elm_Real;
+    ds->nColumns = 1;
+    for (k=0; k<4; k++) {
+        for (i=0; vars[i]; i++) {
+            if (getAlias(vars[i]) != enu_noAlias || vars[i]->typeSpec->type != types[k]) continue;
+            ds->names[ds->nColumns] = getName(vars[i]);
+            ds->types[ds->nColumns] = types[k] == elm_Enumeration ? elm_Integer : types[k];
+            ds->vrs[ds->nColumns] = getValueReference(vars[i]);
+            ds->nColumns++;
+        }
+        if (k == 0) ds->nReals = ds->nColumns - 1;
+    }
+    return 1; // success
+}
+
+// Open partition i, and when resuming read the slots written earlier.
+// Returns 0 to indicate error
+static int openPartition(Dataset* ds, int i, const char* done) {
+    int k, id;
+    int ok = 1;
+    char* fileName;
+    char* header;
+    char* existing;
+    DsPartition* p = &ds->partitions[i];
+    int nParameters = ds->sweep ? ds->sweep->nParameters : 0;
+    int resume = 0;
+    p->capacity = (ds->nCases - i + ds->nPartitions - 1) / ds->nPartitions;
+    p->nBlocks = (p->capacity + DS_BLOCK - 1) / DS_BLOCK;
+    p->caseIds = (long long*)calloc(p->capacity + 1, sizeof(long long));
+    p->caseRows = (long long*)calloc(p->capacity + 1, sizeof(long long));
+    p->parameters = (double*)calloc(nParameters * p->capacity + 1, sizeof(double));
+    p->blocks = (DsBlock*)calloc(p->nBlocks + 1, sizeof(DsBlock));
+    fileName = (char*)calloc(strlen(ds->path) + strlen(DS_PARTITION_FILE) + 16, sizeof(char));
+    header = buildHeader(ds, i);
+    existing = (char*)calloc((size_t)ds->headerSize, 1);
+    if (!p->caseIds || !p->caseRows || !p->parameters || !p->blocks || !fileName
+            || !header || !existing) {
+        if (fileName) free(fileName);
+        if (header) free(header);
+        if (existing) free(existing);
+        return fmuError("out of memory");
+    }
+    for (k=0; k<p->capacity; k++) {
+        id = k * ds->nPartitions + i;
+        p->caseIds[k] = -1;
+        if (done && done[id]) resume = 1;
+        else p->blocks[k / DS_BLOCK].expected++;
+    }
+
+    sprintf(fileName, "%s/" DS_PARTITION_FILE, ds->path, i);
+    if (resume) {
+        // keep the slots of the cases done, as recorded in the file
+        p->file = fopen(fileName, "r+b");
+        if (!p->file || fread(existing, 1, (size_t)ds->headerSize, p->file) != ds->headerSize
+                || memcmp(existing, header, (size_t)ds->headerSize)
+                || fread(p->caseIds, sizeof(long long), p->capacity, p->file) != p->capacity
+                || fread(p->caseRows, sizeof(long long), p->capacity, p->file) != p->capacity
+                || fread(p->parameters, sizeof(double), nParameters * p->capacity, p->file)
+                        != nParameters * p->capacity) {
+            printf("error: Dataset file %s does not match the run\n", fileName);
+            ok = 0;
+        }
+    }
+    else {
+        // a valid file without cases
+        p->file = fopen(fileName, "w+b");
+        if (p->file && !(writeAt(p->file, 0, header, 1, (size_t)ds->headerSize)
+                && writeSlots(ds, p, 0, p->capacity))) {
+            printf("error: Could not write dataset file %s\n", fileName);
+            ok = 0;
+        }
+    }
+    if (ok && !p->file) {
+        printf("error: Could not open dataset file %s\n", fileName);
+        ok = 0;
+    }
+    for (k=0; k<p->capacity && done && ok; k++) {
+        id = k * ds->nPartitions + i;
+        if (done[id] && p->caseIds[k] != id) {
+            printf("error: Case %d is missing in dataset file %s\n", id, fileName);
+            ok = 0;
+        }
+    }
+    free(fileName);
+    free(header);
+    free(existing);
+    return ok;
+}
+
+// Close the files of the partitions and free ds
+static void freeDataset(Dataset* ds) {
+    int i;
+    for (i=0; i<ds->nPartitions && ds->partitions; i++) {
+        DsPartition* p = &ds->partitions[i];
+        if (p->file) fclose(p->file);
+        mutexFree(&p->mutex);
+        if (p->caseIds) free(p->caseIds);
+        if (p->caseRows) free(p->caseRows);
+        if (p->parameters) free(p->parameters);
+        if (p->blocks) free(p->blocks);
+    }
+    if (ds->partitions) free(ds->partitions);
+    if (ds->names) free(ds->names);
+    if (ds->types) free(ds->types);
+    if (ds->vrs) free(ds->vrs);
+    if (ds->path) free(ds->path);
+    free(ds);
+}
+
+// Open the dataset in directory path for nCases cases with rows at multiples
+// of dt up to tEnd. If tBranch is positive, the rows up to tBranch are
+// common to all cases and written with dsWritePrefix. If done is not NULL,
+// it flags the cases written to the existing dataset by an earlier run,
+// which are kept.
+// Returns NULL to indicate error
+Dataset* dsOpen(const char* path, ModelDescription* md, Sweep* sweep, int nCases,
+        double tBranch, double tEnd, double dt, int nPartitions, const char* done) {
+    int i;
+    struct stat st;
+    Dataset* ds;
+    if (makeDir(path) != 0 && errno != EEXIST) {
+        printf("error: Could not create dataset directory %s: %s\n", path, strerror(errno));
+        return NULL;
+    }
+    if (stat(path, &st) != 0 || !(st.st_mode & S_IFDIR)) {
+        printf("error: Dataset path %s is not a directory\n", path);
+        return NULL;
+    }
+    ds = (Dataset*)calloc(1, sizeof(Dataset));
+    if (!ds) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    if (nPartitions > nCases) nPartitions = nCases;
+    ds->path = strdup(path);
+    ds->nCases = nCases;
+    ds->dt = dt;
+    ds->firstRow = tBranch > 0 ? (int)floor(tBranch / dt + DS_EPS) + 1 : 0;
+    ds->nRows = (int)floor(tEnd / dt + DS_EPS) + 1 - ds->firstRow;
+    ds->sweep = sweep;
+    ds->nPartitions = nPartitions;
+    ds->partitions = (DsPartition*)calloc(nPartitions, sizeof(DsPartition));
+    if (!ds->partitions) {
+        ds->nPartitions = 0;
+        freeDataset(ds);
+        fmuError("out of memory");
+        return NULL;
+    }
+    for (i=0; i<nPartitions; i++) mutexInit(&ds->partitions[i].mutex);
+    if (!ds->path || !initColumns(ds, md)) {
+        freeDataset(ds);
+        fmuError("out of memory");
+        return NULL;
+    }
+    ds->headerSize = getHeaderSize(ds);
+    for (i=0; i<nPartitions; i++) {
+        if (!openPartition(ds, i, done)) {
+            freeDataset(ds);
+            return NULL;
+        }
+    }
+    return ds;
+}
+
+// -------------------------------------------------------------------------
+// Writing
+
+// Fetch the values of all columns of model c at the given time into row.
+// Returns 0 to indicate error
+int dsFetchRow(Dataset* ds, FMU* fmu, fmiComponent c, double time, double* row) {
+    int k;
+    fmiInteger i;
+    fmiBoolean b;
+    fmiStatus status = fmiOK;
+    row[0] = time;
+    if (ds->nReals > 0) status = fmu->getReal(c, ds->vrs + 1, ds->nReals, row + 1);
+    for (k = ds->nReals + 1; k<ds->nColumns && status <= fmiWarning; k++) {
+        if (ds->types[k] == elm_Integer) {
+            status = fmu->getInteger(c, &ds->vrs[k], 1, &i);
+            row[k] = i;
+        }
+        else {
+            status = fmu->getBoolean(c, &ds->vrs[k], 1, &b);
+            row[k] = b;
+        }
+    }
+    if (status > fmiWarning) return fmuError("could not get values for the dataset");
+    return 1; // success
+}
+
+// Write the handed over slots of block b of partition p, one write per
+// column for each run of consecutive slots, and release the values.
+// Returns 0 to indicate error
+static int flushBlock(Dataset* ds, DsPartition* p, int b) {
+    int c, first, n;
+    int ok = 1;
+    DsBlock* block = &p->blocks[b];
+    int nSlots = p->capacity - b * DS_BLOCK < DS_BLOCK ? p->capacity - b * DS_BLOCK : DS_BLOCK;
+    for (first=0; first<nSlots && ok; first+=n) {
+        for (n=0; first+n<nSlots && block->filled[first+n]; n++);
+        if (n == 0) {
+            n = 1; // skip a slot not handed over
+            continue;
+        }
+        ok = writeSlots(ds, p, b * DS_BLOCK + first, n);
+        for (c=0; c<ds->nColumns && ok && block->values; c++) {
+            ok = writeAt(p->file, columnOffset(ds, p, c)
+                        + ((long long)b * DS_BLOCK + first) * ds->nRows * sizeof(double),
+                    block->values + ((size_t)c * DS_BLOCK + first) * ds->nRows,
+                    sizeof(double), (size_t)n * ds->nRows);
+        }
+        memset(block->filled + first, 0, n);
+    }
+    if (block->values) free(block->values);
+    block->values = NULL;
+    if (!ok) return fmuError("could not write dataset");
+    return 1; // success
+}
+
+// Hand over the trajectory of case id: nRows rows of ds->nColumns values.
+// A failed case is handed over with no rows. The block of the case is
+// written when all its cases are handed over.
+// Returns 0 to indicate error
+int dsWriteCase(Dataset* ds, int id, double* rows, int nRows) {
+    int c, r, k;
+    int ok = 1;
+    DsPartition* p = &ds->partitions[id % ds->nPartitions];
+    int slot = id / ds->nPartitions;
+    int b = slot / DS_BLOCK;
+    DsBlock* block = &p->blocks[b];
+    double* values;
+    mutexLock(&p->mutex);
+    p->caseIds[slot] = id;
+    p->caseRows[slot] = nRows;
+    if (ds->sweep) {
+        for (k=0; k<ds->sweep->nParameters; k++)
+            p->parameters[k * p->capacity + slot] = ds->sweep->values[id * ds->sweep->nParameters + k];
+    }
+    if (nRows > 0 && !block->values) {
+        size_t n = (size_t)ds->nColumns * DS_BLOCK * ds->nRows;
+        double nan = sqrt(-1.0);
+        block->values = (double*)malloc(n * sizeof(double));
+        if (block->values) while (n > 0) block->values[--n] = nan;
+        else ok = fmuError("out of memory");
+    }
+    if (nRows > 0 && ok) {
+        values = block->values + (slot % DS_BLOCK) * ds->nRows;
+        for (c=0; c<ds->nColumns; c++) {
+            for (r=0; r<nRows; r++) values[r] = rows[r * ds->nColumns + c];
+            values += DS_BLOCK * ds->nRows;
+        }
+    }
+    block->filled[slot % DS_BLOCK] = 1;
+    if (--block->expected == 0 && ok) ok = flushBlock(ds, p, b);
+    mutexUnlock(&p->mutex);
+    return ok;
+}
+
+// Write the prefix file: nRows rows of ds->nColumns values, common to all
+// cases. Rows up to ds->firstRow that are not given, because the prefix
+// terminated early, are NaN.
+// Returns 0 to indicate error
+int dsWritePrefix(Dataset* ds, double* rows, int nRows) {
+    int c, r;
+    int ok;
+    char* fileName;
+    char* header = buildHeader(ds, -1);
+    double* values = (double*)calloc(ds->firstRow + 1, sizeof(double));
+    double nan = sqrt(-1.0);
+    FILE* file;
+    fileName = (char*)calloc(strlen(ds->path) + strlen(DS_PREFIX_FILE) + 2, sizeof(char));
+    if (!header || !values || !fileName) return fmuError("out of memory");
+    sprintf(fileName, "%s/%s", ds->path, DS_PREFIX_FILE);
+    file = fopen(fileName, "wb");
+    ok = file && fwrite(header, 1, (size_t)ds->headerSize, file) == ds->headerSize;
+    for (c=0; c<ds->nColumns && ok; c++) {
+        for (r=0; r<ds->firstRow; r++) values[r] = r < nRows ? rows[r * ds->nColumns + c] : nan;
+        ok = fwrite(values, sizeof(double), ds->firstRow, file) == ds->firstRow;
+    }
+    if (file && fclose(file) != 0) ok = 0;
+    if (!ok) printf("error: Could not write dataset file %s\n", fileName);
+    free(fileName);
+    free(header);
+    free(values);
+    return ok;
+}
+
+// Write all cases handed over so far and sync the files, e.g. before
+// recording these cases as finished in a journal.
+// Returns 0 to indicate error
+int dsSync(Dataset* ds) {
+    int i, b;
+    int ok = 1;
+    for (i=0; i<ds->nPartitions; i++) {
+        DsPartition* p = &ds->partitions[i];
+        mutexLock(&p->mutex);
+        for (b=0; b<p->nBlocks && ok; b++) ok = flushBlock(ds, p, b);
+        ok = ok && fflush(p->file) == 0 && fsync(fileno(p->file)) == 0;
+        mutexUnlock(&p->mutex);
+    }
+    if (!ok) return fmuError("could not sync dataset");
+    return 1; // success
+}
+
+// -------------------------------------------------------------------------
+// Closing
+
+// Write the remaining blocks and the index, and free ds.
+// Returns 0 to indicate error
+int dsClose(Dataset* ds, char separator) {
+    int i, b, id;
+    int ok = 1;
+    char* fileName;
+    FILE* file;
+    for (i=0; i<ds->nPartitions; i++) {
+        DsPartition* p = &ds->partitions[i];
+        for (b=0; b<p->nBlocks; b++) {
+            if (!flushBlock(ds, p, b)) ok = 0;
+        }
+        if (fclose(p->file) != 0) ok = fmuError("could not write dataset");
+        p->file = NULL;
+    }
+
+    // the index, ordered by case id
+    fileName = (char*)calloc(strlen(ds->path) + strlen(DS_INDEX_FILE) + 2, sizeof(char));
+    if (fileName) sprintf(fileName, "%s/%s", ds->path, DS_INDEX_FILE);
+    file = fileName ? fopen(fileName, "w") : NULL;
+    if (file) {
+        fprintf(file, "case%cpartition%cslot%cfirstRow%crows\n",
+                separator, separator, separator, separator);
+        for (id=0; id<ds->nCases; id++) {
+            DsPartition* p = &ds->partitions[id % ds->nPartitions];
+            int slot = id / ds->nPartitions;
+            fprintf(file, "%d%c%d%c%d%c%lld%c%lld\n", id, separator, id % ds->nPartitions,
+                    separator, slot, separator, (long long)slot * ds->nRows,
+                    separator, p->caseRows[slot]);
+        }
+        fclose(file);
+    }
+    else ok = fmuError("could not write dataset index");
+    if (fileName) free(fileName);
+    freeDataset(ds);
+    return ok;
+}
@@ -0,0 +1,67 @@
+/* -------------------------------------------------------------------------
+ * dataset.h
+ * Columnar output of the trajectories of all cases of an ensemble run,
+ * in a few partition files.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef dataset_h
+#define dataset_h
+
+#include <stdio.h>
+#include "main.h"
+#include "sweep.h"
+#include "fmuthread.h"
+
+#define DS_MAGIC "FMUDS002"
+#define DS_BLOCK 64                  // case slots per write-back block
+#define DS_PARTITION_FILE "part%d.fds"
+#define DS_INDEX_FILE "index.csv"
+#define DS_PREFIX_FILE "prefix.fds"
+#define DS_EPS 1e-9                  // tolerance of row times, relative to dt
+
+// buffered values of the consecutive case slots of a block
+typedef struct {
+    int expected;                    // number of cases still to be handed over
+    char filled[DS_BLOCK];           // 1 for slots handed over but not written
+    double* values;                  // nColumns x DS_BLOCK x nRows values, or NULL
+} DsBlock;
+
+typedef struct {
+    FILE* file;
+    Mutex mutex;                     // one writer per partition
+    int capacity;                    // number of case slots
+    long long* caseIds;              // of each slot, -1 if empty
+    long long* caseRows;             // number of rows written for each slot
+    double* parameters;              // nParameters x capacity values
+    DsBlock* blocks;
+    int nBlocks;
+} DsPartition;
+
+typedef struct {
+    char* path;                      // directory of the dataset
+    int nCases;
+    int nRows;                       // maximum number of rows of a case
+    int firstRow;                    // rows before are in the prefix file
+    double dt;                       // time between rows
+    int nColumns;                    // time, Reals, Integers and Booleans
+    int nReals;                      // Real columns, following time
+    const char** names;              // of the columns
+    Elm* types;                      // of the columns, elm_Real for time
+    fmiValueReference* vrs;          // of the columns
+    Sweep* sweep;                    // parameters of the cases, or NULL
+    DsPartition* partitions;
+    int nPartitions;
+    long long headerSize;            // bytes before the case ids
+} Dataset;
+
+Dataset* dsOpen(const char* path, ModelDescription* md, Sweep* sweep, int nCases,
+        double tBranch, double tEnd, double dt, int nPartitions, const char* done);
+int dsFetchRow(Dataset* ds, FMU* fmu, fmiComponent c, double time, double* row);
+int dsWriteCase(Dataset* ds, int id, double* rows, int nRows);
+int dsWritePrefix(Dataset* ds, double* rows, int nRows);
+int dsSync(Dataset* ds);
+int dsClose(Dataset* ds, char separator);
+
+#endif // dataset_h
@@ -0,0 +1,205 @@
+/* -------------------------------------------------------------------------
+ * diagnostics.c
+ * Per-step solver diagnostics of a simulation, to find out which states
+ * and events limit the step size. The methods of fmusim use a fixed step
+ * size, so the diagnostics show what an adaptive solver would do: after
+ * each step, the local error of each state is estimated by solverError and
+ * weighted by the magnitude of the state or its nominal value, like the
+ * error measured by tune.c. The step error is the largest weighted error,
+ * and the state that has it dominates the step. A step above the tolerance
+ * would have been rejected and retried with a smaller step size.
+ * A state event would have been located by shortening the step to the
+ * crossing of the event indicator.
+ * Each step is written as a row of a CSV file with the columns
+ *   step, time, h, error, accepted, state, limit, indicator
+ * where limit tells whether the step ended on the grid, or at a time event
+ * or the end time before it, and indicator is the first event indicator
+ * that changed sign in the step, if any. The explicit methods of fmusim
+ * have no Newton iteration to report.
+ * After the run, the states are ranked by the number of steps above the
+ * tolerance they dominated, and the event indicators by their state events.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "diagnostics.h"
+#include "fmuio.h"
+
+static const char* limitNames[] = { "grid", "time event", "end" };
+
+// write a number to a CSV file, with decimal comma unless separator is ','
+static void printReal(FILE* file, const char* format, double r, char separator) {
+    char buffer[32];
+    char* comma;
+    sprintf(buffer, format, r);
+    comma = separator == ',' ? NULL : strchr(buffer, '.');
+    if (comma) *comma = ',';
+    fprintf(file, "%c%s", separator, buffer);
+}
+
+// the name of the variable of the state with the given vr, or x[i]
+static char* stateName(ModelDescription* md, fmiValueReference vr, int i) {
+    char buffer[32];
+    ScalarVariable* sv = vr == fmiUndefinedValueReference ? NULL : getVariable(md, vr, elm_Real);
+    if (sv) return strdup(getName(sv));
+    sprintf(buffer, "x[%d]", i);
+    return strdup(buffer);
+}
+
+// Diagnostics to be written to the given CSV file, opened by diagBegin.
+// Returns NULL to indicate error
+Diagnostics* diagNew(const char* path, double tolerance, char separator) {
+    Diagnostics* d = (Diagnostics*)calloc(1, sizeof(Diagnostics));
+    if (!d) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    d->path = path;
+    d->tolerance = tolerance;
+    d->separator = separator;
+    return d;
+}
+
+// Open the stream of steps of the initialized instance c of the fmu.
+// Returns 0 to indicate error
+int diagBegin(Diagnostics* d, FMU* fmu, fmiComponent c, int nx, int nz) {
+    int i;
+    char separator = d->separator;
+    fmiStatus status = fmiOK;
+    fmiValueReference* vrx = (fmiValueReference*)calloc(nx + 1, sizeof(fmiValueReference));
+    d->nx = nx;
+    d->nz = nz;
+    d->names = (char**)calloc(nx + 1, sizeof(char*));
+    d->nominal = (double*)calloc(nx + 1, sizeof(double));
+    d->err = (double*)calloc(nx + 1, sizeof(double));
+    d->nDominated = (int*)calloc(nx + 1, sizeof(int));
+    d->nAbove = (int*)calloc(nx + 1, sizeof(int));
+    d->nCrossings = (int*)calloc(nz + 1, sizeof(int));
+    if (!vrx || !d->names || !d->nominal || !d->err || !d->nDominated || !d->nAbove || !d->nCrossings) {
+        if (vrx) free(vrx);
+        return fmuError("out of memory");
+    }
+    if (nx > 0) {
+        status = fmu->getStateValueReferences(c, vrx, nx);
+        if (status <= fmiWarning) status = fmu->getNominalContinuousStates(c, d->nominal, nx);
+    }
+    for (i=0; i<nx && status <= fmiWarning; i++) {
+        d->names[i] = stateName(fmu->modelDescription, vrx[i], i);
+        if (!d->names[i]) status = fmiFatal;
+    }
+    free(vrx);
+    if (status > fmiWarning) return fmuError("could not retrieve the states");
+    d->file = fopen(d->path, "w");
+    if (!d->file) {
+        printf("error: Could not open diagnostics file %s\n", d->path);
+        return 0;
+    }
+    fprintf(d->file, "step%ctime%ch%cerror%caccepted%cstate%climit%cindicator\n",
+            separator, separator, separator, separator, separator, separator, separator);
+    return 1; // success
+}
+
+// Record the step from time to time+dt just taken by solverStep, which left
+// the states x and its stages in work. prez and z are the event indicators
+// before and after the step. Returns 0 to indicate error
+int diagStep(Diagnostics* d, FMU* fmu, fmiComponent c, Method m, double time, double dt,
+        const double x[], double work[], const double prez[], const double z[], StepLimit limit) {
+    int i;
+    int dominant = -1;
+    int indicator = -1;
+    double e, error = 0;
+    if (!solverError(fmu, c, m, dt, d->nx, work, d->err)) return 0;
+    for (i=0; i<d->nx; i++) {
+        double scale = fabs(x[i]) > fabs(d->nominal[i]) ? fabs(x[i]) : fabs(d->nominal[i]);
+        e = d->err[i] / (scale > 0 ? scale : 1);
+        if (dominant < 0 || e > error || e != e) {
+            error = e; // NaN counts as error
+            dominant = i;
+        }
+    }
+    for (i=0; i<d->nz; i++) {
+        if (prez[i] * z[i] >= 0) continue;
+        d->nCrossings[i]++;
+        if (indicator < 0) indicator = i;
+    }
+    d->nSteps++;
+    if (limit == lim_timeEvent) d->nTimeEvents++;
+    if (error > d->maxError || error != error) d->maxError = error;
+    if (dominant >= 0) {
+        d->nDominated[dominant]++;
+        if (!(error <= d->tolerance)) {
+            d->nAbove[dominant]++;
+            d->nAboveSteps++;
+        }
+    }
+    fprintf(d->file, "%d", d->nSteps);
+    printReal(d->file, "%.16g", time, d->separator);
+    printReal(d->file, "%.6g", dt, d->separator);
+    printReal(d->file, "%.4g", error, d->separator);
+    fprintf(d->file, "%c%d%c%s%c%s%c", d->separator, error <= d->tolerance, d->separator,
+            dominant >= 0 ? d->names[dominant] : "", d->separator, limitNames[limit], d->separator);
+    if (indicator >= 0) fprintf(d->file, "z[%d]", indicator);
+    fprintf(d->file, "\n");
+    return 1; // success
+}
+
+// index of the largest count not yet ranked, or -1 if all are 0
+static int nextRanked(const int count[], const int tie[], int ranked[], int n) {
+    int i;
+    int best = -1;
+    for (i=0; i<n; i++) {
+        if (ranked[i] || (count[i] == 0 && (!tie || tie[i] == 0))) continue;
+        if (best < 0 || count[i] > count[best]
+                || (count[i] == count[best] && tie && tie[i] > tie[best])) best = i;
+    }
+    if (best >= 0) ranked[best] = 1;
+    return best;
+}
+
+// print the summary of the steps, ranking the states and event indicators
+// that limit the step size most
+void diagPrint(Diagnostics* d) {
+    int i, k;
+    char name[32];
+    int n = d->nx > d->nz ? d->nx : d->nz;
+    int* ranked = (int*)calloc(n + 1, sizeof(int));
+    printf("  diagnostics ...... %s\n", d->path);
+    printf("  tolerance ........ %g, exceeded by %d of %d steps\n",
+            d->tolerance, d->nAboveSteps, d->nSteps);
+    printf("  max step error ... %g\n", d->maxError);
+    printf("  time event steps . %d\n", d->nTimeEvents);
+    if (!ranked) return;
+    for (k=0; k<DIAG_RANKED && (i = nextRanked(d->nAbove, d->nDominated, ranked, d->nx)) >= 0; k++) {
+        if (k == 0) printf("  states ranked by the steps above the tolerance they dominated:\n");
+        printf("    %-16s %d above tolerance, %d dominated\n", d->names[i], d->nAbove[i], d->nDominated[i]);
+    }
+    memset(ranked, 0, (n + 1) * sizeof(int));
+    for (k=0; k<DIAG_RANKED && (i = nextRanked(d->nCrossings, NULL, ranked, d->nz)) >= 0; k++) {
+        if (k == 0) printf("  event indicators ranked by their state events:\n");
+        sprintf(name, "z[%d]", i);
+        printf("    %-16s %d state events\n", name, d->nCrossings[i]);
+    }
+    free(ranked);
+}
+
+// Close the stream, if open, and release d. Returns 0 to indicate error
+int diagClose(Diagnostics* d) {
+    int i;
+    int ok = 1;
+    if (d->file) ok = fclose(d->file) == 0;
+    if (d->names) {
+        for (i=0; i<d->nx; i++) if (d->names[i]) free(d->names[i]);
+        free(d->names);
+    }
+    if (d->nominal) free(d->nominal);
+    if (d->err) free(d->err);
+    if (d->nDominated) free(d->nDominated);
+    if (d->nAbove) free(d->nAbove);
+    if (d->nCrossings) free(d->nCrossings);
+    free(d);
+    if (!ok) return fmuError("could not write the diagnostics file");
+    return 1; // success
+}
@@ -0,0 +1,52 @@
+/* -------------------------------------------------------------------------
+ * diagnostics.h
+ * Per-step solver diagnostics of a simulation: the estimated error of each
+ * step, the state that dominates it, and the events that limit steps
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef diagnostics_h
+#define diagnostics_h
+
+#include <stdio.h>
+#include "main.h"
+#include "solver.h"
+
+#define DIAG_TOLERANCE 1e-4          // default tolerance of the error of a step
+#define DIAG_RANKED 5                // number of states and indicators ranked
+
+// what ended a step before the next point of the grid
+typedef enum {
+    lim_grid,                        // the step reached the grid
+    lim_timeEvent,                   // shortened to a time event
+    lim_end                          // shortened to the end time
+} StepLimit;
+
+typedef struct {
+    const char* path;
+    FILE* file;                      // the stream of steps, or NULL before diagBegin
+    char separator;
+    double tolerance;                // of the weighted error of a step
+    int nx;
+    int nz;
+    char** names;                    // of the states
+    double* nominal;                 // of the states
+    double* err;                     // estimated error of each state in the last step
+    int* nDominated;                 // steps whose error each state dominated
+    int* nAbove;                     // of these, the steps above the tolerance
+    int* nCrossings;                 // state events of each event indicator
+    int nSteps;
+    int nAboveSteps;                 // steps with an error above the tolerance
+    int nTimeEvents;                 // steps shortened to a time event
+    double maxError;
+} Diagnostics;
+
+Diagnostics* diagNew(const char* path, double tolerance, char separator);
+int diagBegin(Diagnostics* d, FMU* fmu, fmiComponent c, int nx, int nz);
+int diagStep(Diagnostics* d, FMU* fmu, fmiComponent c, Method m, double time, double dt,
+        const double x[], double work[], const double prez[], const double z[], StepLimit limit);
+void diagPrint(Diagnostics* d);
+int diagClose(Diagnostics* d);
+
+#endif // diagnostics_h
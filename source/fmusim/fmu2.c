@@ -0,0 +1,363 @@
+/* -------------------------------------------------------------------------
+ * fmu2.c
+ * Access to FMUs of FMI 2.0 Model Exchange through the FMI 1.0 functions
+ * of an FMU, so that the simulator runs them unchanged.
+ * An instance of the FMU is wrapped in an Instance2, which is the component
+ * passed to the functions below. They call the FMI 2.0 functions and map
+ * the modes of FMI 2.0 to the calls of FMI 1.0:
+ * - setTime before initialize only records the start time
+ * - initialize sets up the experiment, runs the initialization mode and
+ *   the event iteration, and enters continuous-time mode
+ * - eventUpdate enters event mode, iterates newDiscreteStates and enters
+ *   continuous-time mode again
+ * - Booleans are converted between fmiBoolean and fmi2Boolean
+ * If the FMU can get, set and serialize its FMUstate, this serves as the
+ * model state of snapshots, so that a snapshot restores an instance
+ * exactly, also into another instance. Directional derivatives are passed
+ * on if the FMU provides them.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fmu2.h"
+#include "fmuio.h"
+
+#ifdef _MSC_VER
+#define realpath(path, resolved) _fullpath(resolved, path, 0)
+#endif
+
+// an instance of an FMI 2.0 FMU
+typedef struct {
+    Fmu2* f;
+    fmi2Component c;
+    fmi2CallbackFunctions callbacks; // used by the instance until freed
+    int initialized;                 // 0 in instantiated mode
+    fmi2Real startTime;              // set before initialization
+    fmi2Boolean terminate;           // requested at the last completed step
+    fmi2Boolean* booleans;           // buffer for converting Booleans
+    size_t nBooleans;                // size of booleans
+    fmi2FMUstate state;              // state used for snapshots, or NULL
+} Instance2;
+
+#define F(c) (((Instance2*)(c))->f)
+#define C(c) (((Instance2*)(c))->c)
+
+static fmi2Status worst(fmi2Status a, fmi2Status b) {
+    return a > b ? a : b;
+}
+
+// Returns NULL to indicate error
+static fmi2Boolean* booleanBuffer(Instance2* i, size_t n) {
+    if (n > i->nBooleans) {
+        fmi2Boolean* b = (fmi2Boolean*)realloc(i->booleans, n * sizeof(fmi2Boolean));
+        if (!b) return NULL;
+        i->booleans = b;
+        i->nBooleans = n;
+    }
+    return i->booleans;
+}
+
+// -------------------------------------------------------------------------
+// Functions of FMI 1.0 implemented with those of FMI 2.0
+
+static const char* wrapGetModelTypesPlatform() {
+    return "standard32";
+}
+
+static void wrapFreeModelInstance(fmiComponent c) {
+    Instance2* i = (Instance2*)c;
+    if (i->state) i->f->freeFMUstate(i->c, &i->state);
+    i->f->freeInstance(i->c);
+    if (i->booleans) free(i->booleans);
+    free(i);
+}
+
+static fmiStatus wrapSetDebugLogging(fmiComponent c, fmiBoolean loggingOn) {
+    return (fmiStatus)F(c)->setDebugLogging(C(c), loggingOn, 0, NULL);
+}
+
+static fmiStatus wrapSetTime(fmiComponent c, fmiReal time) {
+    Instance2* i = (Instance2*)c;
+    if (!i->initialized) {
+        i->startTime = time;
+        return fmiOK;
+    }
+    return (fmiStatus)i->f->setTime(i->c, time);
+}
+
+static fmiStatus wrapSetContinuousStates(fmiComponent c, const fmiReal x[], size_t nx) {
+    return (fmiStatus)F(c)->setContinuousStates(C(c), x, nx);
+}
+
+static fmiStatus wrapCompletedIntegratorStep(fmiComponent c, fmiBoolean* callEventUpdate) {
+    Instance2* i = (Instance2*)c;
+    fmi2Boolean enterEventMode = fmi2False;
+    // fmi2False: the simulator may restore an earlier FMU state to roll back
+    fmi2Status status = i->f->completedIntegratorStep(i->c, fmi2False, &enterEventMode, &i->terminate);
+    *callEventUpdate = enterEventMode || i->terminate;
+    return (fmiStatus)status;
+}
+
+static fmiStatus wrapSetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiReal value[]) {
+    return (fmiStatus)F(c)->setReal(C(c), vr, nvr, value);
+}
+
+static fmiStatus wrapSetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiInteger value[]) {
+    return (fmiStatus)F(c)->setInteger(C(c), vr, nvr, value);
+}
+
+static fmiStatus wrapSetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiBoolean value[]) {
+    size_t k;
+    fmi2Boolean* b = booleanBuffer((Instance2*)c, nvr);
+    if (!b) return fmiError;
+    for (k=0; k<nvr; k++) b[k] = value[k] ? fmi2True : fmi2False;
+    return (fmiStatus)F(c)->setBoolean(C(c), vr, nvr, b);
+}
+
+static fmiStatus wrapSetString(fmiComponent c, const fmiValueReference vr[], size_t nvr, const fmiString value[]) {
+    return (fmiStatus)F(c)->setString(C(c), vr, nvr, value);
+}
+
+// Run the event iteration and enter continuous-time mode, then report the
+// result in the eventInfo of FMI 1.0.
+static fmiStatus updateDiscreteStates(Instance2* i, fmiEventInfo* eventInfo) {
+    fmi2Status status = fmi2OK;
+    fmi2EventInfo info;
+    fmi2Boolean valuesChanged = fmi2False;
+    memset(&info, 0, sizeof(fmi2EventInfo));
+    info.newDiscreteStatesNeeded = fmi2True;
+    while (info.newDiscreteStatesNeeded && !info.terminateSimulation && status <= fmi2Warning) {
+        status = worst(status, i->f->newDiscreteStates(i->c, &info));
+        valuesChanged = valuesChanged || info.valuesOfContinuousStatesChanged;
+    }
+    if (status > fmi2Warning) return (fmiStatus)status;
+    if (!info.terminateSimulation) status = worst(status, i->f->enterContinuousTimeMode(i->c));
+    eventInfo->iterationConverged = fmiTrue;
+    eventInfo->stateValueReferencesChanged = fmiFalse;
+    eventInfo->stateValuesChanged = valuesChanged ? fmiTrue : fmiFalse;
+    eventInfo->terminateSimulation = info.terminateSimulation || i->terminate ? fmiTrue : fmiFalse;
+    eventInfo->upcomingTimeEvent = info.nextEventTimeDefined ? fmiTrue : fmiFalse;
+    eventInfo->nextEventTime = info.nextEventTime;
+    return (fmiStatus)status;
+}
+
+static fmiStatus wrapInitialize(fmiComponent c, fmiBoolean toleranceControlled,
+        fmiReal relativeTolerance, fmiEventInfo* eventInfo) {
+    Instance2* i = (Instance2*)c;
+    fmi2Status status = i->f->setupExperiment(i->c, toleranceControlled, relativeTolerance,
+            i->startTime, fmi2False, 0);
+    if (status <= fmi2Warning) status = worst(status, i->f->enterInitializationMode(i->c));
+    if (status <= fmi2Warning) status = worst(status, i->f->exitInitializationMode(i->c));
+    if (status > fmi2Warning) return (fmiStatus)status;
+    i->initialized = 1;
+    return (fmiStatus)worst(status, (fmi2Status)updateDiscreteStates(i, eventInfo));
+}
+
+static fmiStatus wrapGetDerivatives(fmiComponent c, fmiReal derivatives[], size_t nx) {
+    return (fmiStatus)F(c)->getDerivatives(C(c), derivatives, nx);
+}
+
+static fmiStatus wrapGetEventIndicators(fmiComponent c, fmiReal eventIndicators[], size_t ni) {
+    return (fmiStatus)F(c)->getEventIndicators(C(c), eventIndicators, ni);
+}
+
+static fmiStatus wrapGetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiReal value[]) {
+    return (fmiStatus)F(c)->getReal(C(c), vr, nvr, value);
+}
+
+static fmiStatus wrapGetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiInteger value[]) {
+    return (fmiStatus)F(c)->getInteger(C(c), vr, nvr, value);
+}
+
+static fmiStatus wrapGetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiBoolean value[]) {
+    size_t k;
+    fmi2Status status;
+    fmi2Boolean* b = booleanBuffer((Instance2*)c, nvr);
+    if (!b) return fmiError;
+    status = F(c)->getBoolean(C(c), vr, nvr, b);
+    for (k=0; k<nvr; k++) value[k] = b[k] ? fmiTrue : fmiFalse;
+    return (fmiStatus)status;
+}
+
+static fmiStatus wrapGetString(fmiComponent c, const fmiValueReference vr[], size_t nvr, fmiString value[]) {
+    return (fmiStatus)F(c)->getString(C(c), vr, nvr, value);
+}
+
+static fmiStatus wrapEventUpdate(fmiComponent c, fmiBoolean intermediateResults, fmiEventInfo* eventInfo) {
+    Instance2* i = (Instance2*)c;
+    fmi2Status status = i->f->enterEventMode(i->c);
+    if (status > fmi2Warning) return (fmiStatus)status;
+    return (fmiStatus)worst(status, (fmi2Status)updateDiscreteStates(i, eventInfo));
+}
+
+static fmiStatus wrapGetContinuousStates(fmiComponent c, fmiReal states[], size_t nx) {
+    return (fmiStatus)F(c)->getContinuousStates(C(c), states, nx);
+}
+
+static fmiStatus wrapGetNominalContinuousStates(fmiComponent c, fmiReal x_nominal[], size_t nx) {
+    return (fmiStatus)F(c)->getNominalsOfContinuousStates(C(c), x_nominal, nx);
+}
+
+static fmiStatus wrapGetStateValueReferences(fmiComponent c, fmiValueReference vrx[], size_t nx) {
+    memcpy(vrx, F(c)->stateVrs, nx * sizeof(fmiValueReference));
+    return fmiOK;
+}
+
+static fmiStatus wrapTerminate(fmiComponent c) {
+    return (fmiStatus)F(c)->terminate(C(c));
+}
+
+static fmiStatus wrapGetDirectionalDerivative(fmiComponent c, const fmiValueReference vUnknown[],
+        size_t nUnknown, const fmiValueReference vKnown[], size_t nKnown,
+        const fmiReal dvKnown[], fmiReal dvUnknown[]) {
+    return (fmiStatus)F(c)->getDirectionalDerivative(C(c), vUnknown, nUnknown, vKnown, nKnown,
+            dvKnown, dvUnknown);
+}
+
+// -------------------------------------------------------------------------
+// Model state of snapshots, the serialized FMUstate
+
+// Returns 0 to indicate error
+static size_t wrapGetModelStateSize(fmiComponent c) {
+    Instance2* i = (Instance2*)c;
+    size_t size = 0;
+    if (i->f->getFMUstate(i->c, &i->state) > fmi2Warning
+            || i->f->serializedFMUstateSize(i->c, i->state, &size) > fmi2Warning) return 0;
+    return size;
+}
+
+static fmiStatus wrapGetModelState(fmiComponent c, void* state, size_t size) {
+    Instance2* i = (Instance2*)c;
+    fmi2Status status = i->f->getFMUstate(i->c, &i->state);
+    if (status > fmi2Warning) return (fmiStatus)status;
+    return (fmiStatus)worst(status, i->f->serializeFMUstate(i->c, i->state, (fmi2Byte*)state, size));
+}
+
+static fmiStatus wrapSetModelState(fmiComponent c, const void* state, size_t size) {
+    Instance2* i = (Instance2*)c;
+    fmi2Status status;
+    if (i->state) i->f->freeFMUstate(i->c, &i->state);
+    i->state = NULL;
+    status = i->f->deSerializeFMUstate(i->c, (const fmi2Byte*)state, size, &i->state);
+    if (status > fmi2Warning) return (fmiStatus)status;
+    return (fmiStatus)worst(status, i->f->setFMUstate(i->c, i->state));
+}
+
+// -------------------------------------------------------------------------
+// Loading
+
+// Collect the value references of the continuous states: the variables
+// whose derivatives are listed in the model structure, in this order.
+// Returns 0 to indicate error
+static int initStateVrs(FMU* fmu) {
+    int k;
+    ValueStatus vs;
+    ModelDescription* md = fmu->modelDescription;
+    Element** derivatives = getUnknowns(md, elm_Derivatives);
+    int nx = getNumberOfStates(md);
+    fmu->fmi2->stateVrs = (fmiValueReference*)calloc(nx + 1, sizeof(fmiValueReference));
+    if (!fmu->fmi2->stateVrs) return fmuError("out of memory");
+    for (k=0; k<nx; k++) {
+        ScalarVariable* der = getVariableByIndex(md, getInt(derivatives[k], att_index, &vs));
+        ScalarVariable* x = der ? getVariableByIndex(md, getInt(der->typeSpec, att_derivative, &vs)) : NULL;
+        if (!x) {
+            printf("error: Derivative %d of the model structure is not the derivative of a variable\n", k+1);
+            return 0;
+        }
+        fmu->fmi2->stateVrs[k] = getValueReference(x);
+    }
+    return 1; // success
+}
+
+// Returns 0 to indicate error
+static int initResourceLocation(FMU* fmu) {
+    char* p;
+    char* path = realpath(fmu->tmpPath, NULL);
+    if (!path) return fmuError("could not resolve the directory of the FMU");
+    fmu->fmi2->resourceLocation = (char*)calloc(strlen(path) + 32, sizeof(char));
+    if (!fmu->fmi2->resourceLocation) return fmuError("out of memory");
+    sprintf(fmu->fmi2->resourceLocation, "file://%s%s/resources", path[0] == '/' ? "" : "/", path);
+    for (p = fmu->fmi2->resourceLocation; *p; p++) if (*p == '\\') *p = '/';
+    free(path);
+    return 1; // success
+}
+
+// Set the FMI 1.0 functions of fmu, whose FMI 2.0 functions are bound.
+// Returns 0 to indicate error
+int fmu2Init(FMU* fmu) {
+    Fmu2* f = fmu->fmi2;
+    ModelDescription* md = fmu->modelDescription;
+    ValueStatus vs;
+    int canGetAndSet = getBoolean(md->modelExchange, att_canGetAndSetFMUstate, &vs);
+    int canSerialize = getBoolean(md->modelExchange, att_canSerializeFMUstate, &vs);
+    int providesDerivatives = getBoolean(md->modelExchange, att_providesDirectionalDerivative, &vs);
+    if (!initStateVrs(fmu) || !initResourceLocation(fmu)) return 0;
+    fmu->getModelTypesPlatform   = wrapGetModelTypesPlatform;
+    fmu->getVersion              = f->getVersion;
+    fmu->instantiateModel        = NULL; // see fmu2Instantiate
+    fmu->freeModelInstance       = wrapFreeModelInstance;
+    fmu->setDebugLogging         = wrapSetDebugLogging;
+    fmu->setTime                 = wrapSetTime;
+    fmu->setContinuousStates     = wrapSetContinuousStates;
+    fmu->completedIntegratorStep = wrapCompletedIntegratorStep;
+    fmu->setReal                 = wrapSetReal;
+    fmu->setInteger              = wrapSetInteger;
+    fmu->setBoolean              = wrapSetBoolean;
+    fmu->setString               = wrapSetString;
+    fmu->initialize              = wrapInitialize;
+    fmu->getDerivatives          = wrapGetDerivatives;
+    fmu->getEventIndicators      = wrapGetEventIndicators;
+    fmu->getReal                 = wrapGetReal;
+    fmu->getInteger              = wrapGetInteger;
+    fmu->getBoolean              = wrapGetBoolean;
+    fmu->getString               = wrapGetString;
+    fmu->eventUpdate             = wrapEventUpdate;
+    fmu->getContinuousStates     = wrapGetContinuousStates;
+    fmu->getNominalContinuousStates = wrapGetNominalContinuousStates;
+    fmu->getStateValueReferences = wrapGetStateValueReferences;
+    fmu->terminate               = wrapTerminate;
+    fmu->getModelStateSize       = NULL;
+    fmu->getModelState           = NULL;
+    fmu->setModelState           = NULL;
+    fmu->getDirectionalDerivative = NULL;
+    if (canGetAndSet && canSerialize && f->getFMUstate && f->setFMUstate && f->freeFMUstate
+            && f->serializedFMUstateSize && f->serializeFMUstate && f->deSerializeFMUstate) {
+        fmu->getModelStateSize   = wrapGetModelStateSize;
+        fmu->getModelState       = wrapGetModelState;
+        fmu->setModelState       = wrapSetModelState;
+    }
+    if (providesDerivatives && f->getDirectionalDerivative)
+        fmu->getDirectionalDerivative = wrapGetDirectionalDerivative;
+    return 1; // success
+}
+
+// Instantiate the FMI 2.0 fmu, in place of fmu->instantiateModel.
+// Returns NULL to indicate error
+fmiComponent fmu2Instantiate(FMU* fmu, fmiString instanceName,
+        fmiCallbackFunctions functions, fmiBoolean loggingOn) {
+    Instance2* i = (Instance2*)calloc(1, sizeof(Instance2));
+    if (!i) return NULL;
+    i->f = fmu->fmi2;
+    i->callbacks.logger = (fmi2CallbackLogger)functions.logger;
+    i->callbacks.allocateMemory = functions.allocateMemory;
+    i->callbacks.freeMemory = functions.freeMemory;
+    i->c = i->f->instantiate(instanceName, fmi2ModelExchange,
+            getString(fmu->modelDescription, att_guid), i->f->resourceLocation,
+            &i->callbacks, fmi2False, loggingOn);
+    if (!i->c) {
+        free(i);
+        return NULL;
+    }
+    return i;
+}
+
+void fmu2Free(FMU* fmu) {
+    if (!fmu->fmi2) return;
+    if (fmu->fmi2->stateVrs) free(fmu->fmi2->stateVrs);
+    if (fmu->fmi2->resourceLocation) free(fmu->fmi2->resourceLocation);
+    free(fmu->fmi2);
+    fmu->fmi2 = NULL;
+}
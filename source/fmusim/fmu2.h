@@ -0,0 +1,144 @@
+/* -------------------------------------------------------------------------
+ * fmu2.h
+ * Types and functions of FMI 2.0 Model Exchange, and access to FMUs of
+ * FMI 2.0 through the FMI 1.0 functions of an FMU
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef fmu2_h
+#define fmu2_h
+
+#include <stddef.h>
+#include "main.h"
+
+// basic types of FMI 2.0
+typedef void*           fmi2Component;
+typedef void*           fmi2ComponentEnvironment;
+typedef void*           fmi2FMUstate;
+typedef unsigned int    fmi2ValueReference;
+typedef double          fmi2Real;
+typedef int             fmi2Integer;
+typedef int             fmi2Boolean;
+typedef char            fmi2Char;
+typedef const fmi2Char* fmi2String;
+typedef char            fmi2Byte;
+
+#define fmi2True  1
+#define fmi2False 0
+
+typedef enum {
+    fmi2OK, fmi2Warning, fmi2Discard, fmi2Error, fmi2Fatal, fmi2Pending
+} fmi2Status;
+
+typedef enum {
+    fmi2ModelExchange, fmi2CoSimulation
+} fmi2Type;
+
+typedef void  (*fmi2CallbackLogger)        (fmi2ComponentEnvironment, fmi2String, fmi2Status,
+                                            fmi2String, fmi2String, ...);
+typedef void* (*fmi2CallbackAllocateMemory)(size_t, size_t);
+typedef void  (*fmi2CallbackFreeMemory)    (void*);
+typedef void  (*fmi2StepFinished)          (fmi2ComponentEnvironment, fmi2Status);
+
+typedef struct {
+    fmi2CallbackLogger         logger;
+    fmi2CallbackAllocateMemory allocateMemory;
+    fmi2CallbackFreeMemory     freeMemory;
+    fmi2StepFinished           stepFinished;
+    fmi2ComponentEnvironment   componentEnvironment;
+} fmi2CallbackFunctions;
+
+typedef struct {
+    fmi2Boolean newDiscreteStatesNeeded;
+    fmi2Boolean terminateSimulation;
+    fmi2Boolean nominalsOfContinuousStatesChanged;
+    fmi2Boolean valuesOfContinuousStatesChanged;
+    fmi2Boolean nextEventTimeDefined;
+    fmi2Real    nextEventTime;
+} fmi2EventInfo;
+
+typedef const char*   (*f2GetTypesPlatform)();
+typedef const char*   (*f2GetVersion)();
+typedef fmi2Status    (*f2SetDebugLogging)(fmi2Component c, fmi2Boolean loggingOn,
+                                           size_t nCategories, const fmi2String categories[]);
+typedef fmi2Component (*f2Instantiate)(fmi2String instanceName, fmi2Type fmuType, fmi2String fmuGUID,
+                                       fmi2String fmuResourceLocation, const fmi2CallbackFunctions* functions,
+                                       fmi2Boolean visible, fmi2Boolean loggingOn);
+typedef void          (*f2FreeInstance)(fmi2Component c);
+typedef fmi2Status    (*f2SetupExperiment)(fmi2Component c, fmi2Boolean toleranceDefined, fmi2Real tolerance,
+                                           fmi2Real startTime, fmi2Boolean stopTimeDefined, fmi2Real stopTime);
+typedef fmi2Status    (*f2Component)(fmi2Component c); // enter and exit modes, terminate, reset
+typedef fmi2Status    (*f2GetReal)   (fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Real    value[]);
+typedef fmi2Status    (*f2GetInteger)(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Integer value[]);
+typedef fmi2Status    (*f2GetBoolean)(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2Boolean value[]);
+typedef fmi2Status    (*f2GetString) (fmi2Component c, const fmi2ValueReference vr[], size_t nvr, fmi2String  value[]);
+typedef fmi2Status    (*f2SetReal)   (fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Real    value[]);
+typedef fmi2Status    (*f2SetInteger)(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Integer value[]);
+typedef fmi2Status    (*f2SetBoolean)(fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2Boolean value[]);
+typedef fmi2Status    (*f2SetString) (fmi2Component c, const fmi2ValueReference vr[], size_t nvr, const fmi2String  value[]);
+typedef fmi2Status    (*f2GetFMUstate)(fmi2Component c, fmi2FMUstate* state);
+typedef fmi2Status    (*f2SetFMUstate)(fmi2Component c, fmi2FMUstate state);
+typedef fmi2Status    (*f2FreeFMUstate)(fmi2Component c, fmi2FMUstate* state);
+typedef fmi2Status    (*f2SerializedFMUstateSize)(fmi2Component c, fmi2FMUstate state, size_t* size);
+typedef fmi2Status    (*f2SerializeFMUstate)(fmi2Component c, fmi2FMUstate state, fmi2Byte bytes[], size_t size);
+typedef fmi2Status    (*f2DeSerializeFMUstate)(fmi2Component c, const fmi2Byte bytes[], size_t size,
+                                               fmi2FMUstate* state);
+typedef fmi2Status    (*f2GetDirectionalDerivative)(fmi2Component c,
+                                                    const fmi2ValueReference vUnknown[], size_t nUnknown,
+                                                    const fmi2ValueReference vKnown[], size_t nKnown,
+                                                    const fmi2Real dvKnown[], fmi2Real dvUnknown[]);
+typedef fmi2Status    (*f2NewDiscreteStates)(fmi2Component c, fmi2EventInfo* eventInfo);
+typedef fmi2Status    (*f2CompletedIntegratorStep)(fmi2Component c, fmi2Boolean noSetFMUStatePriorToCurrentPoint,
+                                                   fmi2Boolean* enterEventMode, fmi2Boolean* terminateSimulation);
+typedef fmi2Status    (*f2SetTime)(fmi2Component c, fmi2Real time);
+typedef fmi2Status    (*f2SetContinuousStates)(fmi2Component c, const fmi2Real x[], size_t nx);
+typedef fmi2Status    (*f2GetReals)(fmi2Component c, fmi2Real values[], size_t n); // derivatives etc.
+
+// the functions of an FMI 2.0 Model Exchange FMU, and what the simulator
+// needs to call them through the FMI 1.0 functions of its FMU
+typedef struct Fmu2 {
+    char* resourceLocation;          // URI of the resources directory
+    fmiValueReference* stateVrs;     // value references of the continuous states
+    f2GetTypesPlatform getTypesPlatform;
+    f2GetVersion getVersion;
+    f2SetDebugLogging setDebugLogging;
+    f2Instantiate instantiate;
+    f2FreeInstance freeInstance;
+    f2SetupExperiment setupExperiment;
+    f2Component enterInitializationMode;
+    f2Component exitInitializationMode;
+    f2Component terminate;
+    f2GetReal getReal;
+    f2GetInteger getInteger;
+    f2GetBoolean getBoolean;
+    f2GetString getString;
+    f2SetReal setReal;
+    f2SetInteger setInteger;
+    f2SetBoolean setBoolean;
+    f2SetString setString;
+    f2GetFMUstate getFMUstate;       // optional, NULL unless canGetAndSetFMUstate
+    f2SetFMUstate setFMUstate;
+    f2FreeFMUstate freeFMUstate;
+    f2SerializedFMUstateSize serializedFMUstateSize; // optional, NULL unless canSerializeFMUstate
+    f2SerializeFMUstate serializeFMUstate;
+    f2DeSerializeFMUstate deSerializeFMUstate;
+    f2GetDirectionalDerivative getDirectionalDerivative; // optional
+    f2Component enterEventMode;
+    f2NewDiscreteStates newDiscreteStates;
+    f2Component enterContinuousTimeMode;
+    f2CompletedIntegratorStep completedIntegratorStep;
+    f2SetTime setTime;
+    f2SetContinuousStates setContinuousStates;
+    f2GetReals getDerivatives;
+    f2GetReals getEventIndicators;
+    f2GetReals getContinuousStates;
+    f2GetReals getNominalsOfContinuousStates;
+} Fmu2;
+
+int fmu2Init(FMU* fmu);
+fmiComponent fmu2Instantiate(FMU* fmu, fmiString instanceName,
+        fmiCallbackFunctions functions, fmiBoolean loggingOn);
+void fmu2Free(FMU* fmu);
+
+#endif // fmu2_h
@@ -1,25 +1,356 @@
 #include "fmuinit.h"
 
 #include "xml_parser.h"
+#include "fmuzip.h"
+#include "fmuthread.h"
+#include "fmu2.h"
+#include "fmuio.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #ifdef _MSC_VER
 #include <windows.h>
 #else
 #include <dlfcn.h>
+#include <dirent.h>
 #endif
 
+#define XML_FILE  "modelDescription.xml"
+#if WINDOWS
+#define DLL_DIR   "binaries\\win32\\"
+#ifdef _WIN64
+#define DLL_DIR2  "binaries\\win64\\"
+#else
+#define DLL_DIR2  DLL_DIR
+#endif
+#define DLL_SUFFIX ".dll"
+#else
+#define DLL_DIR   "binaries/linux32/"
+#ifdef __LP64__
+#define DLL_DIR2  "binaries/linux64/"
+#else
+#define DLL_DIR2  DLL_DIR
+#endif
+#define DLL_SUFFIX ".so"
+#include <unistd.h>
+#endif
+// DLL_DIR2 is the directory of the dll of FMI 2.0 for this platform
 #define BUFSIZE 4096
 
-static void* getAdr(FMU *fmu, const char* functionName){
-    char name[BUFSIZE];
-    void* fp;
-    sprintf(name, "%s_%s", getModelIdentifier(fmu->modelDescription), functionName);
+static int bindFunctions(FMU *fmu);
+static int bindFunctions2(FMU *fmu);
+
+#ifdef _MSC_VER
+// fmuFileName is an absolute path, e.g. "C:\test\a.fmu"
+// or relative to the current dir, e.g. "..\test\a.fmu"
+static char* getFmuPath(const char* fmuFileName){
+    OFSTRUCT fileInfo;
+    if (HFILE_ERROR==OpenFile(fmuFileName, &fileInfo, OF_EXIST)) {
+        printf ("error: Could not open FMU '%s': %s\n", fmuFileName, strerror(GetLastError()));
+        return NULL;
+    }
+    //printf ("full path to FMU: '%s'\n", fileInfo.szPathName); 
+    return strdup(fileInfo.szPathName);
+}
+static char* getTmpPath() {
+    static int nTmpPaths = 0; // each loaded fmu gets its own directory
+    char tmpPath[BUFSIZE];
+    if(! GetTempPath(BUFSIZE, tmpPath)) {
+        printf ("error: Could not find temporary disk space: %d\n", strerror(GetLastError()));
+        return NULL;
+    }
+    if (nTmpPaths++ == 0) strcat(tmpPath, "fmu\\");
+    else sprintf(tmpPath + strlen(tmpPath), "fmu%d\\", nTmpPaths);
+    return strdup(tmpPath);
+}
+#else
+// fmuFileName is an absolute path, e.g. "C:\test\a.fmu"
+// or relative to the current dir, e.g. "..\test\a.fmu"
+static char* getFmuPath(const char* fmuFileName){
+  /* Not sure why this is useful.  Just returning the filename. */
+  return strdup(fmuFileName);
+}
+static char* getTmpPath() {
+  char *tmp = mkdtemp(strdup("fmuTmpXXXXXX"));
+  if (tmp==NULL) {
+    fprintf(stderr, "Couldn't create temporary directory\n");
+    exit(1);
+  }
+  /* return strdup(tmp); */
+  return strcat(tmp, "/");
+}
+#endif
+
+// Remove the directory of the unzipped files of the fmu, if any
+static void removeTmpPath(FMU* fmu) {
+#ifdef _MSC_VER
+  /* Remove temp file directory? */
+#else
+  char* cmd;
+  if (fmu->tmpPath) {
+    cmd = calloc(sizeof(char), strlen(fmu->tmpPath)+8);
+    sprintf(cmd, "rm -rf %s", fmu->tmpPath);
+    printf("Removing %s\n", fmu->tmpPath);
+    system(cmd);
+    free(cmd);
+  }
+#endif
+  free(fmu->tmpPath);
+  fmu->tmpPath = NULL;
+}
+
+// the unzipping and loading of the dll, run while the model description is parsed
+typedef struct {
+    const char* fmuPath;
+    const char* tmpPath;
+    int ok;                          // 0 if unzipping failed
+    char* dllPath;                   // the dll loaded, or NULL
+    HANDLE dllHandle;
+} LoadTask;
+
+// Returns the path of the only dll in directory dllDir, or NULL if there is
+// none or more than one
+static char* findDll(const char* tmpPath, const char* dllDir) {
+    char* path = NULL;
+    char dir[BUFSIZE];
+    int n = 0;
+#ifdef _MSC_VER
+    WIN32_FIND_DATA data;
+    HANDLE h;
+    sprintf(dir, "%s%s*%s", tmpPath, dllDir, DLL_SUFFIX);
+    h = FindFirstFile(dir, &data);
+    if (h == INVALID_HANDLE_VALUE) return NULL;
+    do {
+        if (n++ == 0) {
+            path = calloc(sizeof(char), strlen(tmpPath) + strlen(dllDir) + strlen(data.cFileName) + 1);
+            if (path) sprintf(path, "%s%s%s", tmpPath, dllDir, data.cFileName);
+        }
+    } while (FindNextFile(h, &data));
+    FindClose(h);
+#else
+    struct dirent* entry;
+    DIR* d;
+    sprintf(dir, "%s%s", tmpPath, dllDir);
+    if (!(d = opendir(dir))) return NULL;
+    while ((entry = readdir(d))) {
+        int k = strlen(entry->d_name) - strlen(DLL_SUFFIX);
+        if (k <= 0 || strcmp(entry->d_name + k, DLL_SUFFIX)) continue;
+        if (n++ == 0) {
+            path = calloc(sizeof(char), strlen(dir) + strlen(entry->d_name) + 1);
+            if (path) sprintf(path, "%s%s", dir, entry->d_name);
+        }
+    }
+    closedir(d);
+#endif
+    if (n == 1) return path;
+    if (path) free(path);
+    return NULL;
+}
+
+static HANDLE openDll(const char* dllPath) {
+#ifdef _MSC_VER
+    return LoadLibrary(dllPath);
+#else
+    printf("dllPath = %s\n", dllPath);
+    return dlopen(dllPath, RTLD_LAZY);
+#endif
+}
+
+static void closeDll(HANDLE h) {
+#ifdef _MSC_VER
+    FreeLibrary(h);
+#else
+    dlclose(h);
+#endif
+}
+
+static void* dllSymbol(HANDLE h, const char* name) {
 #ifdef _MSC_VER
-    fp = GetProcAddress(fmu->dllHandle, name);
+    return GetProcAddress(h, name);
 #else
-    fp = dlsym(fmu->dllHandle, name);
+    return dlsym(h, name);
 #endif
+}
+
+// unzip all but the model description and load the dll, if there is only one
+// in the directory of FMI 1.0 or else of FMI 2.0
+static void loadBinaries(void* arg) {
+    LoadTask* t = (LoadTask*)arg;
+    t->ok = fmuUnzipFiles(t->fmuPath, t->tmpPath, "-x!" XML_FILE);
+    if (!t->ok) return;
+    t->dllPath = findDll(t->tmpPath, DLL_DIR);
+    if (!t->dllPath) t->dllPath = findDll(t->tmpPath, DLL_DIR2);
+    if (t->dllPath) t->dllHandle = openDll(t->dllPath);
+}
+
+// Copies the value of the attribute name in the start tag to value.
+// Returns 0 if the tag has no such attribute
+static int findAttribute(const char* tag, const char* name, char* value, int size) {
+    const char* p = tag;
+    const char* end;
+    int n = strlen(name);
+    while ((p = strstr(p, name))) {
+        char quote;
+        const char* q = p + n;
+        int isName = p > tag && strchr(" \t\r\n", p[-1]);
+        p = q;
+        if (!isName) continue;
+        while (*q && strchr(" \t\r\n", *q)) q++;
+        if (*q++ != '=') continue;
+        while (*q && strchr(" \t\r\n", *q)) q++;
+        quote = *q++;
+        if (quote != '"' && quote != '\'') return 0;
+        if (!(end = strchr(q, quote)) || end - q >= size) return 0;
+        memcpy(value, q, end - q);
+        value[end - q] = 0;
+        return 1;
+    }
+    return 0;
+}
+
+// Reads the modelIdentifier and guid of an FMI 1.0 model description from the
+// start tag of its root element, without parsing the file.
+// Returns 0 if they are not found
+static int readRootAttributes(const char* xmlPath, char* modelId, char* guid) {
+    char text[BUFSIZE];
+    char version[8];
+    char* tag;
+    char* end;
+    int n;
+    FILE* file = fopen(xmlPath, "rb");
+    if (!file) return 0;
+    n = fread(text, sizeof(char), BUFSIZE - 1, file);
+    fclose(file);
+    text[n] = 0;
+    if (!(tag = strstr(text, "<fmiModelDescription")) || !(end = strchr(tag, '>'))) return 0;
+    *end = 0;
+    return findAttribute(tag, "fmiVersion", version, sizeof(version)) && version[0] == '1'
+        && findAttribute(tag, "modelIdentifier", modelId, BUFSIZE)
+        && findAttribute(tag, "guid", guid, BUFSIZE);
+}
+
+typedef const fmiModelVariables* (*fGetModelVariables)();
+
+// The model description built from the table of variables of the loaded dll,
+// see fmiModelVariables.h. Returns NULL if the dll is not the one of the
+// model, has no table or a table of another model or GUID
+static ModelDescription* tableModelDescription(LoadTask* task, const char* modelId, const char* guid) {
+    char name[BUFSIZE + 32];
+    char* dllPath;
+    const fmiModelVariables* table = NULL;
+    fGetModelVariables getModelVariables;
+    if (!task->dllHandle) return NULL;
+    dllPath = calloc(sizeof(char), strlen(task->tmpPath) + strlen(DLL_DIR) + strlen(modelId) + strlen(DLL_SUFFIX) + 1);
+    if (!dllPath) return NULL;
+    sprintf(dllPath, "%s%s%s%s", task->tmpPath, DLL_DIR, modelId, DLL_SUFFIX);
+    sprintf(name, "%s_fmiGetModelVariables", modelId);
+    if (!strcmp(task->dllPath, dllPath)
+            && (getModelVariables = (fGetModelVariables)dllSymbol(task->dllHandle, name)))
+        table = getModelVariables();
+    free(dllPath);
+    if (!table || strcmp(table->guid, guid) || strcmp(table->modelIdentifier, modelId)) return NULL;
+    return newModelDescription(table);
+}
+
+// Unzip the given FMU to a temporary directory, parse its model description
+// and load its dll. fmuFree releases the fmu and removes the directory.
+// The model description is unzipped first and parsed while the other files
+// are unzipped and the dll is loaded on a second thread. The dll of an
+// FMI 1.0 model built with fmuTemplate.c may export the table of variables:
+// if its GUID is the one of the model description, the table replaces the
+// parsed model description. As the dll is loaded only after the parse has
+// started, the parse is not skipped, so that it still overlaps the loading
+// for all FMUs without table.
+// Returns 0 to indicate error
+int fmuLoad(const char* fmuFileName, FMU *fmu) {
+    char* fmuPath;
+    char* xmlPath;
+    char* dllPath;
+    const char* dllDir;
+    char modelId[BUFSIZE];
+    char guid[BUFSIZE];
+    int ok;
+    ModelDescription* table;
+    Thread thread;
+    LoadTask task;
+
+    // get absolute path to FMU, NULL if not found
+    fmuPath = getFmuPath(fmuFileName);
+    if (!fmuPath) return 0;
+
+    // unzip the model description to the tmpPath directory
+    fmu->tmpPath = getTmpPath();
+    ok = fmu->tmpPath && fmuUnzipFiles(fmuPath, fmu->tmpPath, XML_FILE);
+    if (!ok) {
+        removeTmpPath(fmu);
+        free(fmuPath);
+        return 0;
+    }
+
+    // unzip the other files and load the dll, on a thread if possible
+    memset(&task, 0, sizeof(LoadTask));
+    task.fmuPath = fmuPath;
+    task.tmpPath = fmu->tmpPath;
+    ok = threadCreate(&thread, loadBinaries, &task);
+
+    // parse tmpPath\modelDescription.xml, and use the table of variables of
+    // the dll of an FMI 1.0 model instead, if it provides one
+    xmlPath = calloc(sizeof(char), strlen(fmu->tmpPath) + strlen(XML_FILE) + 1);
+    sprintf(xmlPath, "%s%s", fmu->tmpPath, XML_FILE);
+    fmu->modelDescription = parse(xmlPath);
+    if (ok) threadJoin(thread);
+    else loadBinaries(&task);
+    if (readRootAttributes(xmlPath, modelId, guid)
+            && (table = tableModelDescription(&task, modelId, guid))) {
+        if (fmu->modelDescription) freeElement(fmu->modelDescription);
+        fmu->modelDescription = table;
+    }
+    free(xmlPath);
+    free(fmuPath);
+    if (!fmu->modelDescription || !task.ok) {
+        if (task.dllHandle) closeDll(task.dllHandle);
+        if (task.dllPath) free(task.dllPath);
+        removeTmpPath(fmu);
+        return 0;
+    }
+
+    // use the dll loaded by the thread if it is the one of the model
+    dllDir = getFmiVersion(fmu->modelDescription) == 2 ? DLL_DIR2 : DLL_DIR;
+    dllPath = calloc(sizeof(char), strlen(fmu->tmpPath) + strlen(dllDir) 
+            + strlen( getModelIdentifier(fmu->modelDescription)) +  strlen(DLL_SUFFIX) + 1);
+    sprintf(dllPath,"%s%s%s%s", fmu->tmpPath, dllDir, getModelIdentifier(fmu->modelDescription), DLL_SUFFIX);
+    if (task.dllHandle && !strcmp(task.dllPath, dllPath)) {
+        fmu->dllHandle = task.dllHandle;
+        ok = bindFunctions(fmu);
+    }
+    else {
+        if (task.dllHandle) closeDll(task.dllHandle);
+        ok = fmuLoadDll(dllPath, fmu);
+    }
+    if (task.dllPath) free(task.dllPath);
+    free(dllPath);
+    if (!ok) removeTmpPath(fmu);
+    return ok;
+}
+
+// the name of a function in the dll. The functions of FMI 2.0 have no prefix.
+static void getFunctionName(FMU *fmu, const char* functionName, char* name) {
+    if (fmu->fmi2) strcpy(name, functionName);
+    else sprintf(name, "%s_%s", getModelIdentifier(fmu->modelDescription), functionName);
+}
+
+static void* getOptionalAdr(FMU *fmu, const char* functionName){
+    char name[BUFSIZE];
+    getFunctionName(fmu, functionName, name);
+    return dllSymbol(fmu->dllHandle, name);
+}
+
+static void* getAdr(FMU *fmu, const char* functionName){
+    char name[BUFSIZE];
+    void* fp;
+    getFunctionName(fmu, functionName, name);
+    fp = dllSymbol(fmu->dllHandle, name);
     if (!fp) {
         printf ("error: Function %s not found in dll\n", name);        
     }
@@ -28,17 +359,18 @@ static void* getAdr(FMU *fmu, const char* functionName){
 
 // Load the given dll and set function pointers in fmu
 int fmuLoadDll(const char* dllPath, FMU *fmu) {
-#ifdef _MSC_VER
-    HANDLE h = LoadLibrary(dllPath);
-#else
-    printf("dllPath = %s\n", dllPath);
-    HANDLE h = dlopen(dllPath, RTLD_LAZY);
-#endif
+    HANDLE h = openDll(dllPath);
     if (!h) {
         printf("error: Could not load %s\n", dllPath);
         return 0; // failure
     }
     fmu->dllHandle = h;
+    return bindFunctions(fmu);
+}
+
+// set the function pointers in fmu from its loaded dll
+static int bindFunctions(FMU *fmu) {
+    if (getFmiVersion(fmu->modelDescription) == 2) return bindFunctions2(fmu);
     fmu->getModelTypesPlatform   = (fGetModelTypesPlatform) getAdr(fmu, "fmiGetModelTypesPlatform");
     fmu->getVersion              = (fGetVersion)         getAdr(fmu, "fmiGetVersion");
     fmu->instantiateModel        = (fInstantiateModel)   getAdr(fmu, "fmiInstantiateModel");
@@ -63,15 +395,64 @@ int fmuLoadDll(const char* dllPath, FMU *fmu) {
     fmu->getNominalContinuousStates = (fGetNominalContinuousStates)getAdr(fmu, "fmiGetNominalContinuousStates");
     fmu->getStateValueReferences = (fGetStateValueReferences)getAdr(fmu, "fmiGetStateValueReferences");
     fmu->terminate               = (fTerminate)          getAdr(fmu, "fmiTerminate");
+    fmu->getModelStateSize       = (fGetModelStateSize)  getOptionalAdr(fmu, "fmiGetModelStateSize");
+    fmu->getModelState           = (fGetModelState)      getOptionalAdr(fmu, "fmiGetModelState");
+    fmu->setModelState           = (fSetModelState)      getOptionalAdr(fmu, "fmiSetModelState");
+    fmu->getDirectionalDerivative = NULL;
+    fmu->fmi2 = NULL;
     return 1; // success  
 }
 
+// set the functions of FMI 2.0 from the loaded dll, and the functions of
+// fmu that call them. Returns 0 to indicate error
+static int bindFunctions2(FMU *fmu) {
+    Fmu2* f = (Fmu2*)calloc(1, sizeof(Fmu2));
+    if (!f) return fmuError("out of memory");
+    fmu->fmi2 = f;
+    f->getTypesPlatform          = (f2GetTypesPlatform)  getAdr(fmu, "fmi2GetTypesPlatform");
+    f->getVersion                = (f2GetVersion)        getAdr(fmu, "fmi2GetVersion");
+    f->setDebugLogging           = (f2SetDebugLogging)   getAdr(fmu, "fmi2SetDebugLogging");
+    f->instantiate               = (f2Instantiate)       getAdr(fmu, "fmi2Instantiate");
+    f->freeInstance              = (f2FreeInstance)      getAdr(fmu, "fmi2FreeInstance");
+    f->setupExperiment           = (f2SetupExperiment)   getAdr(fmu, "fmi2SetupExperiment");
+    f->enterInitializationMode   = (f2Component)         getAdr(fmu, "fmi2EnterInitializationMode");
+    f->exitInitializationMode    = (f2Component)         getAdr(fmu, "fmi2ExitInitializationMode");
+    f->terminate                 = (f2Component)         getAdr(fmu, "fmi2Terminate");
+    f->getReal                   = (f2GetReal)           getAdr(fmu, "fmi2GetReal");
+    f->getInteger                = (f2GetInteger)        getAdr(fmu, "fmi2GetInteger");
+    f->getBoolean                = (f2GetBoolean)        getAdr(fmu, "fmi2GetBoolean");
+    f->getString                 = (f2GetString)         getAdr(fmu, "fmi2GetString");
+    f->setReal                   = (f2SetReal)           getAdr(fmu, "fmi2SetReal");
+    f->setInteger                = (f2SetInteger)        getAdr(fmu, "fmi2SetInteger");
+    f->setBoolean                = (f2SetBoolean)        getAdr(fmu, "fmi2SetBoolean");
+    f->setString                 = (f2SetString)         getAdr(fmu, "fmi2SetString");
+    f->getFMUstate               = (f2GetFMUstate)       getOptionalAdr(fmu, "fmi2GetFMUstate");
+    f->setFMUstate               = (f2SetFMUstate)       getOptionalAdr(fmu, "fmi2SetFMUstate");
+    f->freeFMUstate              = (f2FreeFMUstate)      getOptionalAdr(fmu, "fmi2FreeFMUstate");
+    f->serializedFMUstateSize    = (f2SerializedFMUstateSize)getOptionalAdr(fmu, "fmi2SerializedFMUstateSize");
+    f->serializeFMUstate         = (f2SerializeFMUstate) getOptionalAdr(fmu, "fmi2SerializeFMUstate");
+    f->deSerializeFMUstate       = (f2DeSerializeFMUstate)getOptionalAdr(fmu, "fmi2DeSerializeFMUstate");
+    f->getDirectionalDerivative  = (f2GetDirectionalDerivative)getOptionalAdr(fmu, "fmi2GetDirectionalDerivative");
+    f->enterEventMode            = (f2Component)         getAdr(fmu, "fmi2EnterEventMode");
+    f->newDiscreteStates         = (f2NewDiscreteStates) getAdr(fmu, "fmi2NewDiscreteStates");
+    f->enterContinuousTimeMode   = (f2Component)         getAdr(fmu, "fmi2EnterContinuousTimeMode");
+    f->completedIntegratorStep   = (f2CompletedIntegratorStep)getAdr(fmu, "fmi2CompletedIntegratorStep");
+    f->setTime                   = (f2SetTime)           getAdr(fmu, "fmi2SetTime");
+    f->setContinuousStates       = (f2SetContinuousStates)getAdr(fmu, "fmi2SetContinuousStates");
+    f->getDerivatives            = (f2GetReals)          getAdr(fmu, "fmi2GetDerivatives");
+    f->getEventIndicators        = (f2GetReals)          getAdr(fmu, "fmi2GetEventIndicators");
+    f->getContinuousStates       = (f2GetReals)          getAdr(fmu, "fmi2GetContinuousStates");
+    f->getNominalsOfContinuousStates = (f2GetReals)      getAdr(fmu, "fmi2GetNominalsOfContinuousStates");
+    return fmu2Init(fmu);
+}
+
 void fmuFree(FMU *fmu) {
 #ifdef _MSC_VER
   FreeLibrary(fmu->dllHandle);
-  freeElement(fmu->modelDescription);
 #else
   dlclose(fmu->dllHandle);
-  freeElement(fmu->modelDescription);
 #endif
+  freeElement(fmu->modelDescription);
+  fmu2Free(fmu);
+  removeTmpPath(fmu);
 }
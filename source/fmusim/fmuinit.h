@@ -10,6 +10,7 @@
 
 #include "main.h"
 
+extern int fmuLoad(const char* fmuFileName, FMU *fmu);
 extern int fmuLoadDll(const char* dllPath, FMU *fmu);
 extern void fmuFree(FMU *fmu);
 
@@ -13,11 +13,10 @@ static void doubleToCommaString(char* buffer, double r){
     if (comma) *comma = ',';
 }
 
-// output time and all non-alias variables in CSV format
-// if separator is ',', columns are separated by ',' and '.' is used for floating-point numbers.
-// otherwise, the given separator (e.g. ';' or '\t') is to separate columns, and ',' is used for 
-// floating-point numbers.
-void outputRow(FMU *fmu, fmiComponent c, double time, FILE* file, char separator, int header) {
+// output all non-alias variables in CSV format, each preceded by the separator.
+// header 1 outputs the variable names, each prefixed by prefix and '.' unless prefix is NULL.
+void outputColumns(FMU *fmu, fmiComponent c, FILE* file, char separator, int header,
+        const char* prefix) {
     int k;
     fmiReal r;
     fmiInteger i;
@@ -27,26 +26,13 @@ void outputRow(FMU *fmu, fmiComponent c, double time, FILE* file, char separator
     ScalarVariable** vars = fmu->modelDescription->modelVariables;
     char buffer[32];
     
-    // print first column
-    if (header) 
-        fprintf(file, "time"); 
-    else {
-        if (separator==',') 
-            fprintf(file, "%.16g", time);
-        else {
-            // separator is e.g. ';' or '\t'
-            doubleToCommaString(buffer, time);
-            fprintf(file, "%s", buffer);       
-        }
-    }
-    
-    // print all other columns
     for (k=0; vars[k]; k++) {
         ScalarVariable* sv = vars[k];
         if (getAlias(sv)!=enu_noAlias) continue;
         if (header) {
             // output names only
-            fprintf(file, "%c%s", separator, getName(sv));
+            if (prefix) fprintf(file, "%c%s.%s", separator, prefix, getName(sv));
+            else fprintf(file, "%c%s", separator, getName(sv));
         }
         else {
             // output values
@@ -77,6 +63,31 @@ void outputRow(FMU *fmu, fmiComponent c, double time, FILE* file, char separator
             }
         }
     } // for
+}
+
+// output time or its column name in CSV format
+void outputTime(double time, FILE* file, char separator, int header) {
+    char buffer[32];
+    if (header) 
+        fprintf(file, "time"); 
+    else {
+        if (separator==',') 
+            fprintf(file, "%.16g", time);
+        else {
+            // separator is e.g. ';' or '\t'
+            doubleToCommaString(buffer, time);
+            fprintf(file, "%s", buffer);       
+        }
+    }
+}
+
+// output time and all non-alias variables in CSV format
+// if separator is ',', columns are separated by ',' and '.' is used for floating-point numbers.
+// otherwise, the given separator (e.g. ';' or '\t') is to separate columns, and ',' is used for 
+// floating-point numbers.
+void outputRow(FMU *fmu, fmiComponent c, double time, FILE* file, char separator, int header) {
+    outputTime(time, file, separator, header);
+    outputColumns(fmu, c, file, separator, header, NULL);
     
     // terminate this row
     fprintf(file, "\n"); 
@@ -94,12 +105,14 @@ static const char* fmiStatusToString(fmiStatus status){
 }
 
 // search a fmu for the given variable
-// return NULL if not found or vr = fmiUndefinedValueReference
+// return NULL if not found, vr = fmiUndefinedValueReference or no fmu is loaded,
+// as when simulating a system of fmus
 static ScalarVariable* getSV(FMU* fmu, char type, fmiValueReference vr) {
     int i;
     Elm tp;
-    ScalarVariable** vars = fmu->modelDescription->modelVariables;
-    if (vr==fmiUndefinedValueReference) return NULL;
+    ScalarVariable** vars;
+    if (vr==fmiUndefinedValueReference || !fmu->modelDescription) return NULL;
+    vars = fmu->modelDescription->modelVariables;
     switch (type) {
         case 'r': tp = elm_Real;    break;
         case 'i': tp = elm_Integer; break;
@@ -189,6 +202,23 @@ void fmuLogger(fmiComponent c, fmiString instanceName,
     printf("%s %s (%s): %s\n", fmiStatusToString(status), instanceName, category, msg);
 }
 
+// path relative to the directory of the given file, unless absolute.
+// Returns NULL to indicate error
+char* resolvePath(const char* fileName, const char* path) {
+    char* result;
+    int n = 0;
+    const char* slash = strrchr(fileName, '/');
+    const char* backslash = strrchr(fileName, '\\');
+    if (backslash > slash) slash = backslash;
+    if (slash && path[0] != '/' && path[0] != '\\' && !(path[0] && path[1] == ':'))
+        n = slash - fileName + 1;
+    result = (char*)calloc(n + strlen(path) + 1, sizeof(char));
+    if (!result) return NULL;
+    strncpy(result, fileName, n);
+    strcpy(result + n, path);
+    return result;
+}
+
 int fmuError(const char* message){
     printf("%s\n", message);
     return 0;
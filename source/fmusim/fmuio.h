@@ -17,7 +17,14 @@ extern void fmuLogger(fmiComponent c, fmiString instanceName,
 
 extern void outputRow(FMU *fmu, fmiComponent c, double time, FILE* file,
 	       char separator, int header);
+
+extern void outputTime(double time, FILE* file, char separator, int header);
+
+extern void outputColumns(FMU *fmu, fmiComponent c, FILE* file,
+	       char separator, int header, const char* prefix);
 		   
+extern char* resolvePath(const char* fileName, const char* path);
+
 extern int fmuError(const char *msg);
 
 #endif // fmuio_h
@@ -0,0 +1,689 @@
+/* -------------------------------------------------------------------------
+ * fmusched.c
+ * Simulation of many instances of an FMU on a few worker threads.
+ * Each instance is a task, a stackless coroutine: all of its state is kept
+ * in its SimInstance, and simDoStep can resume it at any step. A worker
+ * runs a task for one slice, until the next event of the instance, and
+ * then requeues it, so that instances with independent event times
+ * interleave and no instance holds a thread for the whole run.
+ * Every worker has its own run queue. A worker takes tasks from the back
+ * of its own queue, which keeps recently used instances in its cache, and
+ * steals from the front of the queue of another worker when idle.
+ * In synchronized mode, the instances advance in global time order.
+ * Waiting instances are kept in a timing wheel keyed on their next time
+ * event, or on the end of their next slice if there is none. Worker 0
+ * dispatches all instances due at the earliest tick as one batch, sorted
+ * by address, and each instance then runs up to the time of that tick.
+ * The final values of an instance are written as soon as it is finished,
+ * and the instance is freed. With a journal, the finished cases are also
+ * recorded there, and a later run of the same cases with the same journal
+ * skips them.
+ * With a sweep, the parameters of each case are set before initialization.
+ * Cases of a sweep may differ widely in cost, and the last long case to
+ * start determines when the run ends. Unless synchronized, the new tasks
+ * of a sweep are therefore kept in a pool instead of the run queues, and
+ * a worker with an empty queue takes the task of the highest predicted
+ * cost from there, before stealing. The cost of each finished case, the
+ * wall time spent in its slices, trains a model of the cost as a function
+ * of the parameters, see costmodel.c, and the pool is ordered by the
+ * predictions of the model whenever it is fitted again. Steps and events
+ * are no measure of the cost: with a fixed step size, their number hardly
+ * varies, while the work per step does.
+ * With a branch time, the cases share a prefix: one instance is simulated
+ * up to the branch time on the main thread and its state saved in a
+ * snapshot. Each case is then initialized, restored from the snapshot, and
+ * its parameters are set before it continues from the branch time. The
+ * dataset holds the rows of the prefix once, in its prefix file.
+ * With a dataset, the rows of an instance at multiples of the dataset
+ * interval are recorded in the task, and handed over to the dataset when
+ * the instance is finished. The dataset is synced before a journal commit.
+ * With stop conditions, an instance is finished as soon as one holds, and
+ * the condition is written to the result file.
+ * With a stats file, each worker counts its slices in its own counters of a
+ * stats block, which a separate thread writes to the file periodically.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "fmusched.h"
+#include "fmuio.h"
+#include "fmuthread.h"
+#include "timewheel.h"
+#include "journal.h"
+#include "dataset.h"
+#include "stop.h"
+#include "stats.h"
+#include "costmodel.h"
+
+#ifndef _MSC_VER
+#define TRUE 1
+#define FALSE 0
+#define max(a,b) (a>b ? a : b)
+#define min(a,b) (a>b ? b : a)
+#endif
+
+#define RESULT_FILE "result.csv"
+#define MAX_STEPS_PER_SLICE 1000 // yield after this many steps without event
+
+typedef enum {
+    taskNew, taskReady, taskDone, taskFailed
+} TaskState;
+
+// one simulated instance
+typedef struct {
+    SimInstance sim;
+    int id;              // case id, the index of the task
+    char* name;          // instance name, used by the fmu until freed
+    TaskState state;
+    TwNode node;         // entry in the timing wheel in synchronized mode
+    double* rows;        // rows recorded for the dataset, or NULL
+    int nRows;           // number of recorded rows
+    int stopTerm;        // stop condition that holds, -1 if none
+    double predicted;    // cost predicted by the cost model
+    double seconds;      // wall time spent in the slices of the instance
+} Task;
+
+// a double-ended queue of tasks, stored in a ring buffer
+typedef struct {
+    Task** tasks;
+    int size;            // allocated size of tasks
+    int head;            // index of the front element
+    int count;           // number of queued tasks
+    Mutex mutex;
+} RunQueue;
+
+typedef struct Scheduler Scheduler;
+
+typedef struct {
+    Thread thread;
+    RunQueue queue;
+    Scheduler* sched;
+    int id;
+    int nSlices;         // number of slices run by this worker
+    int nSteals;         // number of tasks taken from other workers
+} Worker;
+
+struct Scheduler {
+    FMU* fmu;
+    double tEnd;
+    Worker* workers;
+    int nWorkers;
+    Task* tasks;
+    int nTasks;
+    int nFinished;       // number of tasks done or failed
+    Mutex mutex;         // protects nFinished, nInFlight, wheel, pending and cost
+    TimingWheel* wheel;  // waiting tasks, NULL if not synchronized
+    double tStop;        // end time of the slices of the current batch
+    int nInFlight;       // number of tasks of the current batch not finished
+    int nBatches;
+    FILE* file;          // result file
+    char separator;
+    Journal* journal;    // finished cases, NULL if not journaled
+    Sweep* sweep;        // parameters of the cases, or NULL
+    Dataset* dataset;    // trajectories of the cases, or NULL
+    StopCriteria* stop;  // conditions to finish a case early, or NULL
+    Stats* stats;        // live statistics, or NULL
+    SimSnapshot* branch; // state at the end of the common prefix, or NULL
+    Task** pending;      // new tasks of a sweep by predicted cost, highest last, or NULL
+    int nPending;
+    CostModel* cost;     // predicts the cost of the cases of a sweep, or NULL
+    int nextFit;         // number of samples at which the model is fitted next
+    Mutex outMutex;      // protects file, journal and the totals below
+    int nFailed;
+    int nStopped;
+    int nSteps;
+    int nTimeEvents;
+    int nStateEvents;
+    int nStepEvents;
+};
+
+// -------------------------------------------------------------------------
+// Run queues
+
+static void queuePushBack(RunQueue* q, Task* t) {
+    mutexLock(&q->mutex);
+    q->tasks[(q->head + q->count++) % q->size] = t;
+    mutexUnlock(&q->mutex);
+}
+
+// Returns NULL if the queue is empty
+static Task* queuePopBack(RunQueue* q) {
+    Task* t = NULL;
+    mutexLock(&q->mutex);
+    if (q->count > 0) t = q->tasks[(q->head + --q->count) % q->size];
+    mutexUnlock(&q->mutex);
+    return t;
+}
+
+// Returns NULL if the queue is empty
+static Task* queuePopFront(RunQueue* q) {
+    Task* t = NULL;
+    mutexLock(&q->mutex);
+    if (q->count > 0) {
+        t = q->tasks[q->head];
+        q->head = (q->head + 1) % q->size;
+        q->count--;
+    }
+    mutexUnlock(&q->mutex);
+    return t;
+}
+
+// -------------------------------------------------------------------------
+// Workers
+
+static int compareAddress(const void* a, const void* b) {
+    const Task* t1 = *(const Task**)a;
+    const Task* t2 = *(const Task**)b;
+    return t1 < t2 ? -1 : t1 > t2 ? 1 : 0;
+}
+
+static int nEvents(SimInstance* sim) {
+    return sim->nTimeEvents + sim->nStateEvents + sim->nStepEvents;
+}
+
+// time of the next dataset row of the task
+static double rowTime(Scheduler* s, Task* t) {
+    return (s->dataset->firstRow + t->nRows) * s->dataset->dt;
+}
+
+// record the next dataset row of the task if its time is reached.
+// Returns 0 to indicate error
+static int recordRow(Scheduler* s, Task* t) {
+    Dataset* ds = s->dataset;
+    SimInstance* sim = &t->sim;
+    if (t->nRows == ds->nRows || sim->time < rowTime(s, t) - DS_EPS * ds->dt) return 1;
+    if (!t->rows) {
+        t->rows = (double*)calloc((size_t)ds->nRows * ds->nColumns, sizeof(double));
+        if (!t->rows) return fmuError("out of memory");
+    }
+    return dsFetchRow(ds, s->fmu, sim->c, sim->time, t->rows + (size_t)t->nRows++ * ds->nColumns);
+}
+
+// record the dataset row due, and check the stop conditions: on the
+// recorded row with a dataset, otherwise after every step.
+// Returns 0 to indicate error
+static int outputStep(Scheduler* s, Task* t) {
+    int n = t->nRows;
+    if (s->dataset && !recordRow(s, t)) return 0;
+    if (!s->stop) return 1;
+    if (!s->dataset) return stopCheck(s->stop, &t->sim, NULL, &t->stopTerm);
+    if (t->nRows == n) return 1; // no row due
+    return stopCheck(s->stop, &t->sim, t->rows + (size_t)n * s->dataset->nColumns, &t->stopTerm);
+}
+
+// run the task until its next event, tStop or a stop condition.
+// Returns the new state of the task.
+static TaskState runSlice(Scheduler* s, Task* t, double tStop) {
+    int n, events;
+    double tNext;
+    SimInstance* sim = &t->sim;
+    if (t->state == taskNew) {
+        // instantiate on the worker thread that first runs the task
+        if (!simInstantiate(sim, s->fmu, t->name, sim->method, sim->h, sim->loggingOn))
+            return taskFailed;
+        if (s->branch) {
+            // continue from the prefix with the parameters of the case
+            if (!simInitialize(sim, 0) || !simRestore(sim, s->branch)
+                    || (s->sweep && !sweepApply(s->sweep, s->fmu, sim->c, t->id))
+                    || (sim->nz > 0 && s->fmu->getEventIndicators(sim->c, sim->z, sim->nz) > fmiWarning))
+                return taskFailed;
+        }
+        else if ((s->sweep && !sweepApply(s->sweep, s->fmu, sim->c, t->id))
+                || !simInitialize(sim, 0)) return taskFailed;
+        if (!outputStep(s, t)) return taskFailed;
+    }
+    events = nEvents(sim);
+    for (n=0; n<MAX_STEPS_PER_SLICE && sim->time < tStop; n++) {
+        if (sim->terminated || t->stopTerm >= 0) return taskDone;
+        // end steps at the times of the dataset rows
+        tNext = s->dataset && t->nRows < s->dataset->nRows ? min(tStop, rowTime(s, t)) : tStop;
+        if (!simDoStep(sim, tNext)) return taskFailed;
+        if (!outputStep(s, t)) return taskFailed;
+        if (nEvents(sim) != events) break; // yield at the event
+    }
+    return sim->terminated || t->stopTerm >= 0 || sim->time >= s->tEnd ? taskDone : taskReady;
+}
+
+// tick at which the task is scheduled next in synchronized mode
+static Tick nextTick(Scheduler* s, Task* t) {
+    SimInstance* sim = &t->sim;
+    double tNext = sim->time + MAX_STEPS_PER_SLICE * sim->h;
+    if (t->state == taskNew) return 0;
+    if (sim->eventInfo.upcomingTimeEvent && sim->eventInfo.nextEventTime > sim->time
+            && sim->eventInfo.nextEventTime < tNext)
+        tNext = sim->eventInfo.nextEventTime;
+    if (tNext > s->tEnd) tNext = s->tEnd;
+    return twTick(s->wheel, tNext);
+}
+
+// Worker 0 of a synchronized run: if the previous batch is finished, move
+// the tasks due next from the wheel to the run queues.
+static void dispatchBatch(Scheduler* s) {
+    int i, n;
+    Task** batch;
+    TwNode* node;
+    mutexLock(&s->mutex);
+    if (s->nInFlight > 0) {
+        mutexUnlock(&s->mutex);
+        return;
+    }
+    node = twPopNext(s->wheel, &n);
+    mutexUnlock(&s->mutex);
+    if (!node) return;
+    batch = (Task**)calloc(n, sizeof(Task*));
+    if (!batch) {
+        fmuError("out of memory");
+        exit(EXIT_FAILURE);
+    }
+    for (i=0; node; node = node->next) batch[i++] = (Task*)node->data;
+    qsort(batch, n, sizeof(Task*), compareAddress);
+    s->tStop = twTime(s->wheel, s->wheel->now);
+    if (s->tStop > s->tEnd) s->tStop = s->tEnd;
+    s->nInFlight = n;
+    s->nBatches++;
+    // contiguous chunks of the batch go to the same worker
+    for (i=0; i<n; i++) queuePushBack(&s->workers[(long)i * s->nWorkers / n].queue, batch[i]);
+    free(batch);
+}
+
+// order by predicted cost, ties by descending case id
+static int comparePredicted(const void* a, const void* b) {
+    const Task* t1 = *(const Task**)a;
+    const Task* t2 = *(const Task**)b;
+    if (t1->predicted != t2->predicted) return t1->predicted < t2->predicted ? -1 : 1;
+    return t2->id - t1->id;
+}
+
+// add the cost of a finished case to the model. When enough new samples
+// are added, fit the model again and reorder the pool by the predictions.
+// Called with s->mutex locked.
+static void learnCost(Scheduler* s, int id, double cost) {
+    int i;
+    CostModel* m = s->cost;
+    cmAdd(m, id, cost);
+    if (m->nSamples < s->nextFit || s->nPending < 2) return;
+    s->nextFit = m->nSamples + max(m->nFeatures, m->nSamples / 4);
+    if (!cmFit(m)) return;
+    for (i=0; i<s->nPending; i++) s->pending[i]->predicted = cmPredict(m, s->pending[i]->id);
+    qsort(s->pending, s->nPending, sizeof(Task*), comparePredicted);
+}
+
+// Returns NULL if the pool is empty
+static Task* takePending(Scheduler* s) {
+    Task* t = NULL;
+    mutexLock(&s->mutex);
+    if (s->nPending > 0) t = s->pending[--s->nPending];
+    mutexUnlock(&s->mutex);
+    return t;
+}
+
+// Returns NULL if no task is queued at any worker or pending
+static Task* nextTask(Worker* w) {
+    int i;
+    Scheduler* s = w->sched;
+    Task* t = queuePopBack(&w->queue);
+    if (!t && s->pending) t = takePending(s);
+    for (i=1; !t && i<s->nWorkers; i++) {
+        t = queuePopFront(&s->workers[(w->id + i) % s->nWorkers].queue);
+        if (t) w->nSteals++;
+    }
+    return t;
+}
+
+// write the final values and the dataset rows of a finished task, record
+// it in the journal and free its instance
+static void finishTask(Scheduler* s, Task* t) {
+    long offset;
+    SimInstance* sim = &t->sim;
+    // partitions have their own locks, the result file is not needed
+    if (s->dataset && !dsWriteCase(s->dataset, t->id, t->rows, t->state == taskDone ? t->nRows : 0))
+        exit(EXIT_FAILURE);
+    if (t->rows) free(t->rows);
+    t->rows = NULL;
+    mutexLock(&s->outMutex);
+    if (t->state == taskDone) {
+        offset = ftell(s->file);
+        fprintf(s->file, "%d%c", t->id, s->separator);
+        if (s->stop) {
+            fprintf(s->file, "%s%c", t->stopTerm >= 0 ? s->stop->terms[t->stopTerm].text : "",
+                    s->separator);
+            if (t->stopTerm >= 0) s->nStopped++;
+        }
+        outputRow(s->fmu, sim->c, sim->time, s->file, s->separator, FALSE);
+        if (s->journal) journalAdd(s->journal, t->id, offset, ftell(s->file) - offset);
+    }
+    else s->nFailed++;
+    if (s->journal && journalDue(s->journal)) {
+        // journaled cases must be in the dataset
+        if ((s->dataset && !dsSync(s->dataset)) || !journalCommit(s->journal, s->file))
+            exit(EXIT_FAILURE);
+    }
+    s->nSteps += sim->nSteps;
+    s->nTimeEvents += sim->nTimeEvents;
+    s->nStateEvents += sim->nStateEvents;
+    s->nStepEvents += sim->nStepEvents;
+    mutexUnlock(&s->outMutex);
+    simFree(sim);
+}
+
+// run a slice of the task and count it in the live statistics, if any.
+// Returns the new state of the task.
+static TaskState runCounted(Worker* w, Task* t) {
+    Scheduler* s = w->sched;
+    SimInstance* sim = &t->sim;
+    StatsWorker* counters;
+    TaskState state;
+    double time = sim->time;
+    int steps = sim->nSteps;
+    int events = nEvents(sim);
+    int rows = t->nRows;
+    if (s->stats && t->state == taskNew) statsCase(s->stats, t->id, CASE_RUNNING);
+    state = runSlice(s, t, s->wheel ? s->tStop : s->tEnd);
+    if (!s->stats) return state;
+    counters = &s->stats->workers[w->id];
+    statsAdd(&counters->nSlices, 1);
+    statsAdd(&counters->nSteps, sim->nSteps - steps);
+    statsAdd(&counters->nEvents, nEvents(sim) - events);
+    statsAdd(&counters->nRows, t->nRows - rows);
+    // a finished instance counts as simulated up to tEnd. The ticks of each
+    // slice are taken from 0, so that their rounding does not accumulate
+    statsAdd(&counters->simulated, statsTicks(s->stats, state == taskReady ? sim->time : s->tEnd)
+            - statsTicks(s->stats, time));
+    if (state == taskFailed) statsCase(s->stats, t->id, CASE_FAILED);
+    else if (state == taskDone) statsCase(s->stats, t->id, t->stopTerm >= 0 ? CASE_STOPPED : CASE_DONE);
+    return state;
+}
+
+static void workerMain(void* arg) {
+    Worker* w = (Worker*)arg;
+    Scheduler* s = w->sched;
+    Task* t;
+    int finished;
+    double start;
+    for (;;) {
+        t = nextTask(w);
+        if (!t && s->wheel && w->id == 0) {
+            dispatchBatch(s);
+            t = nextTask(w);
+        }
+        if (!t) {
+            // other workers are running the remaining tasks
+            mutexLock(&s->mutex);
+            finished = s->nFinished == s->nTasks;
+            mutexUnlock(&s->mutex);
+            if (finished) return;
+            threadYield();
+            continue;
+        }
+        start = wallClock();
+        t->state = runCounted(w, t);
+        t->seconds += wallClock() - start;
+        w->nSlices++;
+        if (t->state == taskReady && !s->wheel) {
+            queuePushBack(&w->queue, t);
+            continue;
+        }
+        if (t->state != taskReady) finishTask(s, t);
+        mutexLock(&s->mutex);
+        if (t->state == taskReady) twInsert(s->wheel, &t->node, nextTick(s, t));
+        else s->nFinished++;
+        if (t->state == taskDone && s->cost) learnCost(s, t->id, t->seconds);
+        if (s->wheel) s->nInFlight--;
+        mutexUnlock(&s->mutex);
+    }
+}
+
+// -------------------------------------------------------------------------
+// Common prefix
+
+// Simulate the instance prefix from 0 to tBranch, write the dataset rows
+// of this time span to the prefix file, and save the final state in the
+// returned snapshot. prefix must stay alive while the snapshot is used.
+// Returns NULL to indicate error
+static SimSnapshot* simulatePrefix(Scheduler* s, SimInstance* prefix, const char* name,
+        double tBranch) {
+    int nRows = 0;
+    double tNext;
+    double* rows = NULL;
+    SimSnapshot* snap;
+    Dataset* ds = s->dataset;
+    if (!simInstantiate(prefix, s->fmu, name, prefix->method, prefix->h, prefix->loggingOn)
+            || !simInitialize(prefix, 0)) return NULL;
+    if (ds) {
+        rows = (double*)calloc((size_t)ds->firstRow * ds->nColumns + 1, sizeof(double));
+        if (!rows) {
+            fmuError("out of memory");
+            return NULL;
+        }
+    }
+    for (;;) {
+        if (ds && nRows < ds->firstRow && prefix->time >= (nRows - DS_EPS) * ds->dt) {
+            if (!dsFetchRow(ds, s->fmu, prefix->c, prefix->time, rows + (size_t)nRows++ * ds->nColumns))
+                return NULL;
+        }
+        if (prefix->time >= tBranch || prefix->terminated) break;
+        // end steps at the times of the dataset rows
+        tNext = ds && nRows < ds->firstRow ? min(tBranch, nRows * ds->dt) : tBranch;
+        if (!simDoStep(prefix, tNext)) return NULL;
+    }
+    if (ds && !dsWritePrefix(ds, rows, nRows)) return NULL;
+    if (rows) free(rows);
+    snap = simSnapshotNew(prefix);
+    if (!snap) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    if (!simSave(prefix, snap)) return NULL;
+    return snap;
+}
+
+// -------------------------------------------------------------------------
+// Entry function
+
+// simulate e->nInstances instances of the given FMU from 0 to tEnd using
+// e->nThreads worker threads, synchronized in time if e->sync is 1. The final
+// values of all instances are written to the result file, one row per
+// instance in the order of completion, preceded by the case id. If a journal
+// is given, cases recorded there are skipped and finished ones are added.
+// If a dataset is given, the trajectories of all instances are written there.
+// If stop conditions are given, an instance is finished when one holds.
+// If e->tBranch is positive, all instances continue from one prefix
+// simulated up to e->tBranch.
+// Returns 0 to indicate error
+int fmuSimulateInstances(FMU* fmu, Ensemble* e, double tEnd, double h, Method method,
+        fmiBoolean loggingOn, char separator) {
+    int i, k;
+    Scheduler s;
+    FILE* file;
+    Journal* journal = NULL;
+    Dataset* dataset = NULL;
+    SimInstance prefix;
+    char* prefixName = NULL;
+    const char* modelId = getModelIdentifier(fmu->modelDescription);
+    const char* journalPath = e->journalPath;
+    int nInstances = e->nInstances;
+    int nThreads = e->nThreads;
+    int sync = e->sync;
+    int nSkipped = 0, nSlices = 0, nSteals = 0, nCommits = 0, nPartitions = 0, nPrefixSteps = 0;
+
+    if (e->tBranch > 0 && !simHasModelState(fmu)) {
+        printf("error: Branching requires an FMU that exports its model state, %s does not\n", modelId);
+        return 0;
+    }
+    memset(&s, 0, sizeof(Scheduler));
+    memset(&prefix, 0, sizeof(SimInstance));
+    if (journalPath) {
+        journal = journalOpen(journalPath, getString(fmu->modelDescription, att_guid), nInstances,
+                tEnd, h, mthNames[method], e->sweep ? e->sweep->hash : 0);
+        if (!journal) return 0;
+        nSkipped = journal->nDone;
+        file = journalOpenResult(journal, RESULT_FILE);
+    }
+    else file = fopen(RESULT_FILE, "w");
+    if (!file) {
+        printf("could not write %s\n", RESULT_FILE);
+        return 0; // failure
+    }
+    if (e->datasetPath) {
+        dataset = dsOpen(e->datasetPath, fmu->modelDescription, e->sweep, nInstances,
+                e->tBranch, tEnd, e->interval, e->nPartitions, journal ? journal->done : NULL);
+        if (!dataset) return 0;
+        nPartitions = dataset->nPartitions;
+    }
+    if (e->nStopConditions > 0) {
+        s.stop = stopCompile(e->stopConditions, e->nStopConditions, fmu->modelDescription, dataset);
+        if (!s.stop) return 0;
+    }
+    if (nSkipped == 0) {
+        fprintf(file, "case%c", separator);
+        if (e->nStopConditions > 0) fprintf(file, "stop%c", separator);
+        outputRow(fmu, NULL, 0, file, separator, TRUE); // output column names
+    }
+    if (nThreads > nInstances - nSkipped) nThreads = max(1, nInstances - nSkipped);
+    s.fmu = fmu;
+    s.tEnd = tEnd;
+    s.nTasks = nInstances;
+    s.nFinished = nSkipped;
+    s.nWorkers = nThreads;
+    s.file = file;
+    s.separator = separator;
+    s.journal = journal;
+    s.sweep = e->sweep;
+    s.dataset = dataset;
+    if (e->tBranch > 0) {
+        prefixName = (char*)calloc(strlen(modelId) + 8, sizeof(char));
+        if (!prefixName) return fmuError("out of memory");
+        sprintf(prefixName, "%s_prefix", modelId);
+        prefix.method = method;
+        prefix.h = h;
+        prefix.loggingOn = loggingOn;
+        s.branch = simulatePrefix(&s, &prefix, prefixName, e->tBranch);
+        if (!s.branch) return 0;
+    }
+    if (sync) {
+        s.wheel = twNew(0, h);
+        if (!s.wheel) return fmuError("out of memory");
+    }
+    if (e->statsPath) {
+        s.stats = statsOpen(e->statsPath, nThreads, nInstances, tEnd);
+        if (!s.stats) return 0;
+    }
+    s.tasks = (Task*)calloc(nInstances, sizeof(Task));
+    s.workers = (Worker*)calloc(nThreads, sizeof(Worker));
+    if (!s.tasks || !s.workers) return fmuError("out of memory");
+    if (e->sweep && !sync) {
+        s.pending = (Task**)calloc(nInstances, sizeof(Task*));
+        s.cost = cmNew(e->sweep);
+        if (!s.pending || !s.cost) return fmuError("out of memory");
+        s.nextFit = s.cost->nFeatures;
+    }
+    mutexInit(&s.mutex);
+    mutexInit(&s.outMutex);
+    for (i=0; i<nThreads; i++) {
+        Worker* w = &s.workers[i];
+        w->sched = &s;
+        w->id = i;
+        w->queue.size = nInstances;
+        w->queue.tasks = (Task**)calloc(nInstances, sizeof(Task*));
+        if (!w->queue.tasks) return fmuError("out of memory");
+        mutexInit(&w->queue.mutex);
+    }
+
+    // distribute the remaining tasks round robin over the workers, or
+    // put them in the pool, the first case last
+    for (i=0, k=0; i<nInstances; i++) {
+        Task* t = &s.tasks[i];
+        t->id = i;
+        if (journal && journal->done[i]) {
+            t->state = taskDone;
+            if (s.stats) statsCase(s.stats, i, CASE_SKIPPED);
+            continue;
+        }
+        t->name = (char*)calloc(strlen(modelId) + 12, sizeof(char));
+        if (!t->name) return fmuError("out of memory");
+        sprintf(t->name, "%s_%d", modelId, i);
+        t->state = taskNew;
+        t->stopTerm = -1;
+        t->sim.method = method;
+        t->sim.h = h;
+        t->sim.loggingOn = loggingOn;
+        t->node.data = t;
+        if (sync) twInsert(s.wheel, &t->node, nextTick(&s, t));
+        else if (!s.pending) queuePushBack(&s.workers[k++ % nThreads].queue, t);
+    }
+    for (i=nInstances-1; s.pending && i>=0; i--) {
+        if (s.tasks[i].state == taskNew) s.pending[s.nPending++] = &s.tasks[i];
+    }
+
+    // run the workers, the main thread is worker 0
+    for (i=1; i<nThreads; i++) {
+        if (!threadCreate(&s.workers[i].thread, workerMain, &s.workers[i]))
+            return fmuError("could not create worker thread");
+    }
+    workerMain(&s.workers[0]);
+    for (i=1; i<nThreads; i++) threadJoin(s.workers[i].thread);
+    if (s.stats) statsClose(s.stats);
+    if (s.branch) {
+        nPrefixSteps = prefix.nSteps;
+        simSnapshotFree(s.branch);
+        simFree(&prefix);
+        free(prefixName);
+    }
+
+    for (i=0; i<nInstances; i++) {
+        if (s.tasks[i].name) free(s.tasks[i].name);
+    }
+    if (dataset && !dsSync(dataset)) s.nFailed++;
+    if (journal) {
+        if (!journalCommit(journal, file)) s.nFailed++;
+        nCommits = journal->nCommits;
+        journalClose(journal, file);
+    }
+    for (i=0; i<nThreads; i++) {
+        nSlices += s.workers[i].nSlices;
+        nSteals += s.workers[i].nSteals;
+        mutexFree(&s.workers[i].queue.mutex);
+        free(s.workers[i].queue.tasks);
+    }
+    fclose(file);
+    if (dataset && !dsClose(dataset, separator)) s.nFailed++;
+    if (s.stop) stopFree(s.stop);
+    if (s.wheel) twFree(s.wheel);
+    if (s.pending) free(s.pending);
+    mutexFree(&s.mutex);
+    mutexFree(&s.outMutex);
+    free(s.tasks);
+    free(s.workers);
+
+    // print simulation summary
+    printf("Simulation of %d instances from 0 to %g terminated %s\n", nInstances, tEnd,
+            s.nFailed ? "with errors" : "successful");
+    printf("  failed instances . %d\n", s.nFailed);
+    if (e->tBranch > 0) printf("  branch time ...... %g (%d prefix steps)\n", e->tBranch, nPrefixSteps);
+    if (e->nStopConditions > 0) printf("  stopped instances  %d\n", s.nStopped);
+    if (journal) {
+        printf("  skipped instances  %d (journal %s)\n", nSkipped, journalPath);
+        printf("  journal commits .. %d\n", nCommits);
+    }
+    printf("  worker threads ... %d\n", nThreads);
+    printf("  slices ........... %d\n", nSlices);
+    printf("  stolen slices .... %d\n", nSteals);
+    if (sync) printf("  batches .......... %d\n", s.nBatches);
+    if (s.cost) {
+        printf("  cost model ....... %d fits, longest predicted case first\n", s.cost->nFits);
+        cmFree(s.cost);
+    }
+    printf("  steps ............ %d\n", s.nSteps);
+    printf("  fixed step size .. %g\n", h);
+    printf("  method ........... %s\n", mthNames[method]);
+    printf("  time events ...... %d\n", s.nTimeEvents);
+    printf("  state events ..... %d\n", s.nStateEvents);
+    printf("  step events ...... %d\n", s.nStepEvents);
+    if (e->statsPath) printf("  stats file ....... %s\n", e->statsPath);
+    if (dataset) printf("  dataset .......... %s (%d partitions)\n", e->datasetPath, nPartitions);
+    printf("CSV file '%s' written.\n", RESULT_FILE);
+    return s.nFailed == 0;
+}
@@ -0,0 +1,33 @@
+/* -------------------------------------------------------------------------
+ * fmusched.h
+ * Simulation of many instances of an FMU on a few worker threads
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef fmusched_h
+#define fmusched_h
+
+#include "fmusim.h"
+#include "sweep.h"
+
+// options of a simulation of many instances
+typedef struct {
+    int nInstances;
+    int nThreads;
+    int sync;                        // 1 to advance the instances in time order
+    const char* journalPath;         // journal of finished cases, or NULL
+    Sweep* sweep;                    // parameters of the cases, or NULL
+    const char* datasetPath;         // directory of the dataset, or NULL
+    double interval;                 // time between the rows of the dataset
+    int nPartitions;                 // number of files of the dataset
+    const char** stopConditions;     // finish a case when one of them holds
+    int nStopConditions;
+    const char* statsPath;           // file of live statistics, or NULL
+    double tBranch;                  // end of the prefix common to all cases, 0 if none
+} Ensemble;
+
+int fmuSimulateInstances(FMU* fmu, Ensemble* e, double tEnd, double h, Method method,
+        fmiBoolean loggingOn, char separator);
+
+#endif // fmusched_h
@@ -1,8 +1,12 @@
 #include "fmusim.h"
 #include "fmuio.h"
+#include "fmuthread.h"
+#include "fmu2.h"
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <math.h>
 
 #ifndef _MSC_VER
 #define TRUE 1
@@ -10,171 +14,400 @@
 #define min(a,b) (a>b ? b : a)
 #endif
 
-#define RESULT_FILE "result.csv"
 
-// simulate the given FMU using the forward euler method.
-// time events are processed by reducing step size to exactly hit tNext.
-// state events are checked and fired only at the end of an Euler step. 
-// the simulator may therefore miss state events and fires state events typically too late.
-int fmuSimulate(FMU* fmu, double tEnd, double h, fmiBoolean loggingOn, char separator) {
-    int i, n;
-    double dt, tPre;
-    fmiBoolean timeEvent, stateEvent, stepEvent;
-    double time;  
-    int nx;                          // number of state variables
-    int nz;                          // number of state event indicators
-    double *x;                       // continuous states
-    double *xdot;                    // the crresponding derivatives in same order
-    double *z = NULL;                // state event indicators
-    double *prez = NULL;             // previous values of state event indicators
-    fmiEventInfo eventInfo;          // updated by calls to initialize and eventUpdate
-    ModelDescription* md;            // handle to the parsed XML file        
-    const char* guid;                // global unique id of the fmu
+// instantiate the fmu and allocate memory for simulating it.
+// Variables may be set using the fmu functions between this and simInitialize.
+// Returns 0 to indicate error
+int simInstantiate(SimInstance* s, FMU* fmu, const char* instanceName,
+        Method method, double h, fmiBoolean loggingOn) {
+    ModelDescription* md = fmu->modelDescription;
     fmiCallbackFunctions callbacks;  // called by the model during simulation
-    fmiComponent c;                  // instance of the fmu 
-    fmiStatus fmiFlag;               // return code of the fmu functions
-    fmiReal t0 = 0;                  // start time
-    fmiBoolean toleranceControlled = fmiFalse;
-    int nSteps = 0;
-    int nTimeEvents = 0;
-    int nStepEvents = 0;
-    int nStateEvents = 0;
-    FILE* file;
-
-    // instantiate the fmu
-    md = fmu->modelDescription;
-    guid = getString(md, att_guid);
+    memset(s, 0, sizeof(SimInstance));
+    s->fmu = fmu;
+    s->method = method;
+    s->h = h;
+    s->loggingOn = loggingOn;
     callbacks.logger = fmuLogger;
     callbacks.allocateMemory = calloc;
     callbacks.freeMemory = free;
-    c = fmu->instantiateModel(getModelIdentifier(md), guid, callbacks, loggingOn);
-    if (!c) return fmuError("could not instantiate model");
-    
-    // allocate memory 
-    nx = getNumberOfStates(md);
-    nz = getNumberOfEventIndicators(md);
-    x    = (double *) calloc(nx, sizeof(double));
-    xdot = (double *) calloc(nx, sizeof(double));
-    if (nz>0) {
-        z    =  (double *) calloc(nz, sizeof(double));
-        prez =  (double *) calloc(nz, sizeof(double));
-    }
-    if (!x || !xdot || nz>0 && (!z || !prez)) return fmuError("out of memory");
+    if (fmu->fmi2) s->c = fmu2Instantiate(fmu, instanceName, callbacks, loggingOn);
+    else s->c = fmu->instantiateModel(instanceName, getString(md, att_guid), callbacks, loggingOn);
+    if (!s->c) return fmuError("could not instantiate model");
 
-    // open result file
-    if (!(file=fopen(RESULT_FILE, "w"))) {
-        printf("could not write %s\n", RESULT_FILE);
-        return 0; // failure
+    // allocate memory
+    s->nx = getNumberOfStates(md);
+    s->nz = getNumberOfEventIndicators(md);
+    s->x    = (double *) calloc(s->nx, sizeof(double));
+    s->work = (double *) calloc(getWorkSize(method, s->nx), sizeof(double));
+    if (s->nz>0) {
+        s->z    =  (double *) calloc(s->nz, sizeof(double));
+        s->prez =  (double *) calloc(s->nz, sizeof(double));
     }
-        
-    // set the start time and initialize
-    time = t0;
-    fmiFlag =  fmu->setTime(c, t0);
+    if (!s->x || !s->work || s->nz>0 && (!s->z || !s->prez)) return fmuError("out of memory");
+    return 1; // success
+}
+
+// set the start time and initialize
+// Returns 0 to indicate error
+int simInitialize(SimInstance* s, double t0) {
+    FMU* fmu = s->fmu;
+    fmiStatus fmiFlag;               // return code of the fmu functions
+    fmiBoolean toleranceControlled = fmiFalse;
+    s->t0 = t0;
+    s->n = 0;
+    s->time = t0;
+    fmiFlag =  fmu->setTime(s->c, t0);
     if (fmiFlag > fmiWarning) return fmuError("could not set time");
-    fmiFlag =  fmu->initialize(c, toleranceControlled, t0, &eventInfo);
+    fmiFlag =  fmu->initialize(s->c, toleranceControlled, t0, &s->eventInfo);
     if (fmiFlag > fmiWarning)  fmuError("could not initialize model");
-    if (eventInfo.terminateSimulation) {
+    s->initialized = TRUE;
+    if (s->eventInfo.terminateSimulation) {
         printf("model requested termination at init");
-        tEnd = time;
+        s->terminated = TRUE;
     }
-  
-    // output solution for time t0
-    outputRow(fmu, c, t0, file, separator, TRUE);  // output column names
-    outputRow(fmu, c, t0, file, separator, FALSE); // output values
+    if (s->nz>0) {
+        fmiFlag = fmu->getEventIndicators(s->c, s->z, s->nz);
+        if (fmiFlag > fmiWarning) return fmuError("could not retrieve event indicators");
+    }
+    return 1; // success
+}
+
+// perform one step of the integration method, ending at tEnd the latest.
+// steps end on the grid t0 + n*h, with n an integer counted by the steps,
+// which avoids the drift of adding up h. A step ending at a time event or
+// tEnd before its grid point keeps n, so that the next step ends on the grid.
+// time events are processed by reducing step size to exactly hit tNext.
+// a step is stretched by up to MERGE_EPS*h to end at tEnd or at a time event
+// just after its grid point, instead of leaving a sliver step to reach it.
+// state events are checked and fired only at the end of a step.
+// the simulator may therefore miss state events and fires state events typically too late.
+// Returns 0 to indicate error
+int simDoStep(SimInstance* s, double tEnd) {
+    int i;
+    double dt, tPre, tGrid, tNext, tMerge;
+    fmiBoolean timeEvent, stateEvent, stepEvent;
+    StepLimit limit;
+    FMU* fmu = s->fmu;
+    fmiComponent c = s->c;
+    fmiStatus fmiFlag;               // return code of the fmu functions
+
+    // get current state
+    fmiFlag = fmu->getContinuousStates(c, s->x, s->nx);
+    if (fmiFlag > fmiWarning) return fmuError("could not retrieve states");
+
+    // advance time
+    tPre = s->time;
+    tGrid = s->t0 + (s->n + 1) * s->h;
+    tNext = tEnd < tGrid + MERGE_EPS * s->h ? tEnd : tGrid;
+    limit = tNext < tGrid - TICK_EPS * s->h ? lim_end : lim_grid;
+    // a time event may stretch the step, but not beyond tEnd
+    tMerge = tNext == tEnd ? tEnd + TICK_EPS * s->h : tGrid + MERGE_EPS * s->h;
+    timeEvent = s->eventInfo.upcomingTimeEvent && s->eventInfo.nextEventTime < tMerge;
+    if (timeEvent && s->eventInfo.nextEventTime < tNext - TICK_EPS * s->h) limit = lim_timeEvent;
+    if (timeEvent) tNext = s->eventInfo.nextEventTime;
+    s->time = tNext;
+    if (tNext > tGrid - TICK_EPS * s->h) s->n++;
+    dt = s->time - tPre;
+
+    // perform one step
+    if (s->counters) countersBegin(s->counters);
+    if (!solverStep(fmu, c, s->method, tPre, dt, s->x, s->nx, s->work)) return 0;
+    if (s->counters) countersEnd(s->counters, phDerivatives);
+    s->nDerivatives += getStages(s->method);
+    if (s->loggingOn) printf("Step %d to t=%.16g\n", s->nSteps, s->time);
+
+    // Check for step event, e.g. dynamic state selection
+    fmiFlag = fmu->completedIntegratorStep(c, &stepEvent);
+    if (fmiFlag > fmiWarning) return fmuError("could not complete intgrator step");
+
+    // Check for state event
+    for (i=0; i<s->nz; i++) s->prez[i] = s->z[i];
+    if (s->counters) countersBegin(s->counters);
+    fmiFlag = fmu->getEventIndicators(c, s->z, s->nz);
+    if (s->counters) countersEnd(s->counters, phIndicators);
+    if (fmiFlag > fmiWarning) return fmuError("could not retrieve event indicators");
+    stateEvent = FALSE;
+    for (i=0; i<s->nz; i++)
+        stateEvent = stateEvent || (s->prez[i] * s->z[i] < 0);
+
+    // estimate the error of the step, before an event changes the states
+    if (s->diagnostics) {
+        if (!diagStep(s->diagnostics, fmu, c, s->method, tPre, dt, s->x, s->work,
+                s->prez, s->z, limit)) return 0;
+        s->nDerivatives += getErrorStages(s->method);
+    }
+
+    // handle events
+    if (timeEvent || stateEvent || stepEvent) {
 
-    // enter the simulation loop
-    while (time < tEnd) {
-     // get current state and derivatives
-     fmiFlag = fmu->getContinuousStates(c, x, nx);
-     if (fmiFlag > fmiWarning) return fmuError("could not retrieve states");
-     fmiFlag = fmu->getDerivatives(c, xdot, nx);
-     if (fmiFlag > fmiWarning) return fmuError("could not retrieve derivatives");
-
-     // advance time
-     tPre = time;
-     time = min(time+h, tEnd);
-     timeEvent = eventInfo.upcomingTimeEvent && eventInfo.nextEventTime < time;     
-     if (timeEvent) time = eventInfo.nextEventTime;
-     dt = time - tPre; 
-     fmiFlag = fmu->setTime(c, time);
-     if (fmiFlag > fmiWarning) fmuError("could not set time");
-
-     // perform one step
-     for (i=0; i<nx; i++) x[i] += dt*xdot[i]; // forward Euler method
-     fmiFlag = fmu->setContinuousStates(c, x, nx);
-     if (fmiFlag > fmiWarning) return fmuError("could not set states");
-     if (loggingOn) printf("Step %d to t=%.16g\n", nSteps, time);
-    
-     // Check for step event, e.g. dynamic state selection
-     fmiFlag = fmu->completedIntegratorStep(c, &stepEvent);
-     if (fmiFlag > fmiWarning) return fmuError("could not complete intgrator step");
-
-     // Check for state event
-     for (i=0; i<nz; i++) prez[i] = z[i]; 
-     fmiFlag = fmu->getEventIndicators(c, z, nz);
-     if (fmiFlag > fmiWarning) return fmuError("could not retrieve event indicators");
-     stateEvent = FALSE;
-     for (i=0; i<nz; i++) 
-         stateEvent = stateEvent || (prez[i] * z[i] < 0);  
-     
-     // handle events
-     if (timeEvent || stateEvent || stepEvent) {
-        
         if (timeEvent) {
-            nTimeEvents++;
-            if (loggingOn) printf("time event at t=%.16g\n", time);
+            s->nTimeEvents++;
+            if (s->loggingOn) printf("time event at t=%.16g\n", s->time);
         }
         if (stateEvent) {
-            nStateEvents++;
-            if (loggingOn) for (i=0; i<nz; i++)
-                printf("state event %s z[%d] at t=%.16g\n", 
-                        (prez[i]>0 && z[i]<0) ? "-\\-" : "-/-", i, time);
+            s->nStateEvents++;
+            if (s->loggingOn) for (i=0; i<s->nz; i++)
+                printf("state event %s z[%d] at t=%.16g\n",
+                        (s->prez[i]>0 && s->z[i]<0) ? "-\\-" : "-/-", i, s->time);
         }
         if (stepEvent) {
-            nStepEvents++;
-            if (loggingOn) printf("step event at t=%.16g\n", time);
+            s->nStepEvents++;
+            if (s->loggingOn) printf("step event at t=%.16g\n", s->time);
         }
 
         // event iteration in one step, ignoring intermediate results
-        fmiFlag = fmu->eventUpdate(c, fmiFalse, &eventInfo);
+        if (s->counters) countersBegin(s->counters);
+        fmiFlag = fmu->eventUpdate(c, fmiFalse, &s->eventInfo);
+        if (s->counters) countersEnd(s->counters, phEventUpdate);
         if (fmiFlag > fmiWarning) return fmuError("could not perform event update");
-        
+
         // terminate simulation, if requested by the model
-        if (eventInfo.terminateSimulation) {
-            printf("model requested termination at t=%.16g\n", time);
-            break; // success
+        if (s->eventInfo.terminateSimulation) {
+            printf("model requested termination at t=%.16g\n", s->time);
+            s->terminated = TRUE;
+            return 1; // success
         }
 
         // check for change of value of states
-        if (eventInfo.stateValuesChanged && loggingOn) {
-            printf("state values changed at t=%.16g\n", time);
+        if (s->eventInfo.stateValuesChanged && s->loggingOn) {
+            printf("state values changed at t=%.16g\n", s->time);
         }
-        
+
         // check for selection of new state variables
-        if (eventInfo.stateValueReferencesChanged && loggingOn) {
-            printf("new state variables selected at t=%.16g\n", time);
+        if (s->eventInfo.stateValueReferencesChanged && s->loggingOn) {
+            printf("new state variables selected at t=%.16g\n", s->time);
         }
-       
-     } // if event
-     outputRow(fmu, c, time, file, separator, FALSE); // output values for this step
-     nSteps++;
-  } // while  
-
-  // cleanup
-  fclose(file);
-  if (x!=NULL) free(x);
-  if (xdot!= NULL) free(xdot);
-  if (z!= NULL) free(z);
-  if (prez!= NULL) free(prez);
-
-  // print simulation summary 
-  printf("Simulation from %g to %g terminated successful\n", t0, tEnd);
-  printf("  steps ............ %d\n", nSteps);
-  printf("  fixed step size .. %g\n", h);
-  printf("  time events ...... %d\n", nTimeEvents);
-  printf("  state events ..... %d\n", nStateEvents);
-  printf("  step events ...... %d\n", nStepEvents);
-  printf("CSV file '%s' written.\n", RESULT_FILE);
-
-  return 1; // success
+
+    } // if event
+    s->nSteps++;
+    return 1; // success
+}
+
+// terminate and free the instance and release the memory of s
+void simFree(SimInstance* s) {
+    if (s->c) {
+        if (s->initialized) s->fmu->terminate(s->c);
+        s->fmu->freeModelInstance(s->c);
+    }
+    if (s->x!=NULL) free(s->x);
+    if (s->work!= NULL) free(s->work);
+    if (s->z!= NULL) free(s->z);
+    if (s->prez!= NULL) free(s->prez);
+    memset(s, 0, sizeof(SimInstance));
+}
+
+// -------------------------------------------------------------------------
+// Snapshots
+
+// Collect the value references of the inputs of the given base type,
+// each once. Returns 0 to indicate error
+static int initSnapshotValues(SnapshotValues* v, ModelDescription* md, Elm type, int size) {
+    int i, k;
+    ScalarVariable** vars = md->modelVariables;
+    for (i=0; vars[i]; i++);
+    v->vr = (fmiValueReference*)calloc(i + 1, sizeof(fmiValueReference));
+    v->values = calloc(i + 1, size);
+    if (!v->vr || !v->values) return 0;
+    for (i=0; vars[i]; i++) {
+        fmiValueReference vr = getValueReference(vars[i]);
+        Elm t = vars[i]->typeSpec->type;
+        if (t == elm_Enumeration) t = elm_Integer;
+        if (t != type || getCausality(vars[i]) != enu_input) continue;
+        for (k=0; k<v->n && v->vr[k]!=vr; k++);
+        if (k == v->n) v->vr[v->n++] = vr;
+    }
+    return 1; // success
+}
+
+static fmiStatus worst(fmiStatus a, fmiStatus b) {
+    return a > b ? a : b;
+}
+
+static void freeSnapshotValues(SnapshotValues* v) {
+    if (v->vr) free(v->vr);
+    if (v->values) free(v->values);
+}
+
+// 1 if the fmu exports its internal state, so that snapshots restore it
+// exactly, see SimSnapshot
+int simHasModelState(FMU* fmu) {
+    return fmu->getModelStateSize && fmu->getModelState && fmu->setModelState;
+}
+
+// Allocate a snapshot for the given instance.
+// Returns NULL to indicate error
+SimSnapshot* simSnapshotNew(SimInstance* s) {
+    FMU* fmu = s->fmu;
+    ModelDescription* md = fmu->modelDescription;
+    int ok;
+    SimSnapshot* snap = (SimSnapshot*)calloc(1, sizeof(SimSnapshot));
+    if (!snap) return NULL;
+    snap->x = (double*)calloc(s->nx + 1, sizeof(double));
+    snap->z = (double*)calloc(s->nz + 1, sizeof(double));
+    if (simHasModelState(fmu)) {
+        snap->modelStateSize = fmu->getModelStateSize(s->c);
+        snap->modelState = calloc(snap->modelStateSize + 1, 1);
+        ok = snap->modelState != NULL;
+    }
+    else ok = initSnapshotValues(&snap->reals, md, elm_Real, sizeof(fmiReal))
+            && initSnapshotValues(&snap->integers, md, elm_Integer, sizeof(fmiInteger))
+            && initSnapshotValues(&snap->booleans, md, elm_Boolean, sizeof(fmiBoolean))
+            && initSnapshotValues(&snap->strings, md, elm_String, sizeof(fmiString));
+    if (!ok || !snap->x || !snap->z) {
+        simSnapshotFree(snap);
+        fmuError("out of memory");
+        return NULL;
+    }
+    return snap;
+}
+
+// Save the state of the initialized instance s.
+// Returns 0 to indicate error
+int simSave(SimInstance* s, SimSnapshot* snap) {
+    FMU* fmu = s->fmu;
+    fmiStatus status = fmiOK;
+    snap->time = s->time;
+    snap->n = s->n;
+    if (s->nx>0) status = fmu->getContinuousStates(s->c, snap->x, s->nx);
+    if (s->nz>0) memcpy(snap->z, s->z, s->nz * sizeof(double));
+    snap->eventInfo = s->eventInfo;
+    snap->terminated = s->terminated;
+    if (snap->modelState)
+        status = worst(status, fmu->getModelState(s->c, snap->modelState, snap->modelStateSize));
+    if (snap->reals.n)
+        status = worst(status, fmu->getReal(s->c, snap->reals.vr, snap->reals.n, (fmiReal*)snap->reals.values));
+    if (snap->integers.n)
+        status = worst(status, fmu->getInteger(s->c, snap->integers.vr, snap->integers.n, (fmiInteger*)snap->integers.values));
+    if (snap->booleans.n)
+        status = worst(status, fmu->getBoolean(s->c, snap->booleans.vr, snap->booleans.n, (fmiBoolean*)snap->booleans.values));
+    if (snap->strings.n)
+        status = worst(status, fmu->getString(s->c, snap->strings.vr, snap->strings.n, (fmiString*)snap->strings.values));
+    if (status > fmiWarning) return fmuError("could not save the state of the model");
+    return 1; // success
+}
+
+// Set the instance s back to the state saved in snap.
+// The counters of s are not restored, they count all work done.
+// Returns 0 to indicate error
+int simRestore(SimInstance* s, SimSnapshot* snap) {
+    FMU* fmu = s->fmu;
+    fmiStatus status;
+    s->time = snap->time;
+    s->n = snap->n;
+    memcpy(s->x, snap->x, s->nx * sizeof(double));
+    if (s->nz>0) memcpy(s->z, snap->z, s->nz * sizeof(double));
+    s->eventInfo = snap->eventInfo;
+    s->terminated = snap->terminated;
+    status = fmu->setTime(s->c, s->time);
+    if (snap->modelState)
+        status = worst(status, fmu->setModelState(s->c, snap->modelState, snap->modelStateSize));
+    if (snap->reals.n)
+        status = worst(status, fmu->setReal(s->c, snap->reals.vr, snap->reals.n, (fmiReal*)snap->reals.values));
+    if (snap->integers.n)
+        status = worst(status, fmu->setInteger(s->c, snap->integers.vr, snap->integers.n, (fmiInteger*)snap->integers.values));
+    if (snap->booleans.n)
+        status = worst(status, fmu->setBoolean(s->c, snap->booleans.vr, snap->booleans.n, (fmiBoolean*)snap->booleans.values));
+    if (snap->strings.n)
+        status = worst(status, fmu->setString(s->c, snap->strings.vr, snap->strings.n, (fmiString*)snap->strings.values));
+    if (s->nx>0) status = worst(status, fmu->setContinuousStates(s->c, s->x, s->nx));
+    if (status > fmiWarning) return fmuError("could not restore the state of the model");
+    return 1; // success
+}
+
+void simSnapshotFree(SimSnapshot* snap) {
+    if (snap->x) free(snap->x);
+    if (snap->z) free(snap->z);
+    if (snap->modelState) free(snap->modelState);
+    freeSnapshotValues(&snap->reals);
+    freeSnapshotValues(&snap->integers);
+    freeSnapshotValues(&snap->booleans);
+    freeSnapshotValues(&snap->strings);
+    free(snap);
+}
+
+// the output, opened while the fmu is instantiated
+typedef struct {
+    FMU* fmu;
+    Sink* sinks;
+    Output* output;                  // NULL to indicate error
+} OpenTask;
+
+static void openOutput(void* arg) {
+    OpenTask* t = (OpenTask*)arg;
+    t->output = outputOpen(t->fmu, t->sinks);
+}
+
+// simulate the given FMU using the given fixed-step integration method,
+// writing the rows of the result to the list of sinks, and setting the
+// inputs from the given table before each step, unless inputs is NULL.
+// If countersOn is 1, hardware counters of the phases of the simulation are
+// reported in the summary. Unless diagnostics is NULL, the error of each
+// step is recorded, see diagnostics.c, and the states and event indicators
+// limiting the step size are ranked in the summary.
+int fmuSimulate(FMU* fmu, double tEnd, double h, Method method,
+        fmiBoolean loggingOn, Sink* sinks, Inputs* inputs, int countersOn,
+        Diagnostics* diagnostics) {
+    SimInstance sim;
+    fmiReal t0 = 0;                  // start time
+    Output* output;
+    OpenTask task;
+    Thread thread;
+    int ok, started;
+
+    // instantiate the fmu, and begin the sinks on a thread meanwhile
+    task.fmu = fmu;
+    task.sinks = sinks;
+    started = threadCreate(&thread, openOutput, &task);
+    ok = simInstantiate(&sim, fmu, getModelIdentifier(fmu->modelDescription),
+            method, h, loggingOn);
+    if (started) threadJoin(thread);
+    else openOutput(&task);
+    output = task.output;
+    if (!ok) {
+        if (output) outputAbort(output);
+        return 0;
+    }
+    if (!output) return 0;
+    if (countersOn && !(sim.counters = countersOpen())) return 0;
+
+    // set the start time and initialize
+    if (inputs && !inputsApply(inputs, fmu, sim.c, t0)) return 0;
+    if (!simInitialize(&sim, t0)) return 0;
+    if (sim.terminated) tEnd = sim.time;
+    if (diagnostics && !diagBegin(diagnostics, fmu, sim.c, sim.nx, sim.nz)) return 0;
+    sim.diagnostics = diagnostics;
+
+    // output solution for time t0
+    if (!outputSample(output, sim.c, t0)) return 0;
+
+    // enter the simulation loop
+    while (sim.time < tEnd) {
+        if (inputs && !inputsApply(inputs, fmu, sim.c, sim.time)) return 0;
+        if (!simDoStep(&sim, tEnd)) return 0;
+        if (sim.terminated) break; // success
+        if (sim.counters) countersBegin(sim.counters);
+        if (!outputSample(output, sim.c, sim.time)) return 0; // output values for this step
+        if (sim.counters) countersEnd(sim.counters, phOutput);
+    } // while
+
+    // cleanup
+    if (!outputClose(output)) return 0;
+
+    // print simulation summary
+    printf("Simulation from %g to %g terminated successful\n", t0, tEnd);
+    printf("  steps ............ %d\n", sim.nSteps);
+    printf("  derivatives ...... %ld\n", sim.nDerivatives);
+    printf("  fixed step size .. %g\n", h);
+    printf("  method ........... %s\n", mthNames[method]);
+    printf("  time events ...... %d\n", sim.nTimeEvents);
+    printf("  state events ..... %d\n", sim.nStateEvents);
+    printf("  step events ...... %d\n", sim.nStepEvents);
+    if (sim.counters) {
+        countersPrint(sim.counters);
+        countersClose(sim.counters);
+    }
+    if (sim.diagnostics) diagPrint(sim.diagnostics);
+    simFree(&sim);
+
+    return 1; // success
 }
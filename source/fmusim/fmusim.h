@@ -1,7 +1,7 @@
-/* ------------------------------------------------------------------------- 
+/* -------------------------------------------------------------------------
  * fmusim.h
  * Code for simulating models
- * Copyright 2010 QTronic GmbH. All rights reserved. 
+ * Copyright 2010 QTronic GmbH. All rights reserved.
  * -------------------------------------------------------------------------
  */
 
@@ -9,8 +9,92 @@
 #define fmusim_h
 
 #include "main.h"
+#include "solver.h"
+#include "counters.h"
+#include "sink.h"
+#include "input.h"
+#include "diagnostics.h"
 
-int fmuSimulate(FMU* fmu, double tEnd, double h,
-		fmiBoolean loggingOn, char separator);
+// tolerance of the step grid, as a fraction of h: a step ending closer than
+// this to a grid point counts as ending on it
+#define TICK_EPS 1e-6
+
+// a step is stretched by up to this fraction of h beyond its grid point to
+// end at a time event or the end time, instead of leaving a sliver step
+#define MERGE_EPS 0.01
+
+// State of one simulated instance of an FMU
+typedef struct {
+    FMU* fmu;                        // the fmu this is an instance of
+    fmiComponent c;                  // instance of the fmu
+    Method method;                   // integration method
+    double h;                        // fixed step size
+    double t0;                       // start time, steps end on the grid t0 + n*h
+    long n;                          // grid points reached, the next is t0 + (n+1)*h
+    double time;                     // current time
+    int nx;                          // number of state variables
+    int nz;                          // number of state event indicators
+    double *x;                       // continuous states
+    double *z;                       // state event indicators
+    double *prez;                    // previous values of state event indicators
+    double *work;                    // work array of the integration method
+    fmiEventInfo eventInfo;          // updated by calls to initialize and eventUpdate
+    fmiBoolean loggingOn;
+    fmiBoolean initialized;          // fmiInitialize has been called
+    fmiBoolean terminated;           // model requested termination
+    int nSteps;
+    int nTimeEvents;
+    int nStepEvents;
+    int nStateEvents;
+    long nDerivatives;               // number of derivative evaluations
+    Counters* counters;              // counts the phases of the steps, or NULL
+    Diagnostics* diagnostics;        // records the error of each step, or NULL
+} SimInstance;
+
+// Values of one base type saved by a snapshot
+typedef struct {
+    int n;
+    fmiValueReference* vr;           // value references, each once
+    void* values;                    // buffer for n values of the type
+} SnapshotValues;
+
+// Saved state of an instance, to roll back the simulation.
+// FMI 1.0 has no access to the internal state of an FMU. FMUs built with
+// fmuTemplate export it as an extension, which is used if available.
+// Otherwise, only the continuous states and the inputs are saved, the only
+// variables FMI 1.0 allows to set after initialization. This restores just
+// models that keep their whole state in their continuous states, so rolling
+// back and branching require simHasModelState. Strings are saved as
+// pointers, not copied.
+typedef struct {
+    double time;
+    long n;
+    double *x;
+    double *z;
+    fmiEventInfo eventInfo;
+    fmiBoolean terminated;
+    SnapshotValues reals;
+    SnapshotValues integers;
+    SnapshotValues booleans;
+    SnapshotValues strings;
+    void* modelState;                // internal state of the fmu, if exported
+    size_t modelStateSize;
+} SimSnapshot;
+
+int simInstantiate(SimInstance* s, FMU* fmu, const char* instanceName,
+        Method method, double h, fmiBoolean loggingOn);
+int simInitialize(SimInstance* s, double t0);
+int simDoStep(SimInstance* s, double tEnd);
+void simFree(SimInstance* s);
+
+int simHasModelState(FMU* fmu);
+SimSnapshot* simSnapshotNew(SimInstance* s);
+int simSave(SimInstance* s, SimSnapshot* snap);
+int simRestore(SimInstance* s, SimSnapshot* snap);
+void simSnapshotFree(SimSnapshot* snap);
+
+int fmuSimulate(FMU* fmu, double tEnd, double h, Method method,
+		fmiBoolean loggingOn, Sink* sinks, Inputs* inputs, int countersOn,
+		Diagnostics* diagnostics);
 
 #endif // fmusim_h
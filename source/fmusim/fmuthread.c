@@ -0,0 +1,176 @@
+/* -------------------------------------------------------------------------
+ * fmuthread.c
+ * Minimal portable threads and mutexes used to run FMU instances in parallel.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdlib.h>
+#include "fmuthread.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#ifndef _MSC_VER
+#include <unistd.h>
+#include <sched.h>
+#include <time.h>
+#endif
+
+// the function and argument passed to the native thread entry
+typedef struct {
+    ThreadFunction f;
+    void* arg;
+} ThreadStart;
+
+#ifdef _MSC_VER
+static DWORD WINAPI threadMain(LPVOID p) {
+#else
+static void* threadMain(void* p) {
+#endif
+    ThreadStart start = *(ThreadStart*)p;
+    free(p);
+    start.f(start.arg);
+    return 0;
+}
+
+// Returns 0 to indicate error
+int threadCreate(Thread* t, ThreadFunction f, void* arg) {
+    ThreadStart* start = (ThreadStart*)malloc(sizeof(ThreadStart));
+    if (!start) return 0; // error
+    start->f = f;
+    start->arg = arg;
+#ifdef _MSC_VER
+    *t = CreateThread(NULL, 0, threadMain, start, 0, NULL);
+    if (*t == NULL) {
+#else
+    if (pthread_create(t, NULL, threadMain, start)) {
+#endif
+        free(start);
+        return 0; // error
+    }
+    return 1; // success
+}
+
+void threadJoin(Thread t) {
+#ifdef _MSC_VER
+    WaitForSingleObject(t, INFINITE);
+    CloseHandle(t);
+#else
+    pthread_join(t, NULL);
+#endif
+}
+
+// number of processors available, at least 1
+int threadCount() {
+#ifdef _MSC_VER
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+// give up the processor to other threads
+void threadYield() {
+#ifdef _MSC_VER
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+// suspend the calling thread for ms milliseconds
+void threadSleep(int ms) {
+#ifdef _MSC_VER
+    Sleep(ms);
+#else
+    struct timespec t;
+    t.tv_sec = ms / 1000;
+    t.tv_nsec = (ms % 1000) * 1000000L;
+    nanosleep(&t, NULL);
+#endif
+}
+
+// seconds elapsed since an arbitrary fixed point, not affected by clock changes
+double wallClock() {
+#ifdef _MSC_VER
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (double)count.QuadPart / frequency.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec + 1e-9 * t.tv_nsec;
+#endif
+}
+
+// The atomic loads and stores are relaxed: they order no other memory
+// accesses, but a value is never seen half written.
+long long atomicLoad(AtomicCount* p) {
+#ifdef _MSC_VER
+    return InterlockedOr64((volatile LONG64*)p, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+#endif
+}
+
+void atomicStore(AtomicCount* p, long long value) {
+#ifdef _MSC_VER
+    InterlockedExchange64((volatile LONG64*)p, value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELAXED);
+#endif
+}
+
+char atomicLoadChar(char* p) {
+#ifdef _MSC_VER
+    return _InterlockedOr8(p, 0);
+#else
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+#endif
+}
+
+void atomicStoreChar(char* p, char value) {
+#ifdef _MSC_VER
+    _InterlockedExchange8(p, value);
+#else
+    __atomic_store_n(p, value, __ATOMIC_RELAXED);
+#endif
+}
+
+void mutexInit(Mutex* m) {
+#ifdef _MSC_VER
+    InitializeCriticalSection(m);
+#else
+    pthread_mutex_init(m, NULL);
+#endif
+}
+
+void mutexLock(Mutex* m) {
+#ifdef _MSC_VER
+    EnterCriticalSection(m);
+#else
+    pthread_mutex_lock(m);
+#endif
+}
+
+void mutexUnlock(Mutex* m) {
+#ifdef _MSC_VER
+    LeaveCriticalSection(m);
+#else
+    pthread_mutex_unlock(m);
+#endif
+}
+
+void mutexFree(Mutex* m) {
+#ifdef _MSC_VER
+    DeleteCriticalSection(m);
+#else
+    pthread_mutex_destroy(m);
+#endif
+}
@@ -0,0 +1,48 @@
+/* -------------------------------------------------------------------------
+ * fmuthread.h
+ * Minimal portable threads and mutexes used to run FMU instances in parallel.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef fmuthread_h
+#define fmuthread_h
+
+#ifdef _MSC_VER
+#include <windows.h>
+typedef HANDLE Thread;
+typedef CRITICAL_SECTION Mutex;
+#else
+#include <pthread.h>
+typedef pthread_t Thread;
+typedef pthread_mutex_t Mutex;
+#endif
+
+typedef void (*ThreadFunction)(void* arg);
+
+// a 64-bit value shared between threads, accessed with atomicLoad and
+// atomicStore only
+#ifdef _MSC_VER
+typedef long long AtomicCount;
+#else
+typedef long long AtomicCount __attribute__((aligned(8)));
+#endif
+
+int threadCreate(Thread* t, ThreadFunction f, void* arg);
+void threadJoin(Thread t);
+int threadCount();
+void threadYield();
+void threadSleep(int ms);
+double wallClock();
+
+long long atomicLoad(AtomicCount* p);
+void atomicStore(AtomicCount* p, long long value);
+char atomicLoadChar(char* p);
+void atomicStoreChar(char* p, char value);
+
+void mutexInit(Mutex* m);
+void mutexLock(Mutex* m);
+void mutexUnlock(Mutex* m);
+void mutexFree(Mutex* m);
+
+#endif // fmuthread_h
@@ -1,17 +1,11 @@
 #include "fmuzip.h"
 
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
-#include <malloc.h>
 
-#ifdef _MSC_VER
-#include <windows.h>
-#else
-#include <unistd.h>
-#endif
-
-#define UNZIP_CMD "7z x -aoa -o"
-#define BUFSIZE 4096
+#define UNZIP_PROGRAM "7z"
+#define UNZIP_ARGS " x -aoa -o"
 
 // return codes of the 7z command line tool
 #define SEVEN_ZIP_NO_ERROR 0 // success
@@ -21,111 +15,66 @@
 #define SEVEN_ZIP_OUT_OF_MEMORY 8
 #define SEVEN_ZIP_STOPPED_BY_USER 255
 
+// Returns the 7z command, in %FMUSDK_HOME%\bin if defined, to be freed by the caller.
+// The current directory is not changed, as files of other FMUs may be
+// unzipped or read by other threads at the same time.
+static char* getUnzipCmd() {
+    static int warned = 0;
+    const char* home = getenv("FMUSDK_HOME");
+    char* cmd;
+    if (!home) {
 #ifdef _MSC_VER
-int fmuUnzip(const char *zipPath, const char *outPath) {
-    int code;
-    char cwd[BUFSIZE];
-    char binPath[BUFSIZE];
-    int n = strlen(UNZIP_CMD) + strlen(outPath) + 1 +  strlen(zipPath) + 9;
-    char* cmd = (char*)calloc(sizeof(char), n);
-
-    // remember current directory
-    if (!GetCurrentDirectory(BUFSIZE, cwd)) {
-        printf ("error: Could not get current directory: %s\n", strerror(GetLastError()));
-        return 0; // error
-    }
-        
-    // change to %FMUSDK_HOME%\bin to find 7z.dll and 7z.exe
-    if (!GetEnvironmentVariable("FMUSDK_HOME", binPath, BUFSIZE)) {
-        if (GetLastError() == ERROR_ENVVAR_NOT_FOUND) {
-            printf ("error: Environment variable FMUSDK_HOME not defined.\n");
-        }
-        else {
-            printf ("error: Could not get value of FMUSDK_HOME: %s\n",strerror(GetLastError()));
-        }
-        return 0; // error       
+        printf ("error: Environment variable FMUSDK_HOME not defined.\n");
+        return NULL;
+#else
+        if (!warned++) printf ("warning: Could not get value of FMUSDK_HOME, assuming 7zip is in your path.\n");
+        return strdup(UNZIP_PROGRAM UNZIP_ARGS);
+#endif
     }
+    cmd = (char*)calloc(sizeof(char), strlen(home) + strlen(UNZIP_PROGRAM UNZIP_ARGS) + 8);
+    if (!cmd) return NULL;
 #if WINDOWS
-    strcat(binPath, "\\bin");
+    sprintf(cmd, "\"%s\\bin\\%s\"%s", home, UNZIP_PROGRAM, UNZIP_ARGS);
 #else
-    strcat(binPath, "/bin");
+    sprintf(cmd, "\"%s/bin/%s\"%s", home, UNZIP_PROGRAM, UNZIP_ARGS);
 #endif
-    if (!SetCurrentDirectory(binPath)) {
-        printf ("error: could not change to directory '%s': %s\n", binPath, strerror(GetLastError())); 
-        return 0; // error        
-    }
-   
-    // run the unzip command
-    // remove "> NUL" to see the unzip protocol
-    sprintf(cmd, "%s%s \"%s\" > NUL", UNZIP_CMD, outPath, zipPath); 
-    // printf("cmd='%s'\n", cmd);
-    code = system(cmd);
-    free(cmd);
-    if (code!=SEVEN_ZIP_NO_ERROR) {
-        switch (code) {
-            printf("7z: ");
-            case SEVEN_ZIP_WARNING:            printf("warning\n"); break;
-            case SEVEN_ZIP_ERROR:              printf("error\n"); break;
-            case SEVEN_ZIP_COMMAND_LINE_ERROR: printf("command line error\n"); break;
-            case SEVEN_ZIP_OUT_OF_MEMORY:      printf("out of memory\n"); break;
-            case SEVEN_ZIP_STOPPED_BY_USER:    printf("stopped by user\n"); break;
-            default: printf("unknown problem\n");
-        }
-    }
-    
-    // restore current directory
-    SetCurrentDirectory(cwd);
-    
-    return (code==SEVEN_ZIP_NO_ERROR || code==SEVEN_ZIP_WARNING) ? 1 : 0;  
+    return cmd;
 }
-#else
-int fmuUnzip(const char *zipPath, const char *outPath) {
+
+// Unzip the files of the zip file that match files, e.g. "a.xml" or
+// "-x!a.xml" for all but a.xml, or all files if files is NULL.
+// Returns 0 to indicate error
+int fmuUnzipFiles(const char *zipPath, const char *outPath, const char* files) {
     int code;
-    char cwd[BUFSIZE];
-    char binPath[BUFSIZE];
     int n;
     char* cmd;
+    char* unzipCmd = getUnzipCmd();
+    if (!unzipCmd) return 0; // error
 
-    // remember current directory
-    if (!getcwd(cwd, BUFSIZE)) {
-      printf ("error: Could not get current directory\n");
-      return 0; // error
-    }
-        
-    const char *FMUSDK_HOME = getenv("FMUSDK_HOME");
-    // change to %FMUSDK_HOME%\bin to find 7z.dll and 7z.exe
-    if (FMUSDK_HOME==NULL) {
-      printf ("warning: Could not get value of FMUSDK_HOME, assuming 7zip is in your path.\n");
-      FMUSDK_HOME = strdup("");
-    } else {
+    // run the unzip command
+    // remove the redirection to see the unzip protocol
+    n = strlen(unzipCmd) + strlen(outPath) + strlen(zipPath) + (files ? strlen(files) : 0) + 32;
+    cmd = (char*)calloc(sizeof(char), n);
 #if WINDOWS
-        strcat(binPath, "\\bin");
+    // cmd.exe strips the first and the last quote of a command that starts
+    // with a quote, so the whole command is quoted once more
+    sprintf(cmd, "\"%s%s \"%s\"", unzipCmd, outPath, zipPath);
 #else
-        strcat(binPath, "/bin");
+    sprintf(cmd, "%s%s \"%s\"", unzipCmd, outPath, zipPath);
 #endif
-	if (!chdir(binPath)) {
-	    printf ("error: could not change to directory '%s'\n", binPath);
-	    return 0; // error        
-	}
-    }
-   
-    // run the unzip command
+    if (files) sprintf(cmd + strlen(cmd), " \"%s\"", files);
 #if WINDOWS
-    n = strlen(UNZIP_CMD) + strlen(outPath) + 1 +  strlen(zipPath) + 9;
-    cmd = (char*)calloc(sizeof(char), n);
-    // remove "> NUL" to see the unzip protocol
-    sprintf(cmd, "%s%s \"%s\" > NUL", UNZIP_CMD, outPath, zipPath); 
+    strcat(cmd, " > NUL\"");
 #else
-    n = strlen(UNZIP_CMD) + strlen(outPath) + 1 +  strlen(zipPath) + 16;
-    cmd = (char*)calloc(sizeof(char), n);
-    sprintf(cmd, "%s%s \"%s\" > /dev/null", UNZIP_CMD, outPath, zipPath); 
+    strcat(cmd, " > /dev/null");
 #endif
+    free(unzipCmd);
     printf("cmd='%s'\n", cmd);
     code = system(cmd);
     free(cmd);
     if (code!=SEVEN_ZIP_NO_ERROR) {
+        printf("7z: ");
         switch (code) {
-            printf("7z: ");
             case SEVEN_ZIP_WARNING:            printf("warning\n"); break;
             case SEVEN_ZIP_ERROR:              printf("error\n"); break;
             case SEVEN_ZIP_COMMAND_LINE_ERROR: printf("command line error\n"); break;
@@ -134,10 +83,10 @@ int fmuUnzip(const char *zipPath, const char *outPath) {
             default: printf("unknown problem\n");
         }
     }
-    
-    // restore current directory
-    chdir(cwd);
-    
-    return (code==SEVEN_ZIP_NO_ERROR || code==SEVEN_ZIP_WARNING) ? 1 : 0;  
+    return (code==SEVEN_ZIP_NO_ERROR || code==SEVEN_ZIP_WARNING) ? 1 : 0;
+}
+
+// Unzip all files of the zip file. Returns 0 to indicate error
+int fmuUnzip(const char *zipPath, const char *outPath) {
+    return fmuUnzipFiles(zipPath, outPath, NULL);
 }
-#endif
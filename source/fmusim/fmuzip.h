@@ -9,5 +9,6 @@
 #define zip_h
 
 int fmuUnzip(const char *zipPath, const char *outPath);
+int fmuUnzipFiles(const char *zipPath, const char *outPath, const char* files);
 
 #endif // zip_h
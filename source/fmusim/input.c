@@ -0,0 +1,106 @@
+/* -------------------------------------------------------------------------
+ * input.c
+ * Input variables of a simulation, set from a table of measured data.
+ * An input file is a CSV file with a column named time and a column for
+ * each Real input variable of the model, named as the variable. Columns are
+ * separated by the CSV separator of the run, and if that is not ',', a ','
+ * may be used as decimal point, as in the result file. The times must not
+ * decrease. Between rows the inputs are interpolated linearly; before the
+ * first and after the last row they are held constant. At a time given in
+ * two rows the inputs jump, and the second row applies from that time on.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "input.h"
+#include "fmuio.h"
+#include "fmuthread.h"
+
+// Returns 0 to indicate error
+static int findInputs(Inputs* in, ModelDescription* md) {
+    CsvTable* t = in->table;
+    ScalarVariable* sv;
+    long i;
+    int k;
+    in->time = csvColumn(t, "time");
+    if (in->time < 0) return fmuError("error: Input file has no column time");
+    for (i=1; i<t->nRows; i++) {
+        if (t->columns[in->time][i] < t->columns[in->time][i-1]) {
+            printf("error: Time decreases in row %ld of the input file\n", i + 1);
+            return 0;
+        }
+    }
+    in->vr = (fmiValueReference*)calloc(t->nColumns, sizeof(fmiValueReference));
+    in->columns = (int*)calloc(t->nColumns, sizeof(int));
+    in->values = (fmiReal*)calloc(t->nColumns, sizeof(fmiReal));
+    if (!in->vr || !in->columns || !in->values) return fmuError("out of memory");
+    for (k=0; k<t->nColumns; k++) {
+        if (k == in->time) continue;
+        sv = getVariableByName(md, t->names[k]);
+        if (!sv) {
+            printf("error: Input variable %s not found\n", t->names[k]);
+            return 0;
+        }
+        if (sv->typeSpec->type != elm_Real || getCausality(sv) != enu_input) {
+            printf("error: Variable %s is not a Real input\n", t->names[k]);
+            return 0;
+        }
+        in->vr[in->nInputs] = getValueReference(sv);
+        in->columns[in->nInputs++] = k;
+    }
+    return 1; // success
+}
+
+// Read the input file at path for the given model.
+// Returns NULL to indicate error
+Inputs* inputsLoad(const char* path, ModelDescription* md, char separator) {
+    Inputs* in = (Inputs*)calloc(1, sizeof(Inputs));
+    if (!in) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    in->table = csvRead(path, separator, threadCount());
+    if (!in->table || !findInputs(in, md)) {
+        inputsFree(in);
+        return NULL;
+    }
+    if (in->table->nRows == 0) {
+        printf("error: Input file %s has no rows\n", path);
+        inputsFree(in);
+        return NULL;
+    }
+    return in;
+}
+
+// Set the inputs of the instance c to their values at the given time.
+// Returns 0 to indicate error
+int inputsApply(Inputs* in, FMU* fmu, fmiComponent c, double time) {
+    CsvTable* t = in->table;
+    double* times = t->columns[in->time];
+    double w = 0;
+    long i;
+    int k;
+    if (in->nInputs == 0) return 1;
+    if (time < times[in->row]) in->row = 0;
+    while (in->row + 1 < t->nRows && times[in->row + 1] <= time) in->row++;
+    i = in->row;
+    if (i + 1 < t->nRows && time > times[i]) w = (time - times[i]) / (times[i+1] - times[i]);
+    for (k=0; k<in->nInputs; k++) {
+        double* v = t->columns[in->columns[k]];
+        in->values[k] = w > 0 ? v[i] + w * (v[i+1] - v[i]) : v[i];
+    }
+    if (fmu->setReal(c, in->vr, in->nInputs, in->values) > fmiWarning)
+        return fmuError("could not set the inputs");
+    return 1; // success
+}
+
+void inputsFree(Inputs* in) {
+    if (in->table) csvFree(in->table);
+    if (in->vr) free(in->vr);
+    if (in->columns) free(in->columns);
+    if (in->values) free(in->values);
+    free(in);
+}
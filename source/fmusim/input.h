@@ -0,0 +1,28 @@
+/* -------------------------------------------------------------------------
+ * input.h
+ * Input variables of a simulation, set from a table of measured data
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef input_h
+#define input_h
+
+#include "main.h"
+#include "csvtable.h"
+
+typedef struct {
+    CsvTable* table;
+    int time;                        // column of the time
+    int nInputs;
+    fmiValueReference* vr;           // the Real inputs set
+    int* columns;                    // column of each input
+    fmiReal* values;                 // values at the current time
+    long row;                        // last row at or before the current time
+} Inputs;
+
+Inputs* inputsLoad(const char* path, ModelDescription* md, char separator);
+int inputsApply(Inputs* in, FMU* fmu, fmiComponent c, double time);
+void inputsFree(Inputs* in);
+
+#endif // input_h
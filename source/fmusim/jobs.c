@@ -0,0 +1,384 @@
+/* -------------------------------------------------------------------------
+ * jobs.c
+ * Simulation of the jobs of a job file on a few worker threads in one
+ * process, e.g. of a regression suite of many different FMUs.
+ * A job file lists one job per line:
+ *   # comment
+ *   <path to fmu> <result file> [<option> <value> ...] [<name>=<value> ...]
+ * with the options -tEnd, -h and -method, which default to the values of
+ * the command line, and start or parameter values of variables given by
+ * name. Paths are relative to the job file. Each job writes its result
+ * to its own CSV file, as a single simulation would.
+ * The FMUs are loaded when first needed, once for all jobs that name the
+ * same path, and freed after the last of these jobs. Loading is done by
+ * one worker at a time, as the parser of the model description is not
+ * reentrant. A worker takes the next job of the file when it is done
+ * with its last one. A job that fails, e.g. as its FMU cannot be loaded
+ * or a step fails, is reported and does not affect the other jobs.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "jobs.h"
+#include "fmuinit.h"
+#include "fmuio.h"
+#include "fmuthread.h"
+
+#define BUFSIZE 4096
+
+typedef enum {
+    modelUnloaded, modelLoaded, modelFailed, modelFreed
+} ModelState;
+
+// an FMU named by one or more jobs
+typedef struct {
+    char* path;
+    FMU fmu;
+    ModelState state;
+    int nJobs;                       // number of jobs not finished
+} JobModel;
+
+typedef struct {
+    int line;                        // in the job file
+    JobModel* model;
+    char* resultPath;
+    double tEnd;
+    double h;
+    Method method;
+    int nValues;
+    char** names;                    // of the variables to set
+    char** values;                   // as given in the job file
+    int ok;                          // 1 if the job succeeded
+    int nSteps;
+    double seconds;                  // wall time of the job, including loading
+} Job;
+
+typedef struct {
+    Job* jobs;
+    int nJobs;
+    JobModel** models;
+    int nModels;
+    int nLoaded;                     // number of models loaded so far
+    int next;                        // index of the next job to run
+    fmiBoolean loggingOn;
+    char separator;
+    Mutex mutex;                     // protects next
+    Mutex loadMutex;                 // protects the models and nLoaded
+} JobRun;
+
+// -------------------------------------------------------------------------
+// Reading the job file
+
+// Returns the model of the given path, added if new, or NULL to indicate error
+static JobModel* getModel(JobRun* r, char* path) {
+    int i;
+    JobModel* m;
+    JobModel** models;
+    for (i=0; i<r->nModels; i++) {
+        if (!strcmp(r->models[i]->path, path)) {
+            free(path);
+            return r->models[i];
+        }
+    }
+    m = (JobModel*)calloc(1, sizeof(JobModel));
+    models = (JobModel**)realloc(r->models, (r->nModels + 1) * sizeof(JobModel*));
+    if (!m || !models) {
+        if (m) free(m);
+        free(path);
+        fmuError("out of memory");
+        return NULL;
+    }
+    r->models = models;
+    r->models[r->nModels++] = m;
+    m->path = path;
+    return m;
+}
+
+// Parse the tokens of a line into the job.
+// Returns 0 to indicate error
+static int parseJob(JobRun* r, const char* jobFileName, Job* job, char** tokens, int n) {
+    int i;
+    char* path;
+    char* equals;
+    if (n < 2) return 0;
+    path = resolvePath(jobFileName, tokens[0]);
+    job->resultPath = resolvePath(jobFileName, tokens[1]);
+    if (!path || !job->resultPath || !(job->model = getModel(r, path))) return 0;
+    job->model->nJobs++;
+    job->names = (char**)calloc(n, sizeof(char*));
+    job->values = (char**)calloc(n, sizeof(char*));
+    if (!job->names || !job->values) return fmuError("out of memory");
+    for (i=2; i<n; i++) {
+        if (tokens[i][0] == '-' && i+1 < n) {
+            if (!strcmp(tokens[i], "-tEnd")) {
+                if (sscanf(tokens[++i], "%lf", &job->tEnd) != 1) return 0;
+            }
+            else if (!strcmp(tokens[i], "-h")) {
+                if (sscanf(tokens[++i], "%lf", &job->h) != 1 || job->h <= 0) return 0;
+            }
+            else if (!strcmp(tokens[i], "-method")) {
+                int m = getMethod(tokens[++i]);
+                if (m == -1) return 0;
+                job->method = (Method)m;
+            }
+            else return 0;
+        }
+        else if ((equals = strchr(tokens[i], '=')) && equals > tokens[i]) {
+            *equals = '\0';
+            job->names[job->nValues] = strdup(tokens[i]);
+            job->values[job->nValues] = strdup(equals + 1);
+            if (!job->names[job->nValues] || !job->values[job->nValues++])
+                return fmuError("out of memory");
+        }
+        else return 0;
+    }
+    return 1; // success
+}
+
+// Read the jobs of the job file into r, with the given defaults.
+// Returns 0 to indicate error
+static int readJobs(JobRun* r, const char* jobFileName, double tEnd, double h, Method method) {
+    char line[BUFSIZE];
+    char* tokens[BUFSIZE / 2];
+    char* token;
+    Job* jobs;
+    int n, ok = 1;
+    int lineNumber = 0;
+    FILE* file = fopen(jobFileName, "r");
+    if (!file) {
+        printf("error: Could not open job file %s\n", jobFileName);
+        return 0;
+    }
+    while (ok && fgets(line, BUFSIZE, file)) {
+        lineNumber++;
+        for (n=0, token=strtok(line, " \t\r\n"); token; token=strtok(NULL, " \t\r\n"))
+            tokens[n++] = token;
+        if (n == 0 || tokens[0][0] == '#') continue;
+        jobs = (Job*)realloc(r->jobs, (r->nJobs + 1) * sizeof(Job));
+        if (!jobs) {
+            ok = fmuError("out of memory");
+            break;
+        }
+        r->jobs = jobs;
+        memset(&jobs[r->nJobs], 0, sizeof(Job));
+        jobs[r->nJobs].line = lineNumber;
+        jobs[r->nJobs].tEnd = tEnd;
+        jobs[r->nJobs].h = h;
+        jobs[r->nJobs].method = method;
+        ok = parseJob(r, jobFileName, &jobs[r->nJobs++], tokens, n);
+        if (!ok) printf("error: Syntax error in %s at line %d\n", jobFileName, lineNumber);
+    }
+    fclose(file);
+    if (ok && r->nJobs == 0) {
+        printf("error: No job in job file %s\n", jobFileName);
+        ok = 0;
+    }
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Running the jobs
+
+// Set the variables of the job in the instantiated model c.
+// Returns 0 to indicate error
+static int setValues(Job* job, FMU* fmu, fmiComponent c) {
+    int k, ok;
+    fmiStatus status;
+    fmiReal r;
+    fmiInteger i;
+    fmiBoolean b;
+    fmiString s;
+    for (k=0; k<job->nValues; k++) {
+        const char* value = job->values[k];
+        ScalarVariable* sv = getVariableByName(fmu->modelDescription, job->names[k]);
+        fmiValueReference vr;
+        if (!sv) {
+            printf("error: Variable %s of the job at line %d not found\n", job->names[k], job->line);
+            return 0;
+        }
+        vr = getValueReference(sv);
+        status = fmiOK;
+        switch (sv->typeSpec->type) {
+            case elm_Real:
+                ok = sscanf(value, "%lf", &r) == 1;
+                if (ok) status = fmu->setReal(c, &vr, 1, &r);
+                break;
+            case elm_Boolean:
+                b = !strcmp(value, "true") || !strcmp(value, "1");
+                ok = b || !strcmp(value, "false") || !strcmp(value, "0");
+                if (ok) status = fmu->setBoolean(c, &vr, 1, &b);
+                break;
+            case elm_String:
+                s = value;
+                ok = 1;
+                status = fmu->setString(c, &vr, 1, &s);
+                break;
+            default:
+                ok = sscanf(value, "%d", &i) == 1;
+                if (ok) status = fmu->setInteger(c, &vr, 1, &i);
+                break;
+        }
+        if (!ok) {
+            printf("error: Invalid value %s of %s in the job at line %d\n", value, job->names[k], job->line);
+            return 0;
+        }
+        if (status > fmiWarning) {
+            printf("error: Could not set %s of the job at line %d\n", job->names[k], job->line);
+            return 0;
+        }
+    }
+    return 1; // success
+}
+
+// Simulate the job with its loaded model, writing the result file.
+// Returns 0 to indicate error
+static int simulateJob(JobRun* r, Job* job) {
+    SimInstance sim;
+    Output* output;
+    Sink* sink;
+    int ok;
+    FMU* fmu = &job->model->fmu;
+    const char* modelId = getModelIdentifier(fmu->modelDescription);
+    char* name = (char*)calloc(strlen(modelId) + 12, sizeof(char));
+    if (!name) return fmuError("out of memory");
+    sprintf(name, "%s_%d", modelId, job->line);
+    sink = csvSink(job->resultPath, r->separator);
+    output = sink ? outputOpen(fmu, sink) : NULL;
+    if (!output) {
+        free(name);
+        return fmuError("could not open the result file");
+    }
+    memset(&sim, 0, sizeof(SimInstance));
+    ok = simInstantiate(&sim, fmu, name, job->method, job->h, r->loggingOn)
+            && setValues(job, fmu, sim.c)
+            && simInitialize(&sim, 0)
+            && outputSample(output, sim.c, 0);
+    while (ok && sim.time < job->tEnd && !sim.terminated) {
+        ok = simDoStep(&sim, job->tEnd)
+                && (sim.terminated || outputSample(output, sim.c, sim.time));
+    }
+    // the result file of a failed job is removed
+    if (ok) ok = outputClose(output);
+    else outputAbort(output);
+    job->nSteps = sim.nSteps;
+    simFree(&sim);
+    free(name);
+    return ok;
+}
+
+// Run the job, loading its model first if needed, and free the model
+// after its last job
+static void runJob(JobRun* r, Job* job) {
+    JobModel* m = job->model;
+    double start = wallClock();
+    mutexLock(&r->loadMutex);
+    if (m->state == modelUnloaded) {
+        m->state = fmuLoad(m->path, &m->fmu) ? modelLoaded : modelFailed;
+        if (m->state == modelLoaded) r->nLoaded++;
+    }
+    mutexUnlock(&r->loadMutex);
+    job->ok = m->state == modelLoaded && simulateJob(r, job);
+    mutexLock(&r->loadMutex);
+    if (--m->nJobs == 0 && m->state == modelLoaded) {
+        fmuFree(&m->fmu);
+        m->state = modelFreed;
+    }
+    mutexUnlock(&r->loadMutex);
+    job->seconds = wallClock() - start;
+    if (!job->ok) printf("error: The job at line %d failed\n", job->line);
+}
+
+static void workerMain(void* arg) {
+    JobRun* r = (JobRun*)arg;
+    int i;
+    for (;;) {
+        mutexLock(&r->mutex);
+        i = r->next++;
+        mutexUnlock(&r->mutex);
+        if (i >= r->nJobs) return;
+        runJob(r, &r->jobs[i]);
+    }
+}
+
+static void freeJobs(JobRun* r) {
+    int i, k;
+    for (i=0; i<r->nJobs; i++) {
+        Job* job = &r->jobs[i];
+        for (k=0; k<job->nValues; k++) {
+            free(job->names[k]);
+            free(job->values[k]);
+        }
+        if (job->names) free(job->names);
+        if (job->values) free(job->values);
+        if (job->resultPath) free(job->resultPath);
+    }
+    for (i=0; i<r->nModels; i++) {
+        free(r->models[i]->path);
+        free(r->models[i]);
+    }
+    if (r->jobs) free(r->jobs);
+    if (r->models) free(r->models);
+}
+
+// -------------------------------------------------------------------------
+// Entry function
+
+// run the jobs of the job file on nThreads worker threads. tEnd, h and
+// method apply to jobs that do not give their own. The jobs that failed
+// are listed in the summary.
+// Returns 0 to indicate error, including the failure of a job
+int fmuRunJobs(const char* jobFileName, double tEnd, double h, Method method,
+        int nThreads, fmiBoolean loggingOn, char separator) {
+    JobRun r;
+    Thread* threads;
+    int i, nFailed = 0, nStarted = 0;
+    double steps = 0, seconds = 0;
+    double start = wallClock();
+
+    memset(&r, 0, sizeof(JobRun));
+    r.loggingOn = loggingOn;
+    r.separator = separator;
+    if (!readJobs(&r, jobFileName, tEnd, h, method)) {
+        freeJobs(&r);
+        return 0;
+    }
+    if (nThreads > r.nJobs) nThreads = r.nJobs;
+    threads = (Thread*)calloc(nThreads, sizeof(Thread));
+    if (!threads) return fmuError("out of memory");
+    mutexInit(&r.mutex);
+    mutexInit(&r.loadMutex);
+
+    // run the workers, the main thread is one of them
+    for (i=1; i<nThreads; i++) {
+        if (!threadCreate(&threads[i], workerMain, &r)) break;
+        nStarted++;
+    }
+    workerMain(&r);
+    for (i=1; i<=nStarted; i++) threadJoin(threads[i]);
+    mutexFree(&r.mutex);
+    mutexFree(&r.loadMutex);
+    free(threads);
+
+    // print summary
+    for (i=0; i<r.nJobs; i++) {
+        if (!r.jobs[i].ok) nFailed++;
+        steps += r.jobs[i].nSteps;
+        seconds += r.jobs[i].seconds;
+    }
+    printf("Jobs of '%s' terminated %s\n", jobFileName, nFailed ? "with errors" : "successful");
+    printf("  jobs ............. %d\n", r.nJobs);
+    printf("  failed jobs ...... %d\n", nFailed);
+    printf("  fmus loaded ...... %d of %d\n", r.nLoaded, r.nModels);
+    printf("  worker threads ... %d\n", nStarted + 1);
+    printf("  steps ............ %.0f\n", steps);
+    printf("  job seconds ...... %.3f\n", seconds);
+    printf("  wall seconds ..... %.3f\n", wallClock() - start);
+    for (i=0; i<r.nJobs; i++) {
+        if (!r.jobs[i].ok) printf("  failed at line %d: %s\n", r.jobs[i].line, r.jobs[i].model->path);
+    }
+    freeJobs(&r);
+    return nFailed == 0;
+}
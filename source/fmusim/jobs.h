@@ -0,0 +1,19 @@
+/* -------------------------------------------------------------------------
+ * jobs.h
+ * Simulation of the jobs of a job file, each simulating one FMU, on a
+ * few worker threads in one process
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef jobs_h
+#define jobs_h
+
+#include "fmusim.h"
+
+#define JOBS_SUFFIX ".jobs"
+
+int fmuRunJobs(const char* jobFileName, double tEnd, double h, Method method,
+        int nThreads, fmiBoolean loggingOn, char separator);
+
+#endif // jobs_h
@@ -0,0 +1,176 @@
+/* -------------------------------------------------------------------------
+ * journal.c
+ * Journal of the finished cases of an ensemble run, to resume the run
+ * after an interruption.
+ * The journal is a text file, written by appending only. Its first line
+ * identifies the run, each following line gives the id of a finished case
+ * and the location of its row in the result file:
+ *   fmusim journal <guid> <number of cases> <tEnd> <h> <method> <sweep hash>
+ *   <case id> <offset> <length>
+ * The sweep hash is the hash of the sweep, see sweep.c, 0 without sweep.
+ * A run resumes a journal only if all of its first line matches.
+ * Entries are committed in batches: the result file is synced first, then
+ * the entries are appended to the journal and the journal is synced. Hence
+ * every journaled row is on disk, and a crash loses at most the cases of
+ * one batch. A line cut short by a crash lacks the final newline and is
+ * ignored. When resuming, the result file is truncated after the last
+ * journaled row, which removes rows of cases that will run again.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "journal.h"
+#include "fmuio.h"
+
+#ifdef _MSC_VER
+#include <io.h>
+#define fsync _commit
+#define ftruncate _chsize
+#define fileno _fileno
+#else
+#include <unistd.h>
+#endif
+
+#define BUFSIZE 4096
+
+// Read the entries of an existing journal into j.
+// Returns 0 to indicate error
+static int readJournal(Journal* j, FILE* file, const char* path, const char* guid,
+        double tEnd, double h, const char* method, unsigned long sweepHash) {
+    char line[BUFSIZE];
+    char journalGuid[BUFSIZE];
+    char journalMethod[BUFSIZE];
+    int n, id;
+    long offset, length;
+    double journalTEnd, journalH;
+    unsigned long journalHash;
+    if (!fgets(line, BUFSIZE, file)) return 1; // empty journal
+    if (sscanf(line, "fmusim journal %s %d %lf %lf %s %lx", journalGuid, &n, &journalTEnd,
+                &journalH, journalMethod, &journalHash) != 6
+            || strcmp(journalGuid, guid) || n != j->nCases || journalTEnd != tEnd
+            || journalH != h || strcmp(journalMethod, method) || journalHash != sweepHash) {
+        printf("error: Journal %s belongs to another run\n", path);
+        return 0;
+    }
+    while (fgets(line, BUFSIZE, file)) {
+        if (line[strlen(line) - 1] != '\n') break; // cut short by a crash
+        if (sscanf(line, "%d %ld %ld", &id, &offset, &length) != 3
+                || id < 0 || id >= j->nCases) {
+            printf("error: Invalid entry in journal %s: %s", path, line);
+            return 0;
+        }
+        if (!j->done[id]) j->nDone++;
+        j->done[id] = 1;
+        if (offset + length > j->resultSize) j->resultSize = offset + length;
+    }
+    return 1; // success
+}
+
+// Open the journal at path for a run of nCases cases of the fmu with the given
+// guid up to tEnd with step size h, the given method and the sweep with the
+// given hash. If the journal exists, the cases recorded there are marked as
+// done. Returns NULL to indicate error
+Journal* journalOpen(const char* path, const char* guid, int nCases, double tEnd,
+        double h, const char* method, unsigned long sweepHash) {
+    int ok = 1;
+    int newLine = 0;
+    int c = EOF;
+    Journal* j = (Journal*)calloc(1, sizeof(Journal));
+    FILE* file;
+    if (!j || !(j->done = (char*)calloc(nCases, sizeof(char)))) {
+        if (j) free(j);
+        fmuError("out of memory");
+        return NULL;
+    }
+    j->nCases = nCases;
+    file = fopen(path, "r");
+    if (file) {
+        ok = readJournal(j, file, path, guid, tEnd, h, method, sweepHash);
+        if (ok && fseek(file, -1, SEEK_END) == 0) {
+            c = fgetc(file);
+            newLine = c != '\n'; // terminate a line cut short
+        }
+        fclose(file);
+    }
+    if (ok && !(j->file = fopen(path, "a"))) {
+        printf("error: Could not open journal %s\n", path);
+        ok = 0;
+    }
+    if (!ok) {
+        free(j->done);
+        free(j);
+        return NULL;
+    }
+    if (newLine) fprintf(j->file, "\n");
+    if (c == EOF) fprintf(j->file, "fmusim journal %s %d %.17g %.17g %s %lx\n",
+            guid, nCases, tEnd, h, method, sweepHash);
+    fflush(j->file);
+    j->lastCommit = time(NULL);
+    return j;
+}
+
+// Open the result file of the run: a new file, if no case is done yet,
+// otherwise the existing file without rows beyond the last journaled one.
+// Returns NULL to indicate error
+FILE* journalOpenResult(Journal* j, const char* path) {
+    FILE* file;
+    if (j->nDone == 0) return fopen(path, "w");
+    file = fopen(path, "r+");
+    if (!file) {
+        printf("error: Result file %s of journaled cases not found\n", path);
+        return NULL;
+    }
+    fflush(file);
+    if (ftruncate(fileno(file), j->resultSize) != 0 || fseek(file, 0, SEEK_END) != 0) {
+        printf("error: Could not truncate result file %s\n", path);
+        fclose(file);
+        return NULL;
+    }
+    return file;
+}
+
+// Record that case id is finished and its result row is at the given
+// location of the result file. The entry is pending until the next commit.
+void journalAdd(Journal* j, int id, long offset, long length) {
+    JournalEntry* e = &j->pending[j->nPending++];
+    e->id = id;
+    e->offset = offset;
+    e->length = length;
+}
+
+// Returns 1 when the batch is full or the last commit is JOURNAL_INTERVAL
+// seconds ago, i.e. when the pending entries must be committed.
+int journalDue(Journal* j) {
+    return j->nPending == JOURNAL_BATCH || time(NULL) - j->lastCommit >= JOURNAL_INTERVAL;
+}
+
+// Sync the result file, then append the pending entries to the journal
+// and sync it. Returns 0 to indicate error
+int journalCommit(Journal* j, FILE* result) {
+    int i;
+    j->lastCommit = time(NULL);
+    if (j->nPending == 0) return 1;
+    if (fflush(result) != 0 || fsync(fileno(result)) != 0)
+        return fmuError("could not sync result file");
+    for (i=0; i<j->nPending; i++) {
+        JournalEntry* e = &j->pending[i];
+        fprintf(j->file, "%d %ld %ld\n", e->id, e->offset, e->length);
+    }
+    j->nPending = 0;
+    j->nCommits++;
+    if (fflush(j->file) != 0 || fsync(fileno(j->file)) != 0)
+        return fmuError("could not sync journal");
+    return 1; // success
+}
+
+// Commit the pending entries and close the journal.
+// Returns 0 to indicate error
+int journalClose(Journal* j, FILE* result) {
+    int ok = journalCommit(j, result);
+    fclose(j->file);
+    free(j->done);
+    free(j);
+    return ok;
+}
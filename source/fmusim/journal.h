@@ -0,0 +1,45 @@
+/* -------------------------------------------------------------------------
+ * journal.h
+ * Journal of the finished cases of an ensemble run, to resume the run
+ * after an interruption.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef journal_h
+#define journal_h
+
+#include <stdio.h>
+#include <time.h>
+
+#define JOURNAL_BATCH 256            // maximum number of uncommitted entries
+#define JOURNAL_INTERVAL 1           // maximum seconds between commits
+
+// location of the result row of a finished case
+typedef struct {
+    int id;                          // case id
+    long offset;                     // of the row in the result file
+    long length;                     // of the row in bytes
+} JournalEntry;
+
+typedef struct {
+    FILE* file;                      // journal, opened for appending
+    char* done;                      // 1 for each case finished in an earlier run
+    int nCases;
+    int nDone;                       // number of cases finished in earlier runs
+    long resultSize;                 // end of the last journaled result row
+    JournalEntry pending[JOURNAL_BATCH]; // entries not yet committed
+    int nPending;
+    time_t lastCommit;
+    int nCommits;
+} Journal;
+
+Journal* journalOpen(const char* path, const char* guid, int nCases, double tEnd,
+        double h, const char* method, unsigned long sweepHash);
+FILE* journalOpenResult(Journal* j, const char* path);
+void journalAdd(Journal* j, int id, long offset, long length);
+int journalDue(Journal* j);
+int journalCommit(Journal* j, FILE* result);
+int journalClose(Journal* j, FILE* result);
+
+#endif // journal_h
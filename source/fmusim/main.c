@@ -1,17 +1,21 @@
 /* ------------------------------------------------------------------------- 
  * main.c
- * Implements simulation of a single FMU instance using the forward Euler
- * method for numerical integration.
+ * Implements simulation of FMUs using the forward Euler, Heun or Runge-Kutta
+ * method with a fixed step size for numerical integration.
  * Command syntax: see printHelp()
- * Simulates the given FMU from t = 0 .. tEnd with fixed step size h and 
- * writes the computed solution to file 'result.csv'.
+ * Simulates the given FMU from t = 0 .. tEnd with step size h and 
+ * writes the computed solution to file 'result.csv'. Without h, the method
+ * and step size are taken from the profile written by the tuner, see tune.c.
+ * The FMU may also be simulated as an ensemble of many instances on worker
+ * threads, see fmusched.c. Instead of an FMU, the simulator accepts a
+ * system of connected FMUs, see cosim.c, or a job file listing independent
+ * simulations, see jobs.c.
  * The CSV file (comma-separated values) may e.g. be plotted using 
  * OpenOffice Calc or Microsoft Excel. 
  * This progamm demonstrates basic use of an FMU.
- * Real applications may use advanced numerical solvers instead, means to 
- * exactly locate state events in time, graphical plotting utilities, support 
- * for coexecution of many FMUs, stepping and debug support, user control
- * of parameter and start values etc. 
+ * Real applications may use adaptive and implicit numerical solvers instead,
+ * means to exactly locate state events in time, graphical plotting utilities,
+ * stepping and debug support etc. 
  * All this is missing here.
  * Free libraries and tools used to implement this simulator:
  *  - eXpat 2.0.1 XML parser, see http://expat.sourceforge.net
@@ -23,86 +27,277 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include "main.h"
+#include "fmuinit.h"
+#include "fmusim.h"
+#include "fmuzip.h"
+#include "tune.h"
+#include "fmusched.h"
+#include "fmuthread.h"
+#include "cosim.h"
+#include "stop.h"
+#include "precision.h"
+#include "trace.h"
+#include "jobs.h"
+#include "diagnostics.h"
+#include "activity.h"
 
-#ifndef _MSC_VER
-#include <sys/stat.h>
-#endif
-
-#define XML_FILE  "modelDescription.xml"
-#if WINDOWS
-#define DLL_DIR   "binaries\\win32\\"
-#define DLL_SUFFIX ".dll"
-#else
-#define DLL_DIR   "binaries/linux32/"
-#define DLL_SUFFIX ".so"
-#include <unistd.h>
-#endif
-#define BUFSIZE 4096
+#define PROFILE_SUFFIX ".tune"
+#define RESULT_FILE "result.csv"
 
 FMU fmu; // the fmu to simulate
 
-#ifdef _MSC_VER
-// fmuFileName is an absolute path, e.g. "C:\test\a.fmu"
-// or relative to the current dir, e.g. "..\test\a.fmu"
-static char* getFmuPath(const char* fmuFileName){
-    OFSTRUCT fileInfo;
-    if (HFILE_ERROR==OpenFile(fmuFileName, &fileInfo, OF_EXIST)) {
-        printf ("error: Could not open FMU '%s': %s\n", fmuFileName, strerror(GetLastError()));
-        return NULL;
-    }
-    //printf ("full path to FMU: '%s'\n", fileInfo.szPathName); 
-    return strdup(fileInfo.szPathName);
-}
-static char* getTmpPath() {
-    char tmpPath[BUFSIZE];
-    if(! GetTempPath(BUFSIZE, tmpPath)) {
-        printf ("error: Could not find temporary disk space: %d\n", strerror(GetLastError()));
-        return NULL;
-    }
-    strcat(tmpPath, "fmu\\");
-    return strdup(tmpPath);
-}
-#else
-// fmuFileName is an absolute path, e.g. "C:\test\a.fmu"
-// or relative to the current dir, e.g. "..\test\a.fmu"
-static char* getFmuPath(const char* fmuFileName){
-  /* Not sure why this is useful.  Just returning the filename. */
-  return strdup(fmuFileName);
-}
-static char* getTmpPath() {
-  char *tmp = mkdtemp(strdup("fmuTmpXXXXXX"));
-  if (tmp==NULL) {
-    fprintf(stderr, "Couldn't create temporary directory\n");
-    exit(1);
-  }
-  /* return strdup(tmp); */
-  return strcat(tmp, "/");
-}
-#endif
-
 static void printHelp(const char* fmusim) {
-    printf("command syntax: %s <model.fmu> <tEnd> <h> <loggingOn> <csv separator>\n", fmusim);
-    printf("   <model.fmu> .... path to FMU, relative to current dir or absolute, required\n");
+    printf("command syntax: %s <options> <model.fmu> <tEnd> <h> <loggingOn> <csv separator>\n", fmusim);
+    printf("   <model.fmu> .... path to FMU, relative to current dir or absolute, required,\n");
+    printf("                    or path to a system file <name>%s connecting several FMUs,\n", SYSTEM_SUFFIX);
+    printf("                    or path to a job file <name>%s listing simulations of FMUs\n", JOBS_SUFFIX);
+    printf("                    to run on <threads> threads, see jobs.c\n");
     printf("   <tEnd> ......... end  time of simulation, optional, defaults to 1.0 sec\n");
     printf("   <h> ............ step size of simulation, optional, defaults to 0.1 sec\n");
     printf("   <loggingOn> .... 1 to activate logging,   optional, defaults to 0\n");
     printf("   <csv separator>. column separator char in csv file, optional, defaults to ';'\n");
+    printf("options, each optional:\n");
+    printf("   -method <name> . integration method euler, heun or rk4, defaults to euler\n");
+    printf("   -tune <tol> .... select method and step size for tolerance tol and save\n");
+    printf("                    them in the profile <model>%s, which is used by later\n", PROFILE_SUFFIX);
+    printf("                    runs that do not specify <h>\n");
+    printf("   -precision ..... measure error against cost of all methods and step sizes,\n");
+    printf("                    using the analytic solution of the model, see %s\n", WP_FILE);
+    printf("   -counters ...... report hardware counters of the simulation phases\n");
+    printf("   -diag <file> ... write the estimated error of each step to the CSV file, and\n");
+    printf("                    rank the states and event indicators that limit the step size,\n");
+    printf("                    for the tolerance of -tune or the profile, else %g\n", DIAG_TOLERANCE);
+    printf("   -activity <file> write how often and how fast each result column changes\n");
+    printf("                    to the CSV file, a profile for -columns\n");
+    printf("   -columns <file>  leave out of the result the columns that are constant\n");
+    printf("                    in the profile written by -activity\n");
+    printf("   -input <file> .. set the Real inputs from the CSV file, interpolated in time\n");
+    printf("   -binary <file> . write the result also to a binary file, see sink.c\n");
+    printf("   -downsample <dt> write result rows at least dt apart, and the last row\n");
+    printf("   -publish <name>  publish the latest row in the named shared memory\n");
+    printf("   -trace <file> .. record the calls of the fmu to the binary file, see trace.c\n");
+    printf("   -replay <file>   instead of simulating, replay the calls recorded in the file,\n");
+    printf("                    and report the time spent in the fmu and outputs that differ\n");
+    printf("   -instances <n> . simulate n instances of the FMU, write their final values\n");
+    printf("   -threads <n> ... number of worker threads, defaults to number of processors\n");
+    printf("   -sync .......... advance the instances in time order, batching equal event times\n");
+    printf("   -journal <file>  record finished instances in the journal file, and skip\n");
+    printf("                    instances recorded there by an interrupted earlier run\n");
+    printf("   -sweep <file> .. set parameters of the instances, one per line of the CSV\n");
+    printf("                    file, which names the parameters in its first line\n");
+    printf("   -dataset <dir> . write the trajectories of all instances to directory dir\n");
+    printf("   -interval <dt> . time between the rows of the dataset, defaults to <h>\n");
+    printf("   -partitions <n>  number of files of the dataset, defaults to <threads>\n");
+    printf("   -branch <t> .... simulate up to time t once, and continue all instances from there\n");
+    printf("   -stop <cond> ... finish an instance when cond holds, e.g. x<0.01 or time>=5,\n");
+    printf("                    or when a state is NaN or infinite for cond %s;\n", STOP_NONFINITE);
+    printf("                    may be given several times\n");
+    printf("   -progress <file> rewrite the file every second with the progress, throughput\n");
+    printf("                    and the status of each instance\n");
+    printf("   -comm <H> ...... communication step size of a system, defaults to <h>\n");
+    printf("   -adapt <tol> ... adapt the communication step, starting with <H>, to keep the\n");
+    printf("                    coupling error below tol, rolling back rejected steps\n");
+}
+
+// 1 if the file name ends with the given suffix
+static int hasSuffix(const char* fileName, const char* suffix) {
+    int n = strlen(fileName) - strlen(suffix);
+    return n >= 0 && !strcmp(fileName + n, suffix);
+}
+
+// path of the profile of the given fmu: the ".fmu" suffix is replaced
+// by PROFILE_SUFFIX, which is appended if there is none
+static char* getProfilePath(const char* fmuFileName) {
+    char* path = calloc(sizeof(char), strlen(fmuFileName) + strlen(PROFILE_SUFFIX) + 1);
+    char* dot;
+    strcpy(path, fmuFileName);
+    dot = strrchr(path, '.');
+    if (dot && !strcmp(dot, ".fmu")) *dot = '\0';
+    strcat(path, PROFILE_SUFFIX);
+    return path;
+}
+
+// Returns s, the sink of the result created by the caller. Exits if it
+// could not be created
+static Sink* checkSink(Sink* s) {
+    if (!s) {
+        printf("error: Could not create a sink of the result\n");
+        exit(EXIT_FAILURE);
+    }
+    return s;
 }
 
 int main(int argc, char *argv[]) {
     const char* fmuFileName;
-    char* fmuPath;
-    char* tmpPath;
-    char* xmlPath;
-    char* dllPath;
-    char* cmd;
+    char* profilePath;
+    int i, n;
     
     // define default argument values
     double tEnd = 1.0;
     double h=0.1;
     int loggingOn = 0;
     char csv_separator = ';';
+    Method method = mth_euler;
+    double tolerance = 0;            // 0 to use the profile, if any
+    TuneProfile profile;
+    Ensemble ensemble;               // nInstances 0 to simulate a single instance
+    const char* sweepPath = NULL;    // parameters of the instances, if any
+    int countersOn = 0;              // 1 to report hardware counters
+    int precision = 0;               // 1 to run the work-precision benchmark
+    const char* inputPath = NULL;    // table of the inputs, if any
+    Inputs* inputs = NULL;
+    const char* binaryPath = NULL;   // binary result file, if any
+    const char* publishName = NULL;  // shared memory of the latest row, if any
+    double downsample = 0;           // 0 to write every row
+    const char* tracePath = NULL;    // trace of the fmu calls to record, if any
+    const char* replayPath = NULL;   // trace to replay instead of simulating, if any
+    const char* diagPath = NULL;     // per-step solver diagnostics, if any
+    double diagTolerance = DIAG_TOLERANCE;
+    Diagnostics* diagnostics = NULL;
+    const char* activityPath = NULL; // activity profile to write, if any
+    const char* columnsPath = NULL;  // activity profile selecting the columns, if any
+    ActivityProfile* columns = NULL;
+    Sink* sinks = NULL;
+    Sink* s;
+    double hComm = 0;                // 0 to exchange values of a system every step h
+    double commTolerance = 0;        // 0 for a fixed communication step
+    CoSystem* sys;
+
+    memset(&ensemble, 0, sizeof(Ensemble));
+    ensemble.stopConditions = (const char**)calloc(argc, sizeof(char*));
+
+    // parse and remove command line options, leaving the positional arguments
+    for (i=1, n=1; i<argc; i++) {
+        if (argv[i][0]!='-' || !isalpha(argv[i][1])) {
+            argv[n++] = argv[i];
+            continue;
+        }
+        if (!strcmp(argv[i], "-sync")) {
+            ensemble.sync = 1;
+            continue;
+        }
+        if (!strcmp(argv[i], "-counters")) {
+            countersOn = 1;
+            continue;
+        }
+        if (!strcmp(argv[i], "-precision")) {
+            precision = 1;
+            continue;
+        }
+        if (i+1 == argc) {
+            printf("error: Missing value of option %s\n", argv[i]);
+            exit(EXIT_FAILURE);
+        }
+        if (!strcmp(argv[i], "-method")) {
+            int m = getMethod(argv[++i]);
+            if (m == -1) {
+                printf("error: The given method (%s) is not known\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+            method = (Method)m;
+        }
+        else if (!strcmp(argv[i], "-tune")) {
+            if (sscanf(argv[++i],"%lf", &tolerance) != 1 || tolerance <= 0) {
+                printf("error: The given tolerance (%s) is not a positive number\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-instances")) {
+            if (sscanf(argv[++i],"%d", &ensemble.nInstances) != 1 || ensemble.nInstances <= 0) {
+                printf("error: The given number of instances (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-threads")) {
+            if (sscanf(argv[++i],"%d", &ensemble.nThreads) != 1 || ensemble.nThreads <= 0) {
+                printf("error: The given number of threads (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-journal")) {
+            ensemble.journalPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-sweep")) {
+            sweepPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-stop")) {
+            ensemble.stopConditions[ensemble.nStopConditions++] = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-progress")) {
+            ensemble.statsPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-dataset")) {
+            ensemble.datasetPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-interval")) {
+            if (sscanf(argv[++i],"%lf", &ensemble.interval) != 1 || ensemble.interval <= 0) {
+                printf("error: The given dataset interval (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-partitions")) {
+            if (sscanf(argv[++i],"%d", &ensemble.nPartitions) != 1 || ensemble.nPartitions <= 0) {
+                printf("error: The given number of partitions (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-branch")) {
+            if (sscanf(argv[++i],"%lf", &ensemble.tBranch) != 1 || ensemble.tBranch <= 0) {
+                printf("error: The given branch time (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-input")) {
+            inputPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-binary")) {
+            binaryPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-publish")) {
+            publishName = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-trace")) {
+            tracePath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-replay")) {
+            replayPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-diag")) {
+            diagPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-activity")) {
+            activityPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-columns")) {
+            columnsPath = argv[++i];
+        }
+        else if (!strcmp(argv[i], "-downsample")) {
+            if (sscanf(argv[++i],"%lf", &downsample) != 1 || downsample <= 0) {
+                printf("error: The given downsampling interval (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-comm")) {
+            if (sscanf(argv[++i],"%lf", &hComm) != 1 || hComm <= 0) {
+                printf("error: The given communication step size (%s) is not positive\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (!strcmp(argv[i], "-adapt")) {
+            if (sscanf(argv[++i],"%lf", &commTolerance) != 1 || commTolerance <= 0) {
+                printf("error: The given coupling tolerance (%s) is not a positive number\n", argv[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            printf("error: Unknown option %s\n", argv[i]);
+            printHelp(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    argc = n;
 
     // parse command line arguments
     if (argc>1) {
@@ -143,43 +338,154 @@ int main(int argc, char *argv[]) {
         printHelp(argv[0]);
     }
 
-    // get absolute path to FMU, NULL if not found
-    fmuPath = getFmuPath(fmuFileName);
-    if (!fmuPath) exit(EXIT_FAILURE);
+    if ((tracePath || replayPath)
+            && (hasSuffix(fmuFileName, SYSTEM_SUFFIX) || hasSuffix(fmuFileName, JOBS_SUFFIX))) {
+        printf("error: Traces record a single fmu, not a system or job file\n");
+        exit(EXIT_FAILURE);
+    }
+    if (diagPath && (hasSuffix(fmuFileName, SYSTEM_SUFFIX) || hasSuffix(fmuFileName, JOBS_SUFFIX))) {
+        printf("error: Diagnostics record a single fmu, not a system or job file\n");
+        exit(EXIT_FAILURE);
+    }
+    if ((activityPath || columnsPath)
+            && (hasSuffix(fmuFileName, SYSTEM_SUFFIX) || hasSuffix(fmuFileName, JOBS_SUFFIX))) {
+        printf("error: Activity profiles describe the result of a single fmu, not a system or job file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // run the simulations of a job file
+    if (hasSuffix(fmuFileName, JOBS_SUFFIX)) {
+        if (ensemble.nThreads == 0) ensemble.nThreads = threadCount();
+        printf("FMU Simulator: run jobs '%s' with defaults tEnd=%g, h=%g, method=%s, loggingOn=%d, csv separator='%c'\n",
+                fmuFileName, tEnd, h, mthNames[method], loggingOn, csv_separator);
+        n = fmuRunJobs(fmuFileName, tEnd, h, method, ensemble.nThreads, loggingOn, csv_separator);
+        return n ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // simulate a system of connected fmus
+    if (hasSuffix(fmuFileName, SYSTEM_SUFFIX)) {
+        if (hComm == 0) hComm = h;
+        sys = coLoad(fmuFileName);
+        if (!sys) exit(EXIT_FAILURE);
+        printf("FMU Simulator: run system '%s' from t=0..%g with step size h=%g, communication step size=%g, method=%s, loggingOn=%d, csv separator='%c'\n", 
+                fmuFileName, tEnd, h, hComm, mthNames[method], loggingOn, csv_separator);
+        n = fmuCoSimulate(sys, tEnd, h, hComm, commTolerance, method, loggingOn, csv_separator);
+        coFree(sys);
+        return n ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    // unzip the FMU to the tmpPath directory
-    tmpPath = getTmpPath();
-    if (!fmuUnzip(fmuPath, tmpPath)) exit(EXIT_FAILURE);
+    // unzip, parse and load the FMU
+    if (!fmuLoad(fmuFileName, &fmu)) exit(EXIT_FAILURE);
 
-    // parse tmpPath\modelDescription.xml
-    xmlPath = calloc(sizeof(char), strlen(tmpPath) + strlen(XML_FILE) + 1);
-    sprintf(xmlPath, "%s%s", tmpPath, XML_FILE);
-    fmu.modelDescription = parse(xmlPath);
-    free(xmlPath);
-    if (!fmu.modelDescription) exit(EXIT_FAILURE);
+    // time the recorded calls instead of simulating
+    if (replayPath) {
+        printf("FMU Simulator: replay '%s' with '%s'\n", replayPath, fmuFileName);
+        n = traceReplay(&fmu, replayPath, loggingOn);
+        fmuFree(&fmu);
+        return n ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
 
-    // load the FMU dll
-    dllPath = calloc(sizeof(char), strlen(tmpPath) + strlen(DLL_DIR) 
-            + strlen( getModelIdentifier(fmu.modelDescription)) +  strlen(DLL_SUFFIX) + 1);
-    sprintf(dllPath,"%s%s%s%s", tmpPath, DLL_DIR, getModelIdentifier(fmu.modelDescription), DLL_SUFFIX);
-    if (!fmuLoadDll(dllPath, &fmu)) exit(EXIT_FAILURE); 
-    free(dllPath);
-    free(fmuPath);
+    // measure error against cost instead of simulating
+    if (precision) {
+        n = fmuWorkPrecision(&fmu, tEnd, csv_separator);
+        fmuFree(&fmu);
+        return n ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // select method and step size, or reuse the selection of an earlier run
+    profilePath = getProfilePath(fmuFileName);
+    if (tolerance > 0) {
+        if (fmuTune(&fmu, tEnd, tolerance, &profile)) {
+            writeProfile(profilePath, getString(fmu.modelDescription, att_guid), &profile);
+            method = profile.method;
+            h = profile.h;
+        }
+        diagTolerance = tolerance;
+    }
+    else if (argc<=3 && readProfile(profilePath, getString(fmu.modelDescription, att_guid), &profile)) {
+        printf("using profile '%s' for tolerance %g\n", profilePath, profile.tolerance);
+        method = profile.method;
+        h = profile.h;
+        diagTolerance = profile.tolerance;
+    }
+    free(profilePath);
 
     // run the simulation
-    printf("FMU Simulator: run '%s' from t=0..%g with step size h=%g, loggingOn=%d, csv separator='%c'\n", 
-            fmuFileName, tEnd, h, loggingOn, csv_separator);
-    fmuSimulate(&fmu, tEnd, h, loggingOn, csv_separator);
-
-#if WINDOWS
-    /* Remove temp file directory? */
-#else
-    cmd = calloc(sizeof(char), strlen(tmpPath)+8);
-    sprintf(cmd, "rm -rf %s", tmpPath);
-    printf("Removing %s\n", tmpPath);
-    system(cmd);
-#endif
-    free(tmpPath);
+    printf("FMU Simulator: run '%s' from t=0..%g with step size h=%g, method=%s, loggingOn=%d, csv separator='%c'\n", 
+            fmuFileName, tEnd, h, mthNames[method], loggingOn, csv_separator);
+    if (sweepPath) {
+        ensemble.sweep = sweepLoad(sweepPath, fmu.modelDescription, csv_separator);
+        if (!ensemble.sweep) exit(EXIT_FAILURE);
+        if (ensemble.nInstances > 0 && ensemble.nInstances != ensemble.sweep->nCases) {
+            printf("error: The sweep has %d cases, not %d instances\n",
+                    ensemble.sweep->nCases, ensemble.nInstances);
+            exit(EXIT_FAILURE);
+        }
+        ensemble.nInstances = ensemble.sweep->nCases;
+    }
+    if (ensemble.tBranch >= tEnd) {
+        printf("error: The branch time (%g) is not before the end time\n", ensemble.tBranch);
+        exit(EXIT_FAILURE);
+    }
+    if ((ensemble.datasetPath || ensemble.nStopConditions > 0 || ensemble.statsPath
+            || ensemble.tBranch > 0) && ensemble.nInstances == 0)
+        ensemble.nInstances = 1;
+    if (ensemble.nInstances > 0 && tracePath) {
+        printf("error: A trace records a single instance, not an ensemble\n");
+        exit(EXIT_FAILURE);
+    }
+    if (ensemble.nInstances > 0 && diagPath) {
+        printf("error: Diagnostics record a single instance, not an ensemble\n");
+        exit(EXIT_FAILURE);
+    }
+    if (ensemble.nInstances > 0 && (activityPath || columnsPath)) {
+        printf("error: Activity profiles describe the result of a single instance, not an ensemble\n");
+        exit(EXIT_FAILURE);
+    }
+    if (ensemble.nInstances > 0) {
+        if (ensemble.nThreads == 0) ensemble.nThreads = threadCount();
+        if (ensemble.interval == 0) ensemble.interval = h;
+        if (ensemble.nPartitions == 0) ensemble.nPartitions = ensemble.nThreads;
+        fmuSimulateInstances(&fmu, &ensemble, tEnd, h, method, loggingOn, csv_separator);
+        if (ensemble.sweep) sweepFree(ensemble.sweep);
+    }
+    else {
+        // the sinks of the result, in reverse order
+        if (columnsPath && !(columns = activityLoad(columnsPath, csv_separator))) exit(EXIT_FAILURE);
+        if (publishName) {
+            s = checkSink(publishSink(publishName));
+            if (columns) s = checkSink(selectSink(s, columns));
+            s->next = sinks;
+            sinks = s;
+        }
+        if (binaryPath) {
+            s = checkSink(binarySink(binaryPath));
+            if (downsample > 0) s = checkSink(downsampleSink(s, downsample));
+            if (columns) s = checkSink(selectSink(s, columns));
+            s->next = sinks;
+            sinks = s;
+        }
+        s = checkSink(csvSink(RESULT_FILE, csv_separator));
+        if (downsample > 0) s = checkSink(downsampleSink(s, downsample));
+        if (columns) s = checkSink(selectSink(s, columns));
+        s->next = sinks;
+        sinks = s;
+        if (activityPath) {
+            s = checkSink(activitySink(activityPath, csv_separator));
+            s->next = sinks;
+            sinks = s;
+        }
+        if (inputPath && !(inputs = inputsLoad(inputPath, fmu.modelDescription, csv_separator)))
+            exit(EXIT_FAILURE);
+        if (diagPath && !(diagnostics = diagNew(diagPath, diagTolerance, csv_separator)))
+            exit(EXIT_FAILURE);
+        if (tracePath && !traceRecord(&fmu, tracePath)) exit(EXIT_FAILURE);
+        fmuSimulate(&fmu, tEnd, h, method, loggingOn, sinks, inputs, countersOn, diagnostics);
+        if (tracePath && !traceClose(&fmu)) exit(EXIT_FAILURE);
+        if (diagnostics && !diagClose(diagnostics)) exit(EXIT_FAILURE);
+        if (inputs) inputsFree(inputs);
+        if (columns) activityFree(columns);
+    }
 
     // release FMU 
     fmuFree(&fmu);
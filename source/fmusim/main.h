@@ -45,9 +45,18 @@ typedef fmiStatus (*fGetContinuousStates)       (fmiComponent c, fmiReal states[
 typedef fmiStatus (*fGetNominalContinuousStates)(fmiComponent c, fmiReal x_nominal[], size_t nx);
 typedef fmiStatus (*fGetStateValueReferences)   (fmiComponent c, fmiValueReference vrx[], size_t nx);
 typedef fmiStatus (*fTerminate)                 (fmiComponent c);    
+typedef size_t    (*fGetModelStateSize)         (fmiComponent c);
+typedef fmiStatus (*fGetModelState)             (fmiComponent c, void* state, size_t size);
+typedef fmiStatus (*fSetModelState)             (fmiComponent c, const void* state, size_t size);
+typedef fmiStatus (*fGetDirectionalDerivative)  (fmiComponent c, const fmiValueReference vUnknown[],
+                                                size_t nUnknown, const fmiValueReference vKnown[], size_t nKnown,
+                                                const fmiReal dvKnown[], fmiReal dvUnknown[]);
+
+struct Fmu2;
 
 typedef struct {
     ModelDescription* modelDescription;
+    char* tmpPath;  // directory of the unzipped fmu
     HANDLE dllHandle;
     fGetModelTypesPlatform getModelTypesPlatform;
     fGetVersion getVersion;
@@ -73,6 +82,11 @@ typedef struct {
     fGetNominalContinuousStates getNominalContinuousStates;
     fGetStateValueReferences getStateValueReferences;
     fTerminate terminate;
+    fGetModelStateSize getModelStateSize;  // optional extension of fmuTemplate, may be NULL
+    fGetModelState getModelState;
+    fSetModelState setModelState;
+    fGetDirectionalDerivative getDirectionalDerivative; // FMI 2.0 only, may be NULL
+    struct Fmu2* fmi2;  // the functions of an FMI 2.0 FMU, NULL for FMI 1.0
 } FMU;
 
 #endif // main_h
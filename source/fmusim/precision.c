@@ -0,0 +1,294 @@
+/* -------------------------------------------------------------------------
+ * precision.c
+ * Work-precision benchmark of the integration methods.
+ * The FMU is simulated from 0 to tEnd with every method and a sequence of
+ * step sizes, one run after the other so that wall times are comparable.
+ * The error of each run is measured against the analytic solution of the
+ * model, which is known for these sample models:
+ *   dq            x(t) = x0 exp(-k t), error: max |x - x(t)| over all steps
+ *   bouncingBall  bounce times t1 = (v0 + sqrt(v0^2 + 2 g h0)) / g and
+ *                 t(n+1) = t(n) + 2 e^n v1 / g with impact speed v1,
+ *                 error: max difference of the times of the state events
+ *                 and the bounce times, for the first WP_BOUNCES bounces
+ *                 before tEnd; infinite if a bounce is missed
+ * The parameters and start values are taken from the instance after
+ * initialization. The error of dq is measured on the rows of the result,
+ * passed to the benchmark by a callback sink, as a user of the result sees
+ * them; the bounce times need the state events of the instance. The cost of a run is given by its FMU calls, counted by
+ * wrappers of the functions called during a step, by the number of
+ * derivative evaluations and by its wall time. The runs are written to
+ * WP_FILE, one row per run, for plotting error against cost.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "precision.h"
+#include "fmuio.h"
+#include "sink.h"
+#include "fmuthread.h"
+
+#define WP_K_MIN 3                   // largest step size is tEnd/2^WP_K_MIN
+#define WP_K_MAX 16                  // smallest step size is tEnd/2^WP_K_MAX
+#define WP_BOUNCES 5                 // bounces compared, before they accumulate
+
+// one run of the benchmark
+typedef struct {
+    SimInstance sim;
+    FMU* fmu;                        // without counting wrappers
+    double tEnd;
+    double p[4];                     // parameters of the analytic solution
+    double error;                    // largest error so far
+    double events[WP_BOUNCES];       // times of the state events
+    int nEvents;
+    int nStateEvents;                // state events of the instance seen so far
+} WpRun;
+
+// analytic solution of a model
+typedef struct {
+    const char* modelIdentifier;
+    const char* error;               // what the error measures
+    int (*start)(WpRun* r);          // after initialization. Returns 0 to indicate error
+    void (*step)(WpRun* r);          // after each step, or NULL
+    SinkCallback rows;               // with the rows of the result, or NULL
+    void (*finish)(WpRun* r);        // after the last step, or NULL
+} Analytic;
+
+// -------------------------------------------------------------------------
+// Counting FMU calls
+
+static FMU* counted;                 // the fmu whose calls are counted
+static long nCalls;
+
+static fmiStatus countSetTime(fmiComponent c, fmiReal time) {
+    nCalls++;
+    return counted->setTime(c, time);
+}
+
+static fmiStatus countSetContinuousStates(fmiComponent c, const fmiReal x[], size_t nx) {
+    nCalls++;
+    return counted->setContinuousStates(c, x, nx);
+}
+
+static fmiStatus countGetContinuousStates(fmiComponent c, fmiReal x[], size_t nx) {
+    nCalls++;
+    return counted->getContinuousStates(c, x, nx);
+}
+
+static fmiStatus countGetDerivatives(fmiComponent c, fmiReal derivatives[], size_t nx) {
+    nCalls++;
+    return counted->getDerivatives(c, derivatives, nx);
+}
+
+static fmiStatus countGetEventIndicators(fmiComponent c, fmiReal eventIndicators[], size_t ni) {
+    nCalls++;
+    return counted->getEventIndicators(c, eventIndicators, ni);
+}
+
+static fmiStatus countCompletedIntegratorStep(fmiComponent c, fmiBoolean* callEventUpdate) {
+    nCalls++;
+    return counted->completedIntegratorStep(c, callEventUpdate);
+}
+
+static fmiStatus countEventUpdate(fmiComponent c, fmiBoolean intermediateResults,
+        fmiEventInfo* eventInfo) {
+    nCalls++;
+    return counted->eventUpdate(c, intermediateResults, eventInfo);
+}
+
+// copy fmu to wrapper, with the functions called during a step counted
+static void initCounting(FMU* fmu, FMU* wrapper) {
+    counted = fmu;
+    *wrapper = *fmu;
+    wrapper->setTime = countSetTime;
+    wrapper->setContinuousStates = countSetContinuousStates;
+    wrapper->getContinuousStates = countGetContinuousStates;
+    wrapper->getDerivatives = countGetDerivatives;
+    wrapper->getEventIndicators = countGetEventIndicators;
+    wrapper->completedIntegratorStep = countCompletedIntegratorStep;
+    wrapper->eventUpdate = countEventUpdate;
+}
+
+// -------------------------------------------------------------------------
+// Analytic solutions
+
+// Find the Real variable of the given name, and its sign as an alias.
+// Returns 0 to indicate error
+static int findReal(WpRun* r, const char* name, fmiValueReference* vr, double* sign) {
+    ScalarVariable* sv = getVariableByName(r->fmu->modelDescription, name);
+    if (!sv || sv->typeSpec->type != elm_Real) {
+        printf("error: Real variable %s not found\n", name);
+        return 0;
+    }
+    *vr = getValueReference(sv);
+    *sign = getAlias(sv) == enu_negatedAlias ? -1 : 1;
+    return 1; // success
+}
+
+// Get the value of a Real variable found by findReal, without counting.
+// Returns 0 to indicate error
+static int getValue(WpRun* r, fmiValueReference vr, double sign, double* value) {
+    if (r->fmu->getReal(r->sim.c, &vr, 1, value) > fmiWarning)
+        return fmuError("could not get value");
+    *value *= sign;
+    return 1; // success
+}
+
+// Get the value of the Real variable of the given name, without counting.
+// Returns 0 to indicate error
+static int getByName(WpRun* r, const char* name, double* value) {
+    fmiValueReference vr;
+    double sign;
+    return findReal(r, name, &vr, &sign) && getValue(r, vr, sign, value);
+}
+
+static int dqStart(WpRun* r) {
+    return getByName(r, "x", &r->p[0]) && getByName(r, "k", &r->p[1]);
+}
+
+// Returns 0 to indicate error
+static int dqRows(void* arg, Schema* schema, RowBatch* batch) {
+    WpRun* r = (WpRun*)arg;
+    int i, k;
+    for (k=0; k<schema->nColumns && strcmp(schema->names[k], "x"); k++);
+    if (k == schema->nColumns) return fmuError("x is not a column of the result");
+    for (i=0; i<batch->nRows; i++) {
+        double x = batch->values[i * schema->nColumns + k].r;
+        double e = fabs(x - r->p[0] * exp(-r->p[1] * batch->times[i]));
+        if (e > r->error || e != e) r->error = e;
+    }
+    return 1; // success
+}
+
+static int ballStart(WpRun* r) {
+    return getByName(r, "h", &r->p[0]) && getByName(r, "v", &r->p[1])
+            && getByName(r, "g", &r->p[2]) && getByName(r, "e", &r->p[3]);
+}
+
+// a bounce is a state event with the ball below ground, the event when
+// it rises above ground again is not counted
+static void ballStep(WpRun* r) {
+    if (r->sim.nStateEvents != r->nStateEvents && r->sim.z[0] < 0 && r->nEvents < WP_BOUNCES)
+        r->events[r->nEvents++] = r->sim.time;
+    r->nStateEvents = r->sim.nStateEvents;
+}
+
+static void ballFinish(WpRun* r) {
+    int n;
+    double h0 = r->p[0], v0 = r->p[1], g = r->p[2], e = r->p[3];
+    double v1 = sqrt(v0 * v0 + 2 * g * h0);
+    double t = (v0 + v1) / g;
+    double v = v1;
+    for (n=0; n<WP_BOUNCES && t < r->tEnd; n++) {
+        double err = n < r->nEvents ? fabs(r->events[n] - t) : HUGE_VAL;
+        if (err > r->error) r->error = err;
+        v *= e;
+        t += 2 * v / g;
+    }
+}
+
+static Analytic analytics[] = {
+    { "dq", "max |x - x0 exp(-k t)|", dqStart, NULL, dqRows, NULL },
+    { "bouncingBall", "max error of the bounce times [s]", ballStart, ballStep, NULL, ballFinish },
+    { NULL }
+};
+
+// -------------------------------------------------------------------------
+// Benchmark
+
+// write a number to a CSV file, with decimal comma unless separator is ','
+static void printReal(FILE* file, double r, char separator) {
+    char buffer[32];
+    char* comma;
+    sprintf(buffer, "%.6g", r);
+    comma = separator == ',' ? NULL : strchr(buffer, '.');
+    if (comma) *comma = ',';
+    fprintf(file, "%c%s", separator, buffer);
+}
+
+// Simulate one run, counting its cost. The rows of the result are fetched
+// without counting. Returns 0 to indicate error
+static int runOnce(WpRun* r, FMU* wrapper, Analytic* a, Method method, double h, double* wall) {
+    int ok;
+    double start;
+    Output* output = NULL;
+    Sink* sink;
+    nCalls = 0;
+    ok = simInstantiate(&r->sim, wrapper, getModelIdentifier(r->fmu->modelDescription),
+            method, h, fmiFalse) && simInitialize(&r->sim, 0) && a->start(r);
+    if (ok && a->rows) {
+        sink = callbackSink(a->rows, r);
+        output = sink ? outputOpen(r->fmu, sink) : NULL;
+        ok = output && outputSample(output, r->sim.c, 0);
+    }
+    start = wallClock();
+    while (ok && r->sim.time < r->tEnd && !r->sim.terminated) {
+        ok = simDoStep(&r->sim, r->tEnd);
+        if (ok && a->step) a->step(r);
+        if (ok && output && !r->sim.terminated) ok = outputSample(output, r->sim.c, r->sim.time);
+    }
+    *wall = wallClock() - start;
+    if (output) {
+        if (ok) ok = outputClose(output);
+        else outputAbort(output);
+    }
+    if (ok && a->finish) a->finish(r);
+    return ok;
+}
+
+// Simulate the fmu with all methods and step sizes, and write error and
+// cost of each run to WP_FILE.
+// Returns 0 to indicate error
+int fmuWorkPrecision(FMU* fmu, double tEnd, char separator) {
+    int k, m;
+    double h, wall;
+    WpRun r;
+    FMU wrapper;
+    FILE* file;
+    Analytic* a;
+    const char* modelId = getModelIdentifier(fmu->modelDescription);
+
+    for (a = analytics; a->modelIdentifier && strcmp(a->modelIdentifier, modelId); a++);
+    if (!a->modelIdentifier) {
+        printf("error: No analytic solution known for model %s\n", modelId);
+        return 0;
+    }
+    if (!(file = fopen(WP_FILE, "w"))) {
+        printf("could not write %s\n", WP_FILE);
+        return 0; // failure
+    }
+    initCounting(fmu, &wrapper);
+    fprintf(file, "method%ch%cerror%ccalls%cderivatives%csteps%cwall\n",
+            separator, separator, separator, separator, separator, separator);
+    printf("Work-precision of %s over t=0..%g, error: %s\n", modelId, tEnd, a->error);
+    printf("  method  h            error        calls      derivatives  wall [s]\n");
+    for (m=0; m<SIZEOF_MTH; m++) {
+        for (k=WP_K_MIN; k<=WP_K_MAX; k++) {
+            h = tEnd / pow(2, k);
+            memset(&r, 0, sizeof(WpRun));
+            r.fmu = fmu;
+            r.tEnd = tEnd;
+            if (!runOnce(&r, &wrapper, a, (Method)m, h, &wall)) {
+                printf("  %-7s %-12g failed\n", mthNames[m], h);
+                simFree(&r.sim);
+                continue;
+            }
+            printf("  %-7s %-12g %-12.4g %-10ld %-12ld %.4f\n", mthNames[m], h, r.error,
+                    nCalls, r.sim.nDerivatives, wall);
+            fprintf(file, "%s", mthNames[m]);
+            printReal(file, h, separator);
+            printReal(file, r.error, separator);
+            fprintf(file, "%c%ld%c%ld%c%d", separator, nCalls, separator, r.sim.nDerivatives,
+                    separator, r.sim.nSteps);
+            printReal(file, wall, separator);
+            fprintf(file, "\n");
+            simFree(&r.sim);
+        }
+    }
+    fclose(file);
+    printf("CSV file '%s' written.\n", WP_FILE);
+    return 1; // success
+}
@@ -0,0 +1,18 @@
+/* -------------------------------------------------------------------------
+ * precision.h
+ * Work-precision benchmark of the integration methods, measured against
+ * analytic solutions of the sample models
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef precision_h
+#define precision_h
+
+#include "fmusim.h"
+
+#define WP_FILE "workprecision.csv"
+
+int fmuWorkPrecision(FMU* fmu, double tEnd, char separator);
+
+#endif // precision_h
@@ -0,0 +1,620 @@
+/* -------------------------------------------------------------------------
+ * sink.c
+ * Destinations of the rows of a simulation result.
+ * An Output fetches the values of all non-alias variables of an instance
+ * once per row, with one get call per type, collects OUTPUT_BATCH rows and
+ * hands each batch to every sink of its list. Sinks are:
+ *   csv        the CSV file written by outputRow, see fmuio.c
+ *   binary     a file starting with BINARY_MAGIC, the int number of columns
+ *              and for each column its int type code (0 Real, 1 Integer,
+ *              2 Boolean, 3 String), the int length of its name and the name,
+ *              followed by the rows: the double time and for each column a
+ *              double, an int, or the int length and the characters of a
+ *              string, all in native byte order
+ *   callback   passes each batch to a function
+ *   downsample passes rows at least interval apart to another sink, and
+ *              the last row
+ *   publish    a named shared memory with the latest row, see PublishHeader,
+ *              updated after each batch; it is left in place at the end so
+ *              that readers can see the final values
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "sink.h"
+#include "fmuio.h"
+
+#ifdef _MSC_VER
+#include <windows.h>
+#define memoryBarrier() MemoryBarrier()
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#define memoryBarrier() __sync_synchronize()
+#endif
+
+#define BUFSIZE 4096
+#define DOWNSAMPLE_EPS 1e-9          // tolerance of row times, relative to interval
+
+// the variables of one type, fetched with one get call
+typedef struct {
+    int n;
+    fmiValueReference* vr;
+    int* columns;                    // column of each variable
+    void* values;                    // fetched values
+} Fetch;
+
+enum { fReal, fInteger, fBoolean, fString, NUMBER_OF_FETCHES };
+
+struct Output {
+    FMU* fmu;
+    Sink* sinks;
+    Schema schema;
+    RowBatch batch;
+    Fetch fetch[NUMBER_OF_FETCHES];
+};
+
+// shared memory of a publish sink, followed by the double time and the
+// value of each column as double (NaN for strings), and by the names of
+// the columns, each terminated by '\0'
+typedef struct {
+    char magic[8];                   // PUBLISH_MAGIC
+    int nColumns;
+    volatile int sequence;           // odd while the row is written
+    volatile long nRows;             // rows written so far
+} PublishHeader;
+
+static int fetchOf(Elm type) {
+    switch (type) {
+        case elm_Real:    return fReal;
+        case elm_Boolean: return fBoolean;
+        case elm_String:  return fString;
+        default:          return fInteger;
+    }
+}
+
+// free the strings of the rows of the batch
+static void clearStrings(Schema* schema, RowBatch* batch) {
+    int i, k;
+    for (k=0; k<schema->nColumns; k++) {
+        if (schema->types[k] != elm_String) continue;
+        for (i=0; i<batch->nRows; i++) free((char*)batch->values[i * schema->nColumns + k].s);
+    }
+}
+
+// -------------------------------------------------------------------------
+// CSV
+
+typedef struct {
+    Sink sink;
+    const char* path;
+    char separator;
+    FILE* file;
+} CsvSink;
+
+// write a Real, with decimal comma unless separator is ','
+static void csvReal(FILE* file, double r, char separator) {
+    char buffer[32];
+    char* comma;
+    sprintf(buffer, "%.16g", r);
+    comma = separator == ',' ? NULL : strchr(buffer, '.');
+    if (comma) *comma = ',';
+    fputs(buffer, file);
+}
+
+static int csvBegin(Sink* s, Schema* schema) {
+    CsvSink* cs = (CsvSink*)s;
+    int k;
+    if (!(cs->file = fopen(cs->path, "w"))) {
+        printf("could not write %s\n", cs->path);
+        return 0; // failure
+    }
+    fprintf(cs->file, "time");
+    for (k=0; k<schema->nColumns; k++) fprintf(cs->file, "%c%s", cs->separator, schema->names[k]);
+    fprintf(cs->file, "\n");
+    return 1; // success
+}
+
+static int csvWrite(Sink* s, Schema* schema, RowBatch* batch) {
+    CsvSink* cs = (CsvSink*)s;
+    int i, k;
+    for (i=0; i<batch->nRows; i++) {
+        SinkValue* v = batch->values + i * schema->nColumns;
+        csvReal(cs->file, batch->times[i], cs->separator);
+        for (k=0; k<schema->nColumns; k++) {
+            fputc(cs->separator, cs->file);
+            switch (schema->types[k]) {
+                case elm_Real:    csvReal(cs->file, v[k].r, cs->separator); break;
+                case elm_Boolean: fprintf(cs->file, "%d", v[k].b); break;
+                case elm_String:  fputs(v[k].s, cs->file); break;
+                default:          fprintf(cs->file, "%d", v[k].i); break;
+            }
+        }
+        fputc('\n', cs->file);
+    }
+    return !ferror(cs->file);
+}
+
+static int csvEnd(Sink* s, Schema* schema) {
+    CsvSink* cs = (CsvSink*)s;
+    int ok = fclose(cs->file) == 0;
+    if (schema->failed) remove(cs->path);
+    else if (ok) printf("CSV file '%s' written.\n", cs->path);
+    else printf("error: could not write %s\n", cs->path);
+    free(cs);
+    return ok;
+}
+
+Sink* csvSink(const char* path, char separator) {
+    CsvSink* cs = (CsvSink*)calloc(1, sizeof(CsvSink));
+    if (!cs) return NULL;
+    cs->sink.begin = csvBegin;
+    cs->sink.write = csvWrite;
+    cs->sink.end = csvEnd;
+    cs->path = path;
+    cs->separator = separator;
+    return &cs->sink;
+}
+
+// -------------------------------------------------------------------------
+// Binary
+
+typedef struct {
+    Sink sink;
+    const char* path;
+    FILE* file;
+} BinarySink;
+
+static int typeCode(Elm type) {
+    switch (type) {
+        case elm_Real:    return 0;
+        case elm_Boolean: return 2;
+        case elm_String:  return 3;
+        default:          return 1;
+    }
+}
+
+static int binaryBegin(Sink* s, Schema* schema) {
+    BinarySink* bs = (BinarySink*)s;
+    int k, n;
+    if (!(bs->file = fopen(bs->path, "wb"))) {
+        printf("could not write %s\n", bs->path);
+        return 0; // failure
+    }
+    fwrite(BINARY_MAGIC, 1, 8, bs->file);
+    fwrite(&schema->nColumns, sizeof(int), 1, bs->file);
+    for (k=0; k<schema->nColumns; k++) {
+        n = typeCode(schema->types[k]);
+        fwrite(&n, sizeof(int), 1, bs->file);
+        n = strlen(schema->names[k]);
+        fwrite(&n, sizeof(int), 1, bs->file);
+        fwrite(schema->names[k], 1, n, bs->file);
+    }
+    return !ferror(bs->file);
+}
+
+static int binaryWrite(Sink* s, Schema* schema, RowBatch* batch) {
+    BinarySink* bs = (BinarySink*)s;
+    int i, k, n;
+    for (i=0; i<batch->nRows; i++) {
+        SinkValue* v = batch->values + i * schema->nColumns;
+        fwrite(&batch->times[i], sizeof(double), 1, bs->file);
+        for (k=0; k<schema->nColumns; k++) {
+            switch (schema->types[k]) {
+                case elm_Real:
+                    fwrite(&v[k].r, sizeof(double), 1, bs->file);
+                    break;
+                case elm_Boolean:
+                    n = v[k].b;
+                    fwrite(&n, sizeof(int), 1, bs->file);
+                    break;
+                case elm_String:
+                    n = strlen(v[k].s);
+                    fwrite(&n, sizeof(int), 1, bs->file);
+                    fwrite(v[k].s, 1, n, bs->file);
+                    break;
+                default:
+                    n = v[k].i;
+                    fwrite(&n, sizeof(int), 1, bs->file);
+                    break;
+            }
+        }
+    }
+    return !ferror(bs->file);
+}
+
+static int binaryEnd(Sink* s, Schema* schema) {
+    BinarySink* bs = (BinarySink*)s;
+    int ok = fclose(bs->file) == 0;
+    if (schema->failed) remove(bs->path);
+    else if (ok) printf("Binary file '%s' written.\n", bs->path);
+    else printf("error: could not write %s\n", bs->path);
+    free(bs);
+    return ok;
+}
+
+Sink* binarySink(const char* path) {
+    BinarySink* bs = (BinarySink*)calloc(1, sizeof(BinarySink));
+    if (!bs) return NULL;
+    bs->sink.begin = binaryBegin;
+    bs->sink.write = binaryWrite;
+    bs->sink.end = binaryEnd;
+    bs->path = path;
+    return &bs->sink;
+}
+
+// -------------------------------------------------------------------------
+// Callback
+
+typedef struct {
+    Sink sink;
+    SinkCallback f;
+    void* arg;
+} CallbackSink;
+
+static int callbackBegin(Sink* s, Schema* schema) {
+    return 1; // success
+}
+
+static int callbackWrite(Sink* s, Schema* schema, RowBatch* batch) {
+    CallbackSink* cs = (CallbackSink*)s;
+    return cs->f(cs->arg, schema, batch);
+}
+
+static int callbackEnd(Sink* s, Schema* schema) {
+    free(s);
+    return 1; // success
+}
+
+Sink* callbackSink(SinkCallback f, void* arg) {
+    CallbackSink* cs = (CallbackSink*)calloc(1, sizeof(CallbackSink));
+    if (!cs) return NULL;
+    cs->sink.begin = callbackBegin;
+    cs->sink.write = callbackWrite;
+    cs->sink.end = callbackEnd;
+    cs->f = f;
+    cs->arg = arg;
+    return &cs->sink;
+}
+
+// -------------------------------------------------------------------------
+// Downsample
+
+typedef struct {
+    Sink sink;
+    Sink* target;
+    double interval;
+    int started;                     // 1 after the first row
+    double next;                     // time of the next row passed
+    RowBatch out;                    // rows passed from the current batch
+    int pending;                     // 1 if last holds a row not passed
+    double lastTime;
+    SinkValue* last;                 // with strings copied
+} DownsampleSink;
+
+// free the strings of the pending row
+static void clearPending(DownsampleSink* ds, Schema* schema) {
+    RowBatch last;
+    last.nRows = ds->pending;
+    last.values = ds->last;
+    clearStrings(schema, &last);
+    ds->pending = 0;
+}
+
+static int downsampleBegin(Sink* s, Schema* schema) {
+    DownsampleSink* ds = (DownsampleSink*)s;
+    ds->out.times = (double*)calloc(OUTPUT_BATCH, sizeof(double));
+    ds->out.values = (SinkValue*)calloc(OUTPUT_BATCH * schema->nColumns + 1, sizeof(SinkValue));
+    ds->last = (SinkValue*)calloc(schema->nColumns + 1, sizeof(SinkValue));
+    if (!ds->out.times || !ds->out.values || !ds->last) return fmuError("out of memory");
+    return ds->target->begin(ds->target, schema);
+}
+
+static int downsampleWrite(Sink* s, Schema* schema, RowBatch* batch) {
+    DownsampleSink* ds = (DownsampleSink*)s;
+    int i, k;
+    int nc = schema->nColumns;
+    ds->out.nRows = 0;
+    for (i=0; i<batch->nRows; i++) {
+        double t = batch->times[i];
+        SinkValue* v = batch->values + i * nc;
+        clearPending(ds, schema);
+        if (!ds->started || t >= ds->next - DOWNSAMPLE_EPS * ds->interval) {
+            ds->next = ds->started ? ds->next + ds->interval : t + ds->interval;
+            if (ds->next <= t - DOWNSAMPLE_EPS * ds->interval) ds->next = t + ds->interval;
+            ds->started = 1;
+            ds->out.times[ds->out.nRows] = t;
+            memcpy(ds->out.values + ds->out.nRows * nc, v, nc * sizeof(SinkValue));
+            ds->out.nRows++;
+            continue;
+        }
+        // keep the row, it is passed at the end if it is the last one
+        ds->lastTime = t;
+        memcpy(ds->last, v, nc * sizeof(SinkValue));
+        for (k=0; k<nc; k++) {
+            if (schema->types[k] == elm_String) ds->last[k].s = strdup(v[k].s);
+        }
+        ds->pending = 1;
+    }
+    return ds->out.nRows == 0 || ds->target->write(ds->target, schema, &ds->out);
+}
+
+static int downsampleEnd(Sink* s, Schema* schema) {
+    DownsampleSink* ds = (DownsampleSink*)s;
+    RowBatch last;
+    int ok = 1;
+    if (ds->pending) {
+        last.nRows = 1;
+        last.times = &ds->lastTime;
+        last.values = ds->last;
+        ok = ds->target->write(ds->target, schema, &last);
+        clearPending(ds, schema);
+    }
+    ok = ds->target->end(ds->target, schema) && ok;
+    if (ds->out.times) free(ds->out.times);
+    if (ds->out.values) free(ds->out.values);
+    if (ds->last) free(ds->last);
+    free(ds);
+    return ok;
+}
+
+Sink* downsampleSink(Sink* target, double interval) {
+    DownsampleSink* ds = (DownsampleSink*)calloc(1, sizeof(DownsampleSink));
+    if (!ds) return NULL;
+    ds->sink.begin = downsampleBegin;
+    ds->sink.write = downsampleWrite;
+    ds->sink.end = downsampleEnd;
+    ds->target = target;
+    ds->interval = interval;
+    return &ds->sink;
+}
+
+// -------------------------------------------------------------------------
+// Publish
+
+typedef struct {
+    Sink sink;
+    const char* name;
+    size_t size;
+    PublishHeader* header;
+    double* row;                     // time and the values
+#ifdef _MSC_VER
+    HANDLE mapping;
+#else
+    int fd;
+#endif
+} PublishSink;
+
+// Map the shared memory of the given size. Returns NULL to indicate error
+static void* mapShared(PublishSink* ps) {
+#ifdef _MSC_VER
+    ps->mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE,
+            0, (DWORD)ps->size, ps->name);
+    if (!ps->mapping) return NULL;
+    return MapViewOfFile(ps->mapping, FILE_MAP_ALL_ACCESS, 0, 0, ps->size);
+#else
+    void* p;
+    char name[BUFSIZE];
+    // a POSIX name starts with '/', a stale memory may have another size
+    snprintf(name, BUFSIZE, "%s%s", ps->name[0] == '/' ? "" : "/", ps->name);
+    shm_unlink(name);
+    ps->fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+    if (ps->fd < 0 || ftruncate(ps->fd, ps->size)) return NULL;
+    p = mmap(NULL, ps->size, PROT_READ | PROT_WRITE, MAP_SHARED, ps->fd, 0);
+    return p == MAP_FAILED ? NULL : p;
+#endif
+}
+
+static int publishBegin(Sink* s, Schema* schema) {
+    PublishSink* ps = (PublishSink*)s;
+    int k;
+    char* names;
+    ps->size = sizeof(PublishHeader) + (schema->nColumns + 1) * sizeof(double);
+    for (k=0; k<schema->nColumns; k++) ps->size += strlen(schema->names[k]) + 1;
+    if (!(ps->header = (PublishHeader*)mapShared(ps))) {
+        printf("error: could not create shared memory %s\n", ps->name);
+        return 0;
+    }
+    memset(ps->header, 0, ps->size);
+    ps->row = (double*)(ps->header + 1);
+    names = (char*)(ps->row + schema->nColumns + 1);
+    for (k=0; k<schema->nColumns; k++) {
+        strcpy(names, schema->names[k]);
+        names += strlen(names) + 1;
+    }
+    ps->header->nColumns = schema->nColumns;
+    memoryBarrier();
+    memcpy(ps->header->magic, PUBLISH_MAGIC, 8);
+    return 1; // success
+}
+
+static int publishWrite(Sink* s, Schema* schema, RowBatch* batch) {
+    PublishSink* ps = (PublishSink*)s;
+    int k;
+    int nc = schema->nColumns;
+    SinkValue* v = batch->values + (batch->nRows - 1) * nc;
+    ps->header->sequence++;
+    memoryBarrier();
+    ps->row[0] = batch->times[batch->nRows - 1];
+    for (k=0; k<nc; k++) {
+        switch (schema->types[k]) {
+            case elm_Real:    ps->row[k+1] = v[k].r; break;
+            case elm_Boolean: ps->row[k+1] = v[k].b; break;
+            case elm_String:  ps->row[k+1] = HUGE_VAL - HUGE_VAL; break;
+            default:          ps->row[k+1] = v[k].i; break;
+        }
+    }
+    ps->header->nRows += batch->nRows;
+    memoryBarrier();
+    ps->header->sequence++;
+    return 1; // success
+}
+
+static int publishEnd(Sink* s, Schema* schema) {
+    PublishSink* ps = (PublishSink*)s;
+#ifdef _MSC_VER
+    UnmapViewOfFile(ps->header);
+    CloseHandle(ps->mapping);
+#else
+    munmap(ps->header, ps->size);
+    close(ps->fd);
+#endif
+    printf("Shared memory '%s' published.\n", ps->name);
+    free(ps);
+    return 1; // success
+}
+
+Sink* publishSink(const char* name) {
+    PublishSink* ps = (PublishSink*)calloc(1, sizeof(PublishSink));
+    if (!ps) return NULL;
+    ps->sink.begin = publishBegin;
+    ps->sink.write = publishWrite;
+    ps->sink.end = publishEnd;
+    ps->name = name;
+    return &ps->sink;
+}
+
+// -------------------------------------------------------------------------
+// Output
+
+// write the batch to all sinks and empty it. Returns 0 to indicate error
+static int flush(Output* o) {
+    Sink* s;
+    int ok = 1;
+    if (o->batch.nRows == 0) return 1;
+    for (s=o->sinks; s; s=s->next) {
+        if (!s->write(s, &o->schema, &o->batch)) ok = 0;
+    }
+    clearStrings(&o->schema, &o->batch);
+    o->batch.nRows = 0;
+    return ok;
+}
+
+static void outputFree(Output* o) {
+    int f;
+    for (f=0; f<NUMBER_OF_FETCHES; f++) {
+        if (o->fetch[f].vr) free(o->fetch[f].vr);
+        if (o->fetch[f].columns) free(o->fetch[f].columns);
+        if (o->fetch[f].values) free(o->fetch[f].values);
+    }
+    if (o->schema.names) free(o->schema.names);
+    if (o->schema.types) free(o->schema.types);
+    if (o->batch.times) free(o->batch.times);
+    if (o->batch.values) free(o->batch.values);
+    free(o);
+}
+
+// Create the output of the non-alias variables of the fmu and begin the
+// sinks. Returns NULL to indicate error
+Output* outputOpen(FMU* fmu, Sink* sinks) {
+    ScalarVariable** vars = fmu->modelDescription->modelVariables;
+    Output* o = (Output*)calloc(1, sizeof(Output));
+    Sink* s;
+    int k, n, f;
+    static const size_t sizes[] = { sizeof(fmiReal), sizeof(fmiInteger), sizeof(fmiBoolean), sizeof(fmiString) };
+    if (!o) return NULL;
+    o->fmu = fmu;
+    o->sinks = sinks;
+    for (n=0; vars[n]; n++);
+    o->schema.names = (const char**)calloc(n + 1, sizeof(char*));
+    o->schema.types = (Elm*)calloc(n + 1, sizeof(Elm));
+    for (f=0; f<NUMBER_OF_FETCHES; f++) {
+        o->fetch[f].vr = (fmiValueReference*)calloc(n + 1, sizeof(fmiValueReference));
+        o->fetch[f].columns = (int*)calloc(n + 1, sizeof(int));
+        o->fetch[f].values = calloc(n + 1, sizes[f]);
+        if (!o->fetch[f].vr || !o->fetch[f].columns || !o->fetch[f].values) break;
+    }
+    if (f < NUMBER_OF_FETCHES || !o->schema.names || !o->schema.types) {
+        outputFree(o);
+        fmuError("out of memory");
+        return NULL;
+    }
+    for (k=0; vars[k]; k++) {
+        ScalarVariable* sv = vars[k];
+        Fetch* fetch = &o->fetch[fetchOf(sv->typeSpec->type)];
+        if (getAlias(sv)!=enu_noAlias) continue;
+        fetch->vr[fetch->n] = getValueReference(sv);
+        fetch->columns[fetch->n++] = o->schema.nColumns;
+        o->schema.names[o->schema.nColumns] = getName(sv);
+        o->schema.types[o->schema.nColumns++] = sv->typeSpec->type;
+    }
+    o->batch.times = (double*)calloc(OUTPUT_BATCH, sizeof(double));
+    o->batch.values = (SinkValue*)calloc(OUTPUT_BATCH * o->schema.nColumns + 1, sizeof(SinkValue));
+    if (!o->batch.times || !o->batch.values) {
+        outputFree(o);
+        fmuError("out of memory");
+        return NULL;
+    }
+    for (s=sinks; s; s=s->next) {
+        if (!s->begin(s, &o->schema)) {
+            outputFree(o);
+            return NULL;
+        }
+    }
+    return o;
+}
+
+// Fetch the values of instance c at the given time as a row, and write
+// the rows to the sinks when the batch is full.
+// Returns 0 to indicate error
+int outputSample(Output* o, fmiComponent c, double time) {
+    FMU* fmu = o->fmu;
+    Fetch* fetch = o->fetch;
+    SinkValue* row = o->batch.values + o->batch.nRows * o->schema.nColumns;
+    fmiStatus status = fmiOK;
+    int k;
+    if (fetch[fReal].n > 0)
+        status = fmu->getReal(c, fetch[fReal].vr, fetch[fReal].n, (fmiReal*)fetch[fReal].values);
+    if (status <= fmiWarning && fetch[fInteger].n > 0)
+        status = fmu->getInteger(c, fetch[fInteger].vr, fetch[fInteger].n, (fmiInteger*)fetch[fInteger].values);
+    if (status <= fmiWarning && fetch[fBoolean].n > 0)
+        status = fmu->getBoolean(c, fetch[fBoolean].vr, fetch[fBoolean].n, (fmiBoolean*)fetch[fBoolean].values);
+    if (status <= fmiWarning && fetch[fString].n > 0)
+        status = fmu->getString(c, fetch[fString].vr, fetch[fString].n, (fmiString*)fetch[fString].values);
+    if (status > fmiWarning) return fmuError("could not get the values of the variables");
+    for (k=0; k<fetch[fReal].n; k++)
+        row[fetch[fReal].columns[k]].r = ((fmiReal*)fetch[fReal].values)[k];
+    for (k=0; k<fetch[fInteger].n; k++)
+        row[fetch[fInteger].columns[k]].i = ((fmiInteger*)fetch[fInteger].values)[k];
+    for (k=0; k<fetch[fBoolean].n; k++)
+        row[fetch[fBoolean].columns[k]].b = ((fmiBoolean*)fetch[fBoolean].values)[k];
+    for (k=0; k<fetch[fString].n; k++) {
+        fmiString s = ((fmiString*)fetch[fString].values)[k];
+        row[fetch[fString].columns[k]].s = strdup(s ? s : "");
+    }
+    o->batch.times[o->batch.nRows++] = time;
+    return o->batch.nRows < OUTPUT_BATCH || flush(o);
+}
+
+// Write the remaining rows, end the sinks and free the output.
+// Returns 0 to indicate error
+int outputClose(Output* o) {
+    Sink* s;
+    Sink* next;
+    int ok = flush(o);
+    for (s=o->sinks; s; s=next) {
+        next = s->next;
+        if (!s->end(s, &o->schema)) ok = 0;
+    }
+    outputFree(o);
+    return ok;
+}
+
+// End the sinks of the output of a failed simulation, which remove their
+// files, and free the output
+void outputAbort(Output* o) {
+    Sink* s;
+    Sink* next;
+    o->schema.failed = 1;
+    for (s=o->sinks; s; s=next) {
+        next = s->next;
+        s->end(s, &o->schema);
+    }
+    clearStrings(&o->schema, &o->batch);
+    outputFree(o);
+}
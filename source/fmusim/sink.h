@@ -0,0 +1,69 @@
+/* -------------------------------------------------------------------------
+ * sink.h
+ * Destinations of the rows of a simulation result: CSV and binary files,
+ * callbacks, downsampling and a shared-memory publisher
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef sink_h
+#define sink_h
+
+#include "main.h"
+
+#define OUTPUT_BATCH 64              // rows fetched before they are written
+#define BINARY_MAGIC "FMUSIMB1"
+#define PUBLISH_MAGIC "FMUSIMP1"
+
+// the columns of a result, following the time column
+typedef struct {
+    int nColumns;
+    const char** names;
+    Elm* types;                      // elm_Real, elm_Integer, elm_Boolean or elm_String
+    int failed;                      // 1 at the end of a failed simulation
+} Schema;
+
+typedef union {
+    fmiReal r;
+    fmiInteger i;                    // also for enumerations
+    fmiBoolean b;
+    fmiString s;                     // valid until the write returns
+} SinkValue;
+
+// rows of a result, the values of each row stored one after the other
+typedef struct {
+    int nRows;
+    double* times;
+    SinkValue* values;               // nColumns values per row
+} RowBatch;
+
+// a destination of rows. Each function returns 0 to indicate error.
+// end also frees the sink. At the end of a failed simulation, sinks that
+// write a file remove it.
+typedef struct Sink Sink;
+struct Sink {
+    int (*begin)(Sink* s, Schema* schema);
+    int (*write)(Sink* s, Schema* schema, RowBatch* batch);
+    int (*end)(Sink* s, Schema* schema);
+    Sink* next;                      // the next sink of a list, or NULL
+};
+
+// called with each batch of rows. Returns 0 to indicate error
+typedef int (*SinkCallback)(void* arg, Schema* schema, RowBatch* batch);
+
+// the values of the variables of an instance, fetched once per row and
+// written to a list of sinks
+typedef struct Output Output;
+
+Sink* csvSink(const char* path, char separator);
+Sink* binarySink(const char* path);
+Sink* callbackSink(SinkCallback f, void* arg);
+Sink* downsampleSink(Sink* target, double interval);
+Sink* publishSink(const char* name);
+
+Output* outputOpen(FMU* fmu, Sink* sinks);
+int outputSample(Output* o, fmiComponent c, double time);
+int outputClose(Output* o);
+void outputAbort(Output* o);
+
+#endif // sink_h
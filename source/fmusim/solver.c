@@ -0,0 +1,138 @@
+/* -------------------------------------------------------------------------
+ * solver.c
+ * Fixed-step integration methods for continuous states of an FMU.
+ * All methods are explicit one-step methods. Each stage evaluates the
+ * derivatives of the FMU once, after setting time and states of the stage.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <string.h>
+#include <math.h>
+#include "solver.h"
+#include "fmuio.h"
+
+const char *mthNames[SIZEOF_MTH] = {
+    "euler", "heun", "rk4"
+};
+
+// Returns -1 to indicate an unknown method name
+int getMethod(const char* name) {
+    int i;
+    for (i=0; i<SIZEOF_MTH; i++)
+        if (!strcmp(name, mthNames[i])) return i;
+    return -1;
+}
+
+// order of consistency of the method
+int getOrder(Method m) {
+    switch (m) {
+        case mth_euler: return 1;
+        case mth_heun:  return 2;
+        case mth_rk4:   return 4;
+        default:        return 0;
+    }
+}
+
+// number of derivative evaluations per step
+int getStages(Method m) {
+    return getOrder(m);
+}
+
+// size of the work array required by solverStep
+int getWorkSize(Method m, int nx) {
+    return (getStages(m) + 1) * nx;
+}
+
+// set time and states of a stage and get the derivatives there
+static int evalStage(FMU* fmu, fmiComponent c, double time, const double x[],
+        double xdot[], int nx) {
+    fmiStatus fmiFlag;
+    fmiFlag = fmu->setTime(c, time);
+    if (fmiFlag > fmiWarning) return fmuError("could not set time");
+    fmiFlag = fmu->setContinuousStates(c, x, nx);
+    if (fmiFlag > fmiWarning) return fmuError("could not set states");
+    fmiFlag = fmu->getDerivatives(c, xdot, nx);
+    if (fmiFlag > fmiWarning) return fmuError("could not retrieve derivatives");
+    return 1; // success
+}
+
+// Advance the continuous states x from time to time+dt using method m.
+// The fmu must be at the given time with states x when called.
+// On return, x holds the new states and the fmu is at time+dt with states x.
+// work is an array of at least getWorkSize(m, nx) elements.
+// Returns 0 to indicate error.
+int solverStep(FMU* fmu, fmiComponent c, Method m, double time, double dt,
+        double x[], int nx, double work[]) {
+    int i;
+    fmiStatus fmiFlag;
+    double* x0 = work;        // states at the begin of the step
+    double* k1 = work + nx;   // derivatives of the stages
+    double* k2 = work + 2*nx;
+    double* k3 = work + 3*nx;
+    double* k4 = work + 4*nx;
+
+    fmiFlag = fmu->getDerivatives(c, k1, nx);
+    if (fmiFlag > fmiWarning) return fmuError("could not retrieve derivatives");
+    switch (m) {
+        case mth_euler:
+            for (i=0; i<nx; i++) x[i] += dt*k1[i];
+            break;
+        case mth_heun:
+            for (i=0; i<nx; i++) { x0[i] = x[i]; x[i] += dt*k1[i]; }
+            if (!evalStage(fmu, c, time+dt, x, k2, nx)) return 0;
+            for (i=0; i<nx; i++) x[i] = x0[i] + dt/2*(k1[i] + k2[i]);
+            break;
+        case mth_rk4:
+            for (i=0; i<nx; i++) { x0[i] = x[i]; x[i] = x0[i] + dt/2*k1[i]; }
+            if (!evalStage(fmu, c, time+dt/2, x, k2, nx)) return 0;
+            for (i=0; i<nx; i++) x[i] = x0[i] + dt/2*k2[i];
+            if (!evalStage(fmu, c, time+dt/2, x, k3, nx)) return 0;
+            for (i=0; i<nx; i++) x[i] = x0[i] + dt*k3[i];
+            if (!evalStage(fmu, c, time+dt, x, k4, nx)) return 0;
+            for (i=0; i<nx; i++)
+                x[i] = x0[i] + dt/6*(k1[i] + 2*k2[i] + 2*k3[i] + k4[i]);
+            break;
+    }
+    fmiFlag = fmu->setTime(c, time+dt);
+    if (fmiFlag > fmiWarning) return fmuError("could not set time");
+    fmiFlag = fmu->setContinuousStates(c, x, nx);
+    if (fmiFlag > fmiWarning) return fmuError("could not set states");
+    return 1; // success
+}
+
+// number of derivative evaluations of solverError
+int getErrorStages(Method m) {
+    return m == mth_euler ? 1 : 0;
+}
+
+// Estimate the local error of each state in the step of size dt just taken
+// by solverStep, from the stages left in work: the difference to the embedded
+// solution of lower order, which is Euler for heun and the trapezoidal rule
+// for rk4. Euler has none, and is compared to heun instead, evaluating the
+// derivatives at the end of the step once more.
+// Returns 0 to indicate error.
+int solverError(FMU* fmu, fmiComponent c, Method m, double dt, int nx,
+        double work[], double err[]) {
+    int i;
+    fmiStatus fmiFlag;
+    double* k1 = work + nx;
+    double* k2 = work + 2*nx;
+    double* k3 = work + 3*nx;
+    double* k4 = work + 4*nx;
+    switch (m) {
+        case mth_euler:
+            // the fmu is at the end of the step, x0 is not used by euler
+            fmiFlag = fmu->getDerivatives(c, work, nx);
+            if (fmiFlag > fmiWarning) return fmuError("could not retrieve derivatives");
+            for (i=0; i<nx; i++) err[i] = fabs(dt/2*(work[i] - k1[i]));
+            break;
+        case mth_heun:
+            for (i=0; i<nx; i++) err[i] = fabs(dt/2*(k2[i] - k1[i]));
+            break;
+        case mth_rk4:
+            for (i=0; i<nx; i++) err[i] = fabs(dt/3*(k2[i] + k3[i] - k1[i] - k4[i]));
+            break;
+    }
+    return 1; // success
+}
@@ -0,0 +1,32 @@
+/* -------------------------------------------------------------------------
+ * solver.h
+ * Fixed-step integration methods for continuous states of an FMU.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef solver_h
+#define solver_h
+
+#include "main.h"
+
+#define SIZEOF_MTH 3
+extern const char *mthNames[SIZEOF_MTH];
+
+// Integration methods
+typedef enum {
+    mth_euler, mth_heun, mth_rk4
+} Method;
+
+int getMethod(const char* name);
+int getOrder(Method m);
+int getStages(Method m);
+int getWorkSize(Method m, int nx);
+
+extern int solverStep(FMU* fmu, fmiComponent c, Method m, double time, double dt,
+        double x[], int nx, double work[]);
+int getErrorStages(Method m);
+int solverError(FMU* fmu, fmiComponent c, Method m, double dt, int nx,
+        double work[], double err[]);
+
+#endif // solver_h
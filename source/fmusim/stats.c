@@ -0,0 +1,156 @@
+/* -------------------------------------------------------------------------
+ * stats.c
+ * Live progress statistics of an ensemble run, written to a file.
+ * The workers update their own counters in the stats block with relaxed
+ * atomic stores, see fmuthread.c, and the status of a case is a single byte
+ * stored by the worker running the case. Hence the simulation takes no lock,
+ * makes no system call and issues no memory barrier for the statistics. As
+ * each counter has a single writer, adding to it needs no atomic
+ * read-modify-write. The simulated time is counted in integer ticks of
+ * tEnd/STATS_TICKS, so that it is a 64-bit word like the other counters.
+ * A separate thread reads the block every STATS_INTERVAL with relaxed atomic
+ * loads and rewrites the stats file: the file is written under a temporary
+ * name and then renamed, so readers always see a complete file. Values read
+ * while a worker updates them may be one slice old.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stats.h"
+#include "fmuio.h"
+
+#define STATS_TICK 100               // milliseconds between checks for the end
+
+// Rewrite the stats file. Returns 0 to indicate error
+static int writeStats(Stats* st) {
+    int i;
+    long long nSteps = 0, nEvents = 0, nRows = 0, nSlices = 0, ticks = 0;
+    long count[256];
+    double simulated, progress, eta, rate;
+    double now = wallClock();
+    char* tmpPath;
+    FILE* file;
+    for (i=0; i<st->nWorkers; i++) {
+        StatsWorker* w = &st->workers[i];
+        nSlices += atomicLoad(&w->nSlices);
+        nSteps += atomicLoad(&w->nSteps);
+        nEvents += atomicLoad(&w->nEvents);
+        nRows += atomicLoad(&w->nRows);
+        ticks += atomicLoad(&w->simulated);
+    }
+    memset(count, 0, sizeof(count));
+    for (i=0; i<st->nCases; i++) count[(unsigned char)atomicLoadChar(&st->cases[i])]++;
+    // skipped cases count as simulated
+    simulated = (ticks / (double)STATS_TICKS + count[CASE_SKIPPED]) * st->tEnd;
+    progress = st->tEnd > 0 ? simulated / (st->nCases * st->tEnd) : 1;
+    if (progress > 1) progress = 1;
+    eta = progress > 0 ? (now - st->start) * (1 - progress) / progress : -1;
+    rate = now > st->last ? (nSteps - st->lastSteps) / (now - st->last) : 0;
+    st->last = now;
+    st->lastSteps = nSteps;
+
+    tmpPath = (char*)calloc(strlen(st->path) + 5, sizeof(char));
+    if (!tmpPath) return fmuError("out of memory");
+    sprintf(tmpPath, "%s.tmp", st->path);
+    file = fopen(tmpPath, "w");
+    if (!file) {
+        free(tmpPath);
+        return fmuError("could not write stats file");
+    }
+    fprintf(file, "elapsed %.1f\n", now - st->start);
+    fprintf(file, "progress %.4f\n", progress);
+    fprintf(file, "eta %.0f\n", eta);
+    fprintf(file, "time %.16g\n", st->nCases > 0 ? simulated / st->nCases : 0);
+    fprintf(file, "steps %lld\n", nSteps);
+    fprintf(file, "steps/s %.0f\n", rate);
+    fprintf(file, "slices %lld\n", nSlices);
+    fprintf(file, "events %lld\n", nEvents);
+    fprintf(file, "rows %lld\n", nRows);
+    fprintf(file, "cases %d\n", st->nCases);
+    fprintf(file, "waiting %ld\n", count[CASE_WAITING]);
+    fprintf(file, "running %ld\n", count[CASE_RUNNING]);
+    fprintf(file, "done %ld\n", count[CASE_DONE]);
+    fprintf(file, "stopped %ld\n", count[CASE_STOPPED]);
+    fprintf(file, "failed %ld\n", count[CASE_FAILED]);
+    fprintf(file, "skipped %ld\n", count[CASE_SKIPPED]);
+    fprintf(file, "status ");
+    for (i=0; i<st->nCases; i++) fputc(atomicLoadChar(&st->cases[i]), file);
+    fprintf(file, "\n");
+    fclose(file);
+#ifdef _MSC_VER
+    remove(st->path); // rename does not replace files on Windows
+#endif
+    i = rename(tmpPath, st->path);
+    free(tmpPath);
+    if (i != 0) return fmuError("could not rename stats file");
+    return 1; // success
+}
+
+static void statsMain(void* arg) {
+    Stats* st = (Stats*)arg;
+    int ms = 0;
+    while (atomicLoadChar(&st->running)) {
+        threadSleep(STATS_TICK);
+        ms += STATS_TICK;
+        if (ms < STATS_INTERVAL) continue;
+        writeStats(st);
+        ms = 0;
+    }
+}
+
+// Start writing the statistics of a run of nCases cases on nWorkers
+// workers to the file at path.
+// Returns NULL to indicate error
+Stats* statsOpen(const char* path, int nWorkers, int nCases, double tEnd) {
+    Stats* st = (Stats*)calloc(1, sizeof(Stats));
+    if (!st) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    st->path = path;
+    st->nWorkers = nWorkers;
+    st->nCases = nCases;
+    st->tEnd = tEnd;
+    st->workers = (StatsWorker*)calloc(nWorkers, sizeof(StatsWorker));
+    st->cases = (char*)malloc(nCases + 1);
+    if (!st->workers || !st->cases) {
+        fmuError("out of memory");
+        return NULL;
+    }
+    memset(st->cases, CASE_WAITING, nCases);
+    st->start = st->last = wallClock();
+    st->running = 1;
+    if (!threadCreate(&st->thread, statsMain, st)) {
+        fmuError("could not create stats thread");
+        return NULL;
+    }
+    return st;
+}
+
+// Stop the stats thread, write the final statistics and free st
+void statsClose(Stats* st) {
+    atomicStoreChar(&st->running, 0);
+    threadJoin(st->thread);
+    writeStats(st);
+    free(st->workers);
+    free(st->cases);
+    free(st);
+}
+
+// add n to a counter of the calling worker
+void statsAdd(AtomicCount* counter, long long n) {
+    atomicStore(counter, atomicLoad(counter) + n);
+}
+
+// the ticks of simulated time from 0 to time
+long long statsTicks(Stats* st, double time) {
+    return st->tEnd > 0 ? (long long)(time / st->tEnd * STATS_TICKS + 0.5) : 0;
+}
+
+// set the status of case i, by the worker running it
+void statsCase(Stats* st, int i, char status) {
+    atomicStoreChar(&st->cases[i], status);
+}
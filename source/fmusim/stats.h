@@ -0,0 +1,55 @@
+/* -------------------------------------------------------------------------
+ * stats.h
+ * Live progress statistics of an ensemble run, written to a file
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef stats_h
+#define stats_h
+
+#include "fmuthread.h"
+
+#define STATS_INTERVAL 1000          // milliseconds between updates of the file
+#define STATS_LINE 64                // bytes of a cache line
+#define STATS_TICKS 1000000          // ticks of simulated time per tEnd
+
+// status of a case, as shown in the stats file
+#define CASE_WAITING  '.'
+#define CASE_RUNNING  'r'
+#define CASE_DONE     'd'
+#define CASE_STOPPED  's'
+#define CASE_FAILED   'f'
+#define CASE_SKIPPED  'k'            // done by an earlier, journaled run
+
+// counters of one worker, written by that worker only, see statsAdd
+typedef struct {
+    AtomicCount nSlices;
+    AtomicCount nSteps;
+    AtomicCount nEvents;
+    AtomicCount nRows;               // dataset rows recorded
+    AtomicCount simulated;           // ticks of simulated time, summed over instances
+    char pad[STATS_LINE];            // keep workers on separate cache lines
+} StatsWorker;
+
+typedef struct {
+    const char* path;
+    int nWorkers;
+    StatsWorker* workers;
+    int nCases;
+    char* cases;                     // status of each case, see statsCase
+    double tEnd;
+    double start;                    // wall clock at the start of the run
+    double last;                     // wall clock at the last update
+    long long lastSteps;             // steps at the last update
+    Thread thread;                   // writes the file every STATS_INTERVAL
+    char running;
+} Stats;
+
+Stats* statsOpen(const char* path, int nWorkers, int nCases, double tEnd);
+void statsAdd(AtomicCount* counter, long long n);
+long long statsTicks(Stats* st, double time);
+void statsCase(Stats* st, int i, char status);
+void statsClose(Stats* st);
+
+#endif // stats_h
@@ -0,0 +1,173 @@
+/* -------------------------------------------------------------------------
+ * stop.c
+ * Conditions that stop a case of an ensemble run before tEnd.
+ * A condition is either "nonfinite", which holds when a continuous state is
+ * NaN or infinite, or <name><op><value> with op one of < <= > >= == !=,
+ * e.g. "T>373.15" or "time>=5". The conditions are compiled once: names are
+ * resolved to value references, or to columns of the dataset rows. They are
+ * checked after every step, or with a dataset after every row, which is
+ * then used instead of getting the values from the fmu again.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "stop.h"
+#include "fmuio.h"
+
+static const char* opNames[] = { "<", "<=", ">", ">=", "==", "!=" };
+
+// Returns 0 to indicate error
+static int parseOp(const char* s, StopOp* op, int* length) {
+    int k;
+    // two-letter operators first, as they start like one-letter ones
+    for (k=opNotEqual; k>=0; k--) {
+        if (!strncmp(s, opNames[k], strlen(opNames[k]))) {
+            *op = (StopOp)k;
+            *length = strlen(opNames[k]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// column of the dataset rows holding the variable, -1 if none
+static int findColumn(Dataset* ds, Elm type, fmiValueReference vr) {
+    int k;
+    for (k=1; ds && k<ds->nColumns; k++) {
+        if (ds->types[k] == type && ds->vrs[k] == vr) return k;
+    }
+    return -1;
+}
+
+// Returns 0 to indicate error
+static int compileTerm(StopTerm* t, const char* text, ModelDescription* md, Dataset* ds) {
+    char* name;
+    char* end;
+    int n, length;
+    ScalarVariable* sv;
+    t->text = text;
+    t->column = -1;
+    if (!strcmp(text, STOP_NONFINITE)) {
+        t->kind = stopNonFinite;
+        return 1; // success
+    }
+    n = strcspn(text, "<>=!");
+    if (n == 0 || !text[n] || !parseOp(text + n, &t->op, &length)) {
+        printf("error: Stop condition %s is not <name><op><value>\n", text);
+        return 0;
+    }
+    t->value = strtod(text + n + length, &end);
+    if (end == text + n + length || *end) {
+        printf("error: Stop condition %s does not end with a number\n", text);
+        return 0;
+    }
+    name = (char*)calloc(n + 1, sizeof(char));
+    if (!name) return fmuError("out of memory");
+    strncpy(name, text, n);
+    if (!strcmp(name, STOP_TIME)) {
+        t->kind = stopTime;
+        t->column = ds ? 0 : -1;
+        free(name);
+        return 1; // success
+    }
+    sv = getVariableByName(md, name);
+    free(name);
+    if (!sv || sv->typeSpec->type == elm_String) {
+        printf("error: Variable of stop condition %s not found or a string\n", text);
+        return 0;
+    }
+    t->kind = stopVariable;
+    t->type = sv->typeSpec->type == elm_Enumeration ? elm_Integer : sv->typeSpec->type;
+    t->vr = getValueReference(sv);
+    t->negated = getAlias(sv) == enu_negatedAlias;
+    t->column = findColumn(ds, t->type, t->vr);
+    return 1; // success
+}
+
+// Compile the n given conditions for the model md. If ds is not NULL, the
+// values are taken from its rows.
+// Returns NULL to indicate error
+StopCriteria* stopCompile(const char** conditions, int n, ModelDescription* md, Dataset* ds) {
+    int k;
+    StopCriteria* sc = (StopCriteria*)calloc(1, sizeof(StopCriteria));
+    if (!sc || !(sc->terms = (StopTerm*)calloc(n, sizeof(StopTerm)))) {
+        if (sc) free(sc);
+        fmuError("out of memory");
+        return NULL;
+    }
+    for (k=0; k<n; k++) {
+        if (!compileTerm(&sc->terms[k], conditions[k], md, ds)) {
+            stopFree(sc);
+            return NULL;
+        }
+        sc->nTerms++;
+    }
+    return sc;
+}
+
+// Returns 0 to indicate error
+static int getValue(StopTerm* t, SimInstance* sim, const double* row, double* value) {
+    fmiStatus status = fmiOK;
+    fmiReal r;
+    fmiInteger i;
+    fmiBoolean b;
+    if (t->kind == stopTime) {
+        *value = sim->time;
+        return 1; // success
+    }
+    if (row && t->column >= 0) {
+        *value = row[t->column];
+    }
+    else if (t->type == elm_Real) {
+        status = sim->fmu->getReal(sim->c, &t->vr, 1, &r);
+        *value = r;
+    }
+    else if (t->type == elm_Integer) {
+        status = sim->fmu->getInteger(sim->c, &t->vr, 1, &i);
+        *value = i;
+    }
+    else {
+        status = sim->fmu->getBoolean(sim->c, &t->vr, 1, &b);
+        *value = b;
+    }
+    if (status > fmiWarning) return fmuError("could not get value of stop condition");
+    if (t->negated) *value = t->type == elm_Boolean ? !*value : -*value;
+    return 1; // success
+}
+
+// Check the conditions for the instance sim after a step, using row if it
+// is not NULL. Sets term to the index of the first condition that holds,
+// or to -1 if none holds.
+// Returns 0 to indicate error
+int stopCheck(StopCriteria* sc, SimInstance* sim, const double* row, int* term) {
+    int k, i;
+    double v;
+    StopTerm* t;
+    for (k=0; k<sc->nTerms; k++) {
+        t = &sc->terms[k];
+        *term = k;
+        if (t->kind == stopNonFinite) {
+            // x - x is NaN for NaN and infinite x
+            for (i=0; i<sim->nx; i++) if (sim->x[i] - sim->x[i] != 0) return 1;
+            continue;
+        }
+        if (!getValue(t, sim, row, &v)) return 0;
+        switch (t->op) {
+            case opLess:         if (v <  t->value) return 1; break;
+            case opLessEqual:    if (v <= t->value) return 1; break;
+            case opGreater:      if (v >  t->value) return 1; break;
+            case opGreaterEqual: if (v >= t->value) return 1; break;
+            case opEqual:        if (v == t->value) return 1; break;
+            case opNotEqual:     if (v != t->value) return 1; break;
+        }
+    }
+    *term = -1;
+    return 1; // success
+}
+
+void stopFree(StopCriteria* sc) {
+    free(sc->terms);
+    free(sc);
+}
@@ -0,0 +1,47 @@
+/* -------------------------------------------------------------------------
+ * stop.h
+ * Conditions that stop a case of an ensemble run before tEnd
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef stop_h
+#define stop_h
+
+#include "fmusim.h"
+#include "dataset.h"
+
+#define STOP_NONFINITE "nonfinite"   // condition: a state is NaN or infinite
+#define STOP_TIME "time"             // name of the simulation time
+
+typedef enum {
+    stopNonFinite, stopTime, stopVariable
+} StopKind;
+
+typedef enum {
+    opLess, opLessEqual, opGreater, opGreaterEqual, opEqual, opNotEqual
+} StopOp;
+
+// one compiled condition <name><op><value>
+typedef struct {
+    const char* text;                // the condition as given
+    StopKind kind;
+    Elm type;                        // elm_Real, elm_Integer or elm_Boolean
+    fmiValueReference vr;
+    int negated;                     // 1 for a negated alias
+    int column;                      // in the dataset rows, -1 if not there
+    StopOp op;
+    double value;
+} StopTerm;
+
+// disjunction of conditions: a case stops when one of them holds
+typedef struct {
+    int nTerms;
+    StopTerm* terms;
+} StopCriteria;
+
+StopCriteria* stopCompile(const char** conditions, int n, ModelDescription* md, Dataset* ds);
+int stopCheck(StopCriteria* sc, SimInstance* sim, const double* row, int* term);
+void stopFree(StopCriteria* sc);
+
+#endif // stop_h
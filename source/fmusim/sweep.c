@@ -0,0 +1,126 @@
+/* -------------------------------------------------------------------------
+ * sweep.c
+ * Parameter values of the cases of an ensemble run.
+ * A sweep file is a CSV file with the names of the swept variables in its
+ * first line, and the values of one case in each following line. Columns
+ * are separated by the CSV separator of the run, and if that is not ',',
+ * a ',' may be used as decimal point, as in the result file.
+ * The values of a case are set after instantiation, before initialization.
+ * A sweep is identified by a 32-bit FNV-1a hash of the names of its
+ * variables and of its values as read, e.g. in the header of a journal.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sweep.h"
+#include "fmuio.h"
+#include "csvtable.h"
+#include "fmuthread.h"
+
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME 16777619UL
+
+// the FNV-1a hash of n bytes of data, continuing from hash
+static unsigned long hashBytes(unsigned long hash, const void* data, size_t n) {
+    const unsigned char* p = (const unsigned char*)data;
+    size_t i;
+    for (i=0; i<n; i++) hash = ((hash ^ p[i]) * FNV_PRIME) & 0xffffffffUL;
+    return hash;
+}
+
+// Returns 0 to indicate error
+static int findParameters(Sweep* sweep, CsvTable* table, ModelDescription* md) {
+    int k;
+    ScalarVariable* sv;
+    sweep->parameters = (ScalarVariable**)calloc(table->nColumns, sizeof(ScalarVariable*));
+    if (!sweep->parameters) return fmuError("out of memory");
+    for (k=0; k<table->nColumns; k++) {
+        sv = getVariableByName(md, table->names[k]);
+        if (!sv) {
+            printf("error: Swept variable %s not found\n", table->names[k]);
+            return 0;
+        }
+        if (sv->typeSpec->type == elm_String) {
+            printf("error: Swept variable %s is a string\n", table->names[k]);
+            return 0;
+        }
+        sweep->parameters[sweep->nParameters++] = sv;
+    }
+    return 1; // success
+}
+
+// Read the sweep file at path for the given model.
+// Returns NULL to indicate error
+Sweep* sweepLoad(const char* path, ModelDescription* md, char separator) {
+    int k;
+    long i;
+    CsvTable* table = csvRead(path, separator, threadCount());
+    Sweep* sweep;
+    if (!table) return NULL;
+    sweep = (Sweep*)calloc(1, sizeof(Sweep));
+    if (!sweep || !findParameters(sweep, table, md)) {
+        if (sweep) sweepFree(sweep);
+        csvFree(table);
+        return NULL;
+    }
+    if (table->nRows == 0) {
+        printf("error: Sweep file %s has no cases\n", path);
+        sweepFree(sweep);
+        csvFree(table);
+        return NULL;
+    }
+    sweep->nCases = table->nRows;
+    sweep->values = (double*)malloc(sweep->nCases * sweep->nParameters * sizeof(double));
+    if (!sweep->values) {
+        fmuError("out of memory");
+        sweepFree(sweep);
+        csvFree(table);
+        return NULL;
+    }
+    for (k=0; k<sweep->nParameters; k++) {
+        for (i=0; i<sweep->nCases; i++) {
+            sweep->values[i * sweep->nParameters + k] = table->columns[k][i];
+        }
+    }
+    sweep->hash = FNV_OFFSET;
+    for (k=0; k<sweep->nParameters; k++)
+        sweep->hash = hashBytes(sweep->hash, table->names[k], strlen(table->names[k]) + 1);
+    sweep->hash = hashBytes(sweep->hash, sweep->values,
+            sweep->nCases * sweep->nParameters * sizeof(double));
+    csvFree(table);
+    return sweep;
+}
+
+// Set the parameters of the instantiated model c to the values of case id.
+// Returns 0 to indicate error
+int sweepApply(Sweep* sweep, FMU* fmu, fmiComponent c, int id) {
+    int k;
+    fmiStatus status;
+    double* values = sweep->values + id * sweep->nParameters;
+    for (k=0; k<sweep->nParameters; k++) {
+        ScalarVariable* sv = sweep->parameters[k];
+        fmiValueReference vr = getValueReference(sv);
+        fmiReal r = values[k];
+        fmiInteger i = (fmiInteger)values[k];
+        fmiBoolean b = values[k] != 0;
+        switch (sv->typeSpec->type) {
+            case elm_Real:    status = fmu->setReal(c, &vr, 1, &r); break;
+            case elm_Boolean: status = fmu->setBoolean(c, &vr, 1, &b); break;
+            default:          status = fmu->setInteger(c, &vr, 1, &i); break;
+        }
+        if (status > fmiWarning) {
+            printf("error: Could not set %s of case %d\n", getName(sv), id);
+            return 0;
+        }
+    }
+    return 1; // success
+}
+
+void sweepFree(Sweep* sweep) {
+    if (sweep->parameters) free(sweep->parameters);
+    if (sweep->values) free(sweep->values);
+    free(sweep);
+}
@@ -0,0 +1,25 @@
+/* -------------------------------------------------------------------------
+ * sweep.h
+ * Parameter values of the cases of an ensemble run
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef sweep_h
+#define sweep_h
+
+#include "main.h"
+
+typedef struct {
+    int nParameters;
+    ScalarVariable** parameters;     // the swept variables
+    int nCases;
+    double* values;                  // nParameters values of each case
+    unsigned long hash;              // of the names and values, identifies the sweep
+} Sweep;
+
+Sweep* sweepLoad(const char* path, ModelDescription* md, char separator);
+int sweepApply(Sweep* sweep, FMU* fmu, fmiComponent c, int id);
+void sweepFree(Sweep* sweep);
+
+#endif // sweep_h
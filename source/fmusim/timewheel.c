@@ -0,0 +1,187 @@
+/* -------------------------------------------------------------------------
+ * timewheel.c
+ * A hierarchical timing wheel that orders entries by time.
+ * Time is discretized into ticks of the given resolution. An entry is kept
+ * at the lowest level l whose block of TW_SLOTS^(l+1) ticks it shares with
+ * the current tick now, in the slot given by digit l of its tick in base
+ * TW_SLOTS. Hence all entries of level 0 precede those of level 1 and so on,
+ * and all entries of a level-0 slot have the same tick. Insertion is O(1).
+ * When level 0 runs empty, the next occupied slot of a higher level is found
+ * using the occupancy bitmaps, and its entries are cascaded down, which
+ * costs O(1) amortized per entry and level. Entries beyond the span of the
+ * wheel are kept in a binary heap until the wheel reaches their block.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "timewheel.h"
+
+#define TW_MASK (TW_SLOTS - 1)
+#define TW_EPS 1e-9 // relative tolerance when rounding times to ticks
+
+// Returns NULL to indicate error
+TimingWheel* twNew(double t0, double resolution) {
+    int l, s;
+    TimingWheel* w = (TimingWheel*)calloc(1, sizeof(TimingWheel));
+    if (!w) return NULL;
+    w->t0 = t0;
+    w->resolution = resolution;
+    for (l=0; l<TW_LEVELS; l++)
+        for (s=0; s<TW_SLOTS; s++)
+            w->slots[l][s].next = w->slots[l][s].prev = &w->slots[l][s];
+    return w;
+}
+
+// the first tick at or after the given time
+Tick twTick(TimingWheel* w, double time) {
+    double t = (time - w->t0) / w->resolution;
+    return t > 0 ? (Tick)ceil(t - TW_EPS) : 0;
+}
+
+double twTime(TimingWheel* w, Tick tick) {
+    return w->t0 + tick * w->resolution;
+}
+
+// -------------------------------------------------------------------------
+// Overflow heap
+
+static int heapPush(TimingWheel* w, TwNode* node) {
+    int i, parent;
+    if (w->heapSize == w->heapCapacity) {
+        int n = w->heapCapacity ? 2 * w->heapCapacity : 64;
+        TwNode** heap = (TwNode**)realloc(w->heap, n * sizeof(TwNode*));
+        if (!heap) return 0; // error
+        w->heap = heap;
+        w->heapCapacity = n;
+    }
+    for (i = w->heapSize++; i > 0; i = parent) {
+        parent = (i - 1) / 2;
+        if (w->heap[parent]->tick <= node->tick) break;
+        w->heap[i] = w->heap[parent];
+    }
+    w->heap[i] = node;
+    return 1; // success
+}
+
+static TwNode* heapPop(TimingWheel* w) {
+    int i, child;
+    TwNode* top = w->heap[0];
+    TwNode* last = w->heap[--w->heapSize];
+    for (i = 0; (child = 2*i + 1) < w->heapSize; i = child) {
+        if (child + 1 < w->heapSize && w->heap[child+1]->tick < w->heap[child]->tick) child++;
+        if (last->tick <= w->heap[child]->tick) break;
+        w->heap[i] = w->heap[child];
+    }
+    if (w->heapSize > 0) w->heap[i] = last;
+    return top;
+}
+
+// -------------------------------------------------------------------------
+// Wheel
+
+// index of the first used slot >= from at level l, or -1
+static int nextUsedSlot(TimingWheel* w, int l, int from) {
+    int k, b;
+    unsigned int bits;
+    for (k = from / 32; k < TW_WORDS; k++) {
+        bits = w->used[l][k];
+        if (k == from / 32) bits &= ~0u << (from % 32);
+        if (!bits) continue;
+        for (b = 0; !(bits & (1u << b)); b++);
+        return k * 32 + b;
+    }
+    return -1;
+}
+
+// Insert node into the wheel or heap, without counting it.
+// Returns 0 to indicate error
+static int place(TimingWheel* w, TwNode* node) {
+    int l = 0;
+    Tick diff = node->tick ^ w->now;
+    TwNode* head;
+    int slot;
+    while (diff >= TW_SLOTS && l < TW_LEVELS) {
+        diff >>= TW_BITS;
+        l++;
+    }
+    if (l == TW_LEVELS) return heapPush(w, node);
+    slot = (int)(node->tick >> (l * TW_BITS)) & TW_MASK;
+    head = &w->slots[l][slot];
+    node->next = head;
+    node->prev = head->prev;
+    head->prev->next = node;
+    head->prev = node;
+    w->used[l][slot / 32] |= 1u << (slot % 32);
+    return 1; // success
+}
+
+// Remove and return the list of entries in the given slot
+static TwNode* takeSlot(TimingWheel* w, int l, int slot) {
+    TwNode* head = &w->slots[l][slot];
+    TwNode* first = head->next;
+    head->prev->next = NULL; // terminate the list
+    head->next = head->prev = head;
+    w->used[l][slot / 32] &= ~(1u << (slot % 32));
+    return first;
+}
+
+// Schedule node at the given tick. Ticks before the current tick are
+// scheduled at the current tick.
+// Returns 0 to indicate error
+int twInsert(TimingWheel* w, TwNode* node, Tick tick) {
+    node->tick = tick < w->now ? w->now : tick;
+    if (!place(w, node)) return 0; // error
+    w->count++;
+    return 1; // success
+}
+
+// Remove all entries with the smallest tick and return them as a list,
+// linked by next and terminated by NULL. The wheel advances to that tick.
+// Returns NULL if the wheel is empty.
+TwNode* twPopNext(TimingWheel* w, int* n) {
+    int l, slot;
+    TwNode* list;
+    TwNode* node;
+    *n = 0;
+    while (w->count > 0) {
+        // entries in the current block of level 0
+        slot = nextUsedSlot(w, 0, (int)(w->now & TW_MASK));
+        if (slot >= 0) {
+            w->now = (w->now & ~(Tick)TW_MASK) | slot;
+            list = takeSlot(w, 0, slot);
+            for (node = list; node; node = node->next) (*n)++;
+            w->count -= *n;
+            return list;
+        }
+        // advance to the next used block of a higher level and cascade it
+        for (l = 1; l < TW_LEVELS; l++) {
+            int shift = l * TW_BITS;
+            slot = nextUsedSlot(w, l, (int)((w->now >> shift) & TW_MASK) + 1);
+            if (slot < 0) continue;
+            w->now = (w->now >> (shift + TW_BITS) << (shift + TW_BITS)) | ((Tick)slot << shift);
+            list = takeSlot(w, l, slot);
+            while (list) {
+                node = list;
+                list = list->next;
+                place(w, node);
+            }
+            break;
+        }
+        if (l < TW_LEVELS) continue;
+        // the wheel is empty, continue with the block of the earliest heap entry
+        if (w->heapSize == 0) break;
+        w->now = w->heap[0]->tick;
+        while (w->heapSize > 0
+                && (w->heap[0]->tick ^ w->now) >> (TW_LEVELS * TW_BITS) == 0) {
+            place(w, heapPop(w));
+        }
+    }
+    return NULL;
+}
+
+void twFree(TimingWheel* w) {
+    if (w->heap) free(w->heap);
+    free(w);
+}
@@ -0,0 +1,45 @@
+/* -------------------------------------------------------------------------
+ * timewheel.h
+ * A hierarchical timing wheel that orders entries by time.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef timewheel_h
+#define timewheel_h
+
+#define TW_BITS 8                    // log2 of the number of slots per level
+#define TW_SLOTS (1 << TW_BITS)
+#define TW_LEVELS 4                  // the wheel spans 2^32 ticks
+#define TW_WORDS (TW_SLOTS / 32)     // words of the slot occupancy bitmaps
+
+typedef unsigned long long Tick;
+
+// An entry of the wheel, to be embedded in the scheduled object
+typedef struct TwNode {
+    struct TwNode* next;
+    struct TwNode* prev;
+    Tick tick;
+    void* data;                      // the scheduled object
+} TwNode;
+
+typedef struct {
+    double t0;                       // time of tick 0
+    double resolution;               // time between two ticks
+    Tick now;                        // tick of the last popped entries
+    int count;                       // number of entries in the wheel and heap
+    TwNode slots[TW_LEVELS][TW_SLOTS];          // sentinels of circular lists
+    unsigned int used[TW_LEVELS][TW_WORDS];     // bit set if slot is not empty
+    TwNode** heap;                   // min-heap of entries beyond the wheel span
+    int heapSize;
+    int heapCapacity;
+} TimingWheel;
+
+TimingWheel* twNew(double t0, double resolution);
+Tick twTick(TimingWheel* w, double time);
+double twTime(TimingWheel* w, Tick tick);
+int twInsert(TimingWheel* w, TwNode* node, Tick tick);
+TwNode* twPopNext(TimingWheel* w, int* n);
+void twFree(TimingWheel* w);
+
+#endif // timewheel_h
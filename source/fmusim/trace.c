@@ -0,0 +1,884 @@
+/* -------------------------------------------------------------------------
+ * trace.c
+ * Recording of the FMU calls of a simulation, and their replay against
+ * the FMU to time and check the model apart from the simulator.
+ * While recording, the functions of the FMU are replaced by wrappers that
+ * call the FMU and append the call to the trace. The trace is a binary
+ * file in the byte order of the machine that wrote it:
+ *   TRACE_MAGIC, the guid of the fmu
+ *   one record per call: function (1 byte), instance (int), the inputs
+ *   of the call, its status (int) and its outputs
+ * Arrays are written as their length (int) followed by the elements,
+ * strings as their length (int, -1 for NULL) followed by the characters.
+ * Instances are numbered in the order of instantiation.
+ * The replay issues the recorded calls in the recorded order, with the
+ * recorded inputs, to the given FMU, e.g. a new build of the recorded one.
+ * It measures the wall time spent in each function of the FMU, excluding
+ * the reading of the trace, and compares statuses and outputs with the
+ * recorded ones. Outputs of calls that failed when recorded are ignored.
+ * Model states are opaque: setModelState gets the recorded bytes, which
+ * a build with a different model state layout cannot restore.
+ * Only one simulation can be recorded at a time, from a single thread.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "trace.h"
+#include "fmu2.h"
+#include "fmuio.h"
+#include "fmuthread.h"
+
+// the recorded functions of an fmu
+typedef enum {
+    opInstantiate, opFree, opSetDebugLogging, opSetTime, opSetContinuousStates,
+    opCompletedIntegratorStep, opSetReal, opSetInteger, opSetBoolean, opSetString,
+    opInitialize, opGetDerivatives, opGetEventIndicators, opGetReal, opGetInteger,
+    opGetBoolean, opGetString, opEventUpdate, opGetContinuousStates,
+    opGetNominalContinuousStates, opGetStateValueReferences, opTerminate,
+    opGetModelStateSize, opGetModelState, opSetModelState, opGetDirectionalDerivative,
+    NUMBER_OF_OPS
+} TraceOp;
+
+static const char* opNames[NUMBER_OF_OPS] = {
+    "instantiateModel", "freeModelInstance", "setDebugLogging", "setTime",
+    "setContinuousStates", "completedIntegratorStep", "setReal", "setInteger",
+    "setBoolean", "setString", "initialize", "getDerivatives", "getEventIndicators",
+    "getReal", "getInteger", "getBoolean", "getString", "eventUpdate",
+    "getContinuousStates", "getNominalContinuousStates", "getStateValueReferences",
+    "terminate", "getModelStateSize", "getModelState", "setModelState",
+    "getDirectionalDerivative"
+};
+
+// instances of the fmu in the order of instantiation, NULL once freed
+typedef struct {
+    fmiComponent* c;
+    int n;
+    int size;
+} Instances;
+
+// Returns the number of the new instance, or -1 to indicate error
+static int addInstance(Instances* in, fmiComponent c) {
+    fmiComponent* grown;
+    if (in->n == in->size) {
+        grown = (fmiComponent*)realloc(in->c, (2 * in->size + 4) * sizeof(fmiComponent));
+        if (!grown) return -1;
+        in->c = grown;
+        in->size = 2 * in->size + 4;
+    }
+    in->c[in->n] = c;
+    return in->n++;
+}
+
+// Returns the number of the instance, or -1 if not found
+static int indexOf(Instances* in, fmiComponent c) {
+    int i;
+    for (i=0; c && i<in->n; i++) {
+        if (in->c[i] == c) return i;
+    }
+    return -1;
+}
+
+// -------------------------------------------------------------------------
+// Recording
+
+static FMU traced;                   // the recorded fmu, with its own functions
+static FILE* trace;                  // the trace being recorded
+static Instances recorded;
+
+static void writeInt(int i) {
+    fwrite(&i, sizeof(int), 1, trace);
+}
+
+static void writeDouble(double d) {
+    fwrite(&d, sizeof(double), 1, trace);
+}
+
+static void writeBoolean(fmiBoolean b) {
+    fputc(b, trace);
+}
+
+static void writeArray(const void* a, size_t n, size_t size) {
+    writeInt((int)n);
+    if (n > 0) fwrite(a, size, n, trace);
+}
+
+static void writeString(fmiString s) {
+    if (s) writeArray(s, strlen(s), 1);
+    else writeInt(-1);
+}
+
+static void writeEventInfo(const fmiEventInfo* e) {
+    writeBoolean(e->iterationConverged);
+    writeBoolean(e->stateValueReferencesChanged);
+    writeBoolean(e->stateValuesChanged);
+    writeBoolean(e->terminateSimulation);
+    writeBoolean(e->upcomingTimeEvent);
+    writeDouble(e->nextEventTime);
+}
+
+static void writeCall(TraceOp op, fmiComponent c) {
+    fputc(op, trace);
+    writeInt(indexOf(&recorded, c));
+}
+
+static fmiComponent traceInstantiate(fmiString instanceName, fmiString GUID,
+        fmiCallbackFunctions functions, fmiBoolean loggingOn) {
+    fmiComponent c;
+    if (traced.fmi2) c = fmu2Instantiate(&traced, instanceName, functions, loggingOn);
+    else c = traced.instantiateModel(instanceName, GUID, functions, loggingOn);
+    fputc(opInstantiate, trace);
+    writeInt(c ? addInstance(&recorded, c) : -1);
+    writeString(instanceName);
+    writeBoolean(loggingOn);
+    return c;
+}
+
+static void traceFree(fmiComponent c) {
+    int i = indexOf(&recorded, c);
+    writeCall(opFree, c);
+    traced.freeModelInstance(c);
+    if (i >= 0) recorded.c[i] = NULL;
+}
+
+static fmiStatus traceSetDebugLogging(fmiComponent c, fmiBoolean loggingOn) {
+    fmiStatus status = traced.setDebugLogging(c, loggingOn);
+    writeCall(opSetDebugLogging, c);
+    writeBoolean(loggingOn);
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceSetTime(fmiComponent c, fmiReal time) {
+    fmiStatus status = traced.setTime(c, time);
+    writeCall(opSetTime, c);
+    writeDouble(time);
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceSetContinuousStates(fmiComponent c, const fmiReal x[], size_t nx) {
+    fmiStatus status = traced.setContinuousStates(c, x, nx);
+    writeCall(opSetContinuousStates, c);
+    writeArray(x, nx, sizeof(fmiReal));
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceCompletedIntegratorStep(fmiComponent c, fmiBoolean* callEventUpdate) {
+    fmiStatus status = traced.completedIntegratorStep(c, callEventUpdate);
+    writeCall(opCompletedIntegratorStep, c);
+    writeInt(status);
+    writeBoolean(*callEventUpdate);
+    return status;
+}
+
+static fmiStatus traceSetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        const fmiReal value[]) {
+    fmiStatus status = traced.setReal(c, vr, nvr, value);
+    writeCall(opSetReal, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    writeArray(value, nvr, sizeof(fmiReal));
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceSetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        const fmiInteger value[]) {
+    fmiStatus status = traced.setInteger(c, vr, nvr, value);
+    writeCall(opSetInteger, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    writeArray(value, nvr, sizeof(fmiInteger));
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceSetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        const fmiBoolean value[]) {
+    fmiStatus status = traced.setBoolean(c, vr, nvr, value);
+    writeCall(opSetBoolean, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    writeArray(value, nvr, sizeof(fmiBoolean));
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceSetString(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        const fmiString value[]) {
+    size_t i;
+    fmiStatus status = traced.setString(c, vr, nvr, value);
+    writeCall(opSetString, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    for (i=0; i<nvr; i++) writeString(value[i]);
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceInitialize(fmiComponent c, fmiBoolean toleranceControlled,
+        fmiReal relativeTolerance, fmiEventInfo* eventInfo) {
+    fmiStatus status = traced.initialize(c, toleranceControlled, relativeTolerance, eventInfo);
+    writeCall(opInitialize, c);
+    writeBoolean(toleranceControlled);
+    writeDouble(relativeTolerance);
+    writeInt(status);
+    writeEventInfo(eventInfo);
+    return status;
+}
+
+static fmiStatus traceGetDerivatives(fmiComponent c, fmiReal derivatives[], size_t nx) {
+    fmiStatus status = traced.getDerivatives(c, derivatives, nx);
+    writeCall(opGetDerivatives, c);
+    writeInt((int)nx);
+    writeInt(status);
+    writeArray(derivatives, nx, sizeof(fmiReal));
+    return status;
+}
+
+static fmiStatus traceGetEventIndicators(fmiComponent c, fmiReal eventIndicators[], size_t ni) {
+    fmiStatus status = traced.getEventIndicators(c, eventIndicators, ni);
+    writeCall(opGetEventIndicators, c);
+    writeInt((int)ni);
+    writeInt(status);
+    writeArray(eventIndicators, ni, sizeof(fmiReal));
+    return status;
+}
+
+static fmiStatus traceGetReal(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        fmiReal value[]) {
+    fmiStatus status = traced.getReal(c, vr, nvr, value);
+    writeCall(opGetReal, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    writeInt(status);
+    writeArray(value, nvr, sizeof(fmiReal));
+    return status;
+}
+
+static fmiStatus traceGetInteger(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        fmiInteger value[]) {
+    fmiStatus status = traced.getInteger(c, vr, nvr, value);
+    writeCall(opGetInteger, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    writeInt(status);
+    writeArray(value, nvr, sizeof(fmiInteger));
+    return status;
+}
+
+static fmiStatus traceGetBoolean(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        fmiBoolean value[]) {
+    fmiStatus status = traced.getBoolean(c, vr, nvr, value);
+    writeCall(opGetBoolean, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    writeInt(status);
+    writeArray(value, nvr, sizeof(fmiBoolean));
+    return status;
+}
+
+static fmiStatus traceGetString(fmiComponent c, const fmiValueReference vr[], size_t nvr,
+        fmiString value[]) {
+    size_t i;
+    fmiStatus status = traced.getString(c, vr, nvr, value);
+    writeCall(opGetString, c);
+    writeArray(vr, nvr, sizeof(fmiValueReference));
+    writeInt(status);
+    for (i=0; i<nvr; i++) writeString(status > fmiWarning ? NULL : value[i]);
+    return status;
+}
+
+static fmiStatus traceEventUpdate(fmiComponent c, fmiBoolean intermediateResults,
+        fmiEventInfo* eventInfo) {
+    fmiStatus status = traced.eventUpdate(c, intermediateResults, eventInfo);
+    writeCall(opEventUpdate, c);
+    writeBoolean(intermediateResults);
+    writeInt(status);
+    writeEventInfo(eventInfo);
+    return status;
+}
+
+static fmiStatus traceGetContinuousStates(fmiComponent c, fmiReal states[], size_t nx) {
+    fmiStatus status = traced.getContinuousStates(c, states, nx);
+    writeCall(opGetContinuousStates, c);
+    writeInt((int)nx);
+    writeInt(status);
+    writeArray(states, nx, sizeof(fmiReal));
+    return status;
+}
+
+static fmiStatus traceGetNominalContinuousStates(fmiComponent c, fmiReal x_nominal[], size_t nx) {
+    fmiStatus status = traced.getNominalContinuousStates(c, x_nominal, nx);
+    writeCall(opGetNominalContinuousStates, c);
+    writeInt((int)nx);
+    writeInt(status);
+    writeArray(x_nominal, nx, sizeof(fmiReal));
+    return status;
+}
+
+static fmiStatus traceGetStateValueReferences(fmiComponent c, fmiValueReference vrx[], size_t nx) {
+    fmiStatus status = traced.getStateValueReferences(c, vrx, nx);
+    writeCall(opGetStateValueReferences, c);
+    writeInt((int)nx);
+    writeInt(status);
+    writeArray(vrx, nx, sizeof(fmiValueReference));
+    return status;
+}
+
+static fmiStatus traceTerminate(fmiComponent c) {
+    fmiStatus status = traced.terminate(c);
+    writeCall(opTerminate, c);
+    writeInt(status);
+    return status;
+}
+
+static size_t traceGetModelStateSize(fmiComponent c) {
+    size_t size = traced.getModelStateSize(c);
+    writeCall(opGetModelStateSize, c);
+    writeInt((int)size);
+    return size;
+}
+
+static fmiStatus traceGetModelState(fmiComponent c, void* state, size_t size) {
+    fmiStatus status = traced.getModelState(c, state, size);
+    writeCall(opGetModelState, c);
+    writeInt((int)size);
+    writeInt(status);
+    writeArray(state, size, 1);
+    return status;
+}
+
+static fmiStatus traceSetModelState(fmiComponent c, const void* state, size_t size) {
+    fmiStatus status = traced.setModelState(c, state, size);
+    writeCall(opSetModelState, c);
+    writeArray(state, size, 1);
+    writeInt(status);
+    return status;
+}
+
+static fmiStatus traceGetDirectionalDerivative(fmiComponent c, const fmiValueReference vUnknown[],
+        size_t nUnknown, const fmiValueReference vKnown[], size_t nKnown,
+        const fmiReal dvKnown[], fmiReal dvUnknown[]) {
+    fmiStatus status = traced.getDirectionalDerivative(c, vUnknown, nUnknown,
+            vKnown, nKnown, dvKnown, dvUnknown);
+    writeCall(opGetDirectionalDerivative, c);
+    writeArray(vUnknown, nUnknown, sizeof(fmiValueReference));
+    writeArray(vKnown, nKnown, sizeof(fmiValueReference));
+    writeArray(dvKnown, nKnown, sizeof(fmiReal));
+    writeInt(status);
+    writeArray(dvUnknown, nUnknown, sizeof(fmiReal));
+    return status;
+}
+
+// Record the calls of the fmu to the trace at path, until traceClose.
+// The functions of fmu are replaced by recording wrappers.
+// Returns 0 to indicate error
+int traceRecord(FMU* fmu, const char* path) {
+    trace = fopen(path, "wb");
+    if (!trace) {
+        printf("error: Could not open trace file %s\n", path);
+        return 0;
+    }
+    fwrite(TRACE_MAGIC, 1, strlen(TRACE_MAGIC), trace);
+    writeString(getString(fmu->modelDescription, att_guid));
+    traced = *fmu;
+    fmu->fmi2 = NULL; // instances of FMI 2.0 are created by traceInstantiate
+    fmu->instantiateModel        = traceInstantiate;
+    fmu->freeModelInstance       = traceFree;
+    fmu->setDebugLogging         = traceSetDebugLogging;
+    fmu->setTime                 = traceSetTime;
+    fmu->setContinuousStates     = traceSetContinuousStates;
+    fmu->completedIntegratorStep = traceCompletedIntegratorStep;
+    fmu->setReal                 = traceSetReal;
+    fmu->setInteger              = traceSetInteger;
+    fmu->setBoolean              = traceSetBoolean;
+    fmu->setString               = traceSetString;
+    fmu->initialize              = traceInitialize;
+    fmu->getDerivatives          = traceGetDerivatives;
+    fmu->getEventIndicators      = traceGetEventIndicators;
+    fmu->getReal                 = traceGetReal;
+    fmu->getInteger              = traceGetInteger;
+    fmu->getBoolean              = traceGetBoolean;
+    fmu->getString               = traceGetString;
+    fmu->eventUpdate             = traceEventUpdate;
+    fmu->getContinuousStates     = traceGetContinuousStates;
+    fmu->getNominalContinuousStates = traceGetNominalContinuousStates;
+    fmu->getStateValueReferences = traceGetStateValueReferences;
+    fmu->terminate               = traceTerminate;
+    if (fmu->getModelStateSize) fmu->getModelStateSize = traceGetModelStateSize;
+    if (fmu->getModelState) fmu->getModelState = traceGetModelState;
+    if (fmu->setModelState) fmu->setModelState = traceSetModelState;
+    if (fmu->getDirectionalDerivative)
+        fmu->getDirectionalDerivative = traceGetDirectionalDerivative;
+    return 1; // success
+}
+
+// Stop recording and restore the functions of fmu.
+// Returns 0 to indicate error
+int traceClose(FMU* fmu) {
+    int ok = !ferror(trace);
+    ok = !fclose(trace) && ok;
+    if (!ok) printf("error: Could not write trace file\n");
+    *fmu = traced;
+    trace = NULL;
+    if (recorded.c) free(recorded.c);
+    memset(&recorded, 0, sizeof(Instances));
+    return ok;
+}
+
+// -------------------------------------------------------------------------
+// Replay
+
+// buffers for the arrays of a call
+typedef enum {
+    bfVr, bfVr2, bfIn, bfOut, bfTrace,
+    NUMBER_OF_BUFFERS
+} Buffer;
+
+typedef struct {
+    FILE* file;
+    FMU* fmu;
+    fmiBoolean loggingOn;
+    Instances instances;
+    int failed;                      // 1 if the trace is truncated or memory is out
+    void* buffers[NUMBER_OF_BUFFERS];
+    size_t sizes[NUMBER_OF_BUFFERS];
+    long call;                       // number of the current call
+    long nCalls[NUMBER_OF_OPS];
+    double seconds[NUMBER_OF_OPS];   // wall time spent in the fmu
+    long nMismatches;                // calls whose status or outputs differ from the trace
+    long firstMismatch;              // number of the first such call
+    long lastMismatch;               // number of the last such call
+    double maxDeviation;             // largest difference of a Real output
+} Replay;
+
+// call the fmu, adding the wall time of the call to its function
+#define TIMED(call) (start = wallClock(), call, r->seconds[op] += wallClock() - start)
+
+// Returns a buffer of at least size bytes, or NULL to indicate error
+static void* reserve(Replay* r, Buffer b, size_t size) {
+    void* grown;
+    if (size > r->sizes[b]) {
+        grown = realloc(r->buffers[b], size);
+        if (!grown) {
+            fmuError("out of memory");
+            r->failed = 1;
+            return NULL;
+        }
+        r->buffers[b] = grown;
+        r->sizes[b] = size;
+    }
+    return r->buffers[b];
+}
+
+static int readInt(Replay* r) {
+    int i = 0;
+    if (fread(&i, sizeof(int), 1, r->file) != 1) r->failed = 1;
+    return i;
+}
+
+static double readDouble(Replay* r) {
+    double d = 0;
+    if (fread(&d, sizeof(double), 1, r->file) != 1) r->failed = 1;
+    return d;
+}
+
+static fmiBoolean readBoolean(Replay* r) {
+    int c = fgetc(r->file);
+    if (c == EOF) r->failed = 1;
+    return (fmiBoolean)c;
+}
+
+// Read an array of elements of the given size into buffer b, and its length into n.
+// Returns NULL to indicate error
+static void* readArray(Replay* r, Buffer b, size_t size, int* n) {
+    void* a;
+    *n = readInt(r);
+    if (r->failed || *n < 0) {
+        r->failed = 1;
+        return NULL;
+    }
+    a = reserve(r, b, *n * size + 1);
+    if (!a) return NULL;
+    if (*n > 0 && fread(a, size, *n, r->file) != (size_t)*n) r->failed = 1;
+    return a;
+}
+
+// Returns the string allocated with malloc, or NULL
+static char* readString(Replay* r) {
+    char* s;
+    int n = readInt(r);
+    if (r->failed || n < 0) return NULL;
+    s = (char*)malloc(n + 1);
+    if (!s) {
+        fmuError("out of memory");
+        r->failed = 1;
+        return NULL;
+    }
+    if (n > 0 && fread(s, 1, n, r->file) != (size_t)n) r->failed = 1;
+    s[n] = '\0';
+    return s;
+}
+
+// Read n strings into buffer b. Returns NULL to indicate error
+static char** readStrings(Replay* r, Buffer b, int n) {
+    int i;
+    char** s = (char**)reserve(r, b, (n + 1) * sizeof(char*));
+    if (!s) return NULL;
+    for (i=0; i<n; i++) s[i] = readString(r);
+    return s;
+}
+
+static void freeStrings(char** s, int n) {
+    int i;
+    for (i=0; s && i<n; i++) {
+        if (s[i]) free(s[i]);
+    }
+}
+
+static void readEventInfo(Replay* r, fmiEventInfo* e) {
+    e->iterationConverged = readBoolean(r);
+    e->stateValueReferencesChanged = readBoolean(r);
+    e->stateValuesChanged = readBoolean(r);
+    e->terminateSimulation = readBoolean(r);
+    e->upcomingTimeEvent = readBoolean(r);
+    e->nextEventTime = readDouble(r);
+}
+
+// count the current call as a mismatch, once however many of its
+// outputs differ
+static void mismatch(Replay* r) {
+    if (r->nMismatches > 0 && r->lastMismatch == r->call) return;
+    if (r->nMismatches++ == 0) r->firstMismatch = r->call;
+    r->lastMismatch = r->call;
+}
+
+// Compare the status with the recorded one.
+// Returns 1 if the recorded outputs are valid
+static int checkStatus(Replay* r, fmiStatus status) {
+    int recorded = readInt(r);
+    if (!r->failed && recorded != status) mismatch(r);
+    return !r->failed && recorded <= fmiWarning;
+}
+
+static void compareReals(Replay* r, const fmiReal* recorded, const fmiReal* x, int n) {
+    int i, differ = 0;
+    double d;
+    for (i=0; i<n; i++) {
+        if (recorded[i] == x[i] || (recorded[i] != recorded[i] && x[i] != x[i])) continue;
+        differ = 1;
+        d = fabs(recorded[i] - x[i]);
+        if (d != d) d = HUGE_VAL;
+        if (d > r->maxDeviation) r->maxDeviation = d;
+    }
+    if (differ) mismatch(r);
+}
+
+static void compareBytes(Replay* r, const void* recorded, const void* x, size_t n) {
+    if (n > 0 && memcmp(recorded, x, n)) mismatch(r);
+}
+
+static void compareEventInfo(Replay* r, const fmiEventInfo* recorded, const fmiEventInfo* e) {
+    if (recorded->iterationConverged != e->iterationConverged
+            || recorded->stateValueReferencesChanged != e->stateValueReferencesChanged
+            || recorded->stateValuesChanged != e->stateValuesChanged
+            || recorded->terminateSimulation != e->terminateSimulation
+            || recorded->upcomingTimeEvent != e->upcomingTimeEvent) mismatch(r);
+    else if (e->upcomingTimeEvent) compareReals(r, &recorded->nextEventTime, &e->nextEventTime, 1);
+}
+
+// Replay the call to function op read from the trace.
+// Returns 0 to indicate error
+static int replayCall(Replay* r, TraceOp op) {
+    FMU* fmu = r->fmu;
+    fmiComponent c = NULL;
+    fmiCallbackFunctions callbacks;
+    fmiStatus status = fmiOK;
+    fmiEventInfo e, recordedInfo;
+    fmiBoolean b, recordedFlag;
+    char* name;
+    char** strings;
+    char** recordedStrings;
+    void* vr;
+    void* vr2;
+    void* in;
+    void* out;
+    void* recordedOut;
+    double d, start;
+    size_t size;
+    int i, n, n2, ok;
+
+    i = readInt(r);
+    if (op != opInstantiate) {
+        c = i >= 0 && i < r->instances.n ? r->instances.c[i] : NULL;
+        if (!c && !r->failed) {
+            printf("error: Call %ld of the trace uses instance %d, which does not exist\n", r->call, i);
+            return 0;
+        }
+    }
+    if ((op == opGetModelStateSize && !fmu->getModelStateSize)
+            || (op == opGetModelState && !fmu->getModelState)
+            || (op == opSetModelState && !fmu->setModelState)
+            || (op == opGetDirectionalDerivative && !fmu->getDirectionalDerivative)) {
+        printf("error: The fmu does not provide %s, called by the trace\n", opNames[op]);
+        return 0;
+    }
+    switch (op) {
+        case opInstantiate:
+            name = readString(r);
+            b = readBoolean(r);
+            if (r->failed) {
+                if (name) free(name);
+                break;
+            }
+            callbacks.logger = fmuLogger;
+            callbacks.allocateMemory = calloc;
+            callbacks.freeMemory = free;
+            TIMED(c = fmu->fmi2 ? fmu2Instantiate(fmu, name, callbacks, b && r->loggingOn)
+                    : fmu->instantiateModel(name, getString(fmu->modelDescription, att_guid),
+                            callbacks, b && r->loggingOn));
+            free(name);
+            if (i >= 0 && !c) return fmuError("could not instantiate model");
+            if (i < 0 && c) {
+                mismatch(r);
+                fmu->freeModelInstance(c);
+            }
+            else if (c && addInstance(&r->instances, c) != i) return fmuError("out of memory");
+            break;
+        case opFree:
+            TIMED(fmu->freeModelInstance(c));
+            r->instances.c[i] = NULL;
+            break;
+        case opSetDebugLogging:
+            b = readBoolean(r);
+            TIMED(status = fmu->setDebugLogging(c, b && r->loggingOn));
+            checkStatus(r, status);
+            break;
+        case opSetTime:
+            d = readDouble(r);
+            TIMED(status = fmu->setTime(c, d));
+            checkStatus(r, status);
+            break;
+        case opSetContinuousStates:
+            in = readArray(r, bfIn, sizeof(fmiReal), &n);
+            if (r->failed) break;
+            TIMED(status = fmu->setContinuousStates(c, (fmiReal*)in, n));
+            checkStatus(r, status);
+            break;
+        case opCompletedIntegratorStep:
+            TIMED(status = fmu->completedIntegratorStep(c, &b));
+            ok = checkStatus(r, status);
+            recordedFlag = readBoolean(r);
+            if (ok && recordedFlag != b) mismatch(r);
+            break;
+        case opSetReal:
+        case opSetInteger:
+        case opSetBoolean:
+            vr = readArray(r, bfVr, sizeof(fmiValueReference), &n);
+            in = readArray(r, bfIn, op == opSetReal ? sizeof(fmiReal)
+                    : op == opSetInteger ? sizeof(fmiInteger) : sizeof(fmiBoolean), &n2);
+            if (r->failed) break;
+            if (op == opSetReal)
+                TIMED(status = fmu->setReal(c, (fmiValueReference*)vr, n, (fmiReal*)in));
+            else if (op == opSetInteger)
+                TIMED(status = fmu->setInteger(c, (fmiValueReference*)vr, n, (fmiInteger*)in));
+            else
+                TIMED(status = fmu->setBoolean(c, (fmiValueReference*)vr, n, (fmiBoolean*)in));
+            checkStatus(r, status);
+            break;
+        case opSetString:
+            vr = readArray(r, bfVr, sizeof(fmiValueReference), &n);
+            if (r->failed) break;
+            strings = readStrings(r, bfIn, n);
+            if (!r->failed) {
+                TIMED(status = fmu->setString(c, (fmiValueReference*)vr, n, (fmiString*)strings));
+                checkStatus(r, status);
+            }
+            freeStrings(strings, n);
+            break;
+        case opInitialize:
+            b = readBoolean(r);
+            d = readDouble(r);
+            if (r->failed) break;
+            TIMED(status = fmu->initialize(c, b, d, &e));
+            ok = checkStatus(r, status);
+            readEventInfo(r, &recordedInfo);
+            if (ok && !r->failed) compareEventInfo(r, &recordedInfo, &e);
+            break;
+        case opGetDerivatives:
+        case opGetEventIndicators:
+        case opGetContinuousStates:
+        case opGetNominalContinuousStates:
+            n = readInt(r);
+            out = r->failed ? NULL : reserve(r, bfOut, (n + 1) * sizeof(fmiReal));
+            if (r->failed) break;
+            if (op == opGetDerivatives)
+                TIMED(status = fmu->getDerivatives(c, (fmiReal*)out, n));
+            else if (op == opGetEventIndicators)
+                TIMED(status = fmu->getEventIndicators(c, (fmiReal*)out, n));
+            else if (op == opGetContinuousStates)
+                TIMED(status = fmu->getContinuousStates(c, (fmiReal*)out, n));
+            else
+                TIMED(status = fmu->getNominalContinuousStates(c, (fmiReal*)out, n));
+            ok = checkStatus(r, status);
+            recordedOut = readArray(r, bfTrace, sizeof(fmiReal), &n2);
+            if (ok && !r->failed) compareReals(r, (fmiReal*)recordedOut, (fmiReal*)out, n);
+            break;
+        case opGetReal:
+        case opGetInteger:
+        case opGetBoolean:
+            vr = readArray(r, bfVr, sizeof(fmiValueReference), &n);
+            size = op == opGetReal ? sizeof(fmiReal)
+                    : op == opGetInteger ? sizeof(fmiInteger) : sizeof(fmiBoolean);
+            out = r->failed ? NULL : reserve(r, bfOut, (n + 1) * size);
+            if (r->failed) break;
+            if (op == opGetReal)
+                TIMED(status = fmu->getReal(c, (fmiValueReference*)vr, n, (fmiReal*)out));
+            else if (op == opGetInteger)
+                TIMED(status = fmu->getInteger(c, (fmiValueReference*)vr, n, (fmiInteger*)out));
+            else
+                TIMED(status = fmu->getBoolean(c, (fmiValueReference*)vr, n, (fmiBoolean*)out));
+            ok = checkStatus(r, status);
+            recordedOut = readArray(r, bfTrace, size, &n2);
+            if (!ok || r->failed) break;
+            if (op == opGetReal) compareReals(r, (fmiReal*)recordedOut, (fmiReal*)out, n);
+            else compareBytes(r, recordedOut, out, n * size);
+            break;
+        case opGetString:
+            vr = readArray(r, bfVr, sizeof(fmiValueReference), &n);
+            strings = r->failed ? NULL : (char**)reserve(r, bfOut, (n + 1) * sizeof(char*));
+            if (r->failed) break;
+            TIMED(status = fmu->getString(c, (fmiValueReference*)vr, n, (fmiString*)strings));
+            ok = checkStatus(r, status);
+            recordedStrings = readStrings(r, bfTrace, n);
+            for (i=0; ok && !r->failed && i<n; i++) {
+                if (!strings[i] != !recordedStrings[i]
+                        || (strings[i] && strcmp(strings[i], recordedStrings[i]))) {
+                    mismatch(r);
+                    break;
+                }
+            }
+            freeStrings(recordedStrings, n);
+            break;
+        case opEventUpdate:
+            b = readBoolean(r);
+            if (r->failed) break;
+            TIMED(status = fmu->eventUpdate(c, b, &e));
+            ok = checkStatus(r, status);
+            readEventInfo(r, &recordedInfo);
+            if (ok && !r->failed) compareEventInfo(r, &recordedInfo, &e);
+            break;
+        case opGetStateValueReferences:
+            n = readInt(r);
+            out = r->failed ? NULL : reserve(r, bfOut, (n + 1) * sizeof(fmiValueReference));
+            if (r->failed) break;
+            TIMED(status = fmu->getStateValueReferences(c, (fmiValueReference*)out, n));
+            ok = checkStatus(r, status);
+            recordedOut = readArray(r, bfTrace, sizeof(fmiValueReference), &n2);
+            if (ok && !r->failed) compareBytes(r, recordedOut, out, n * sizeof(fmiValueReference));
+            break;
+        case opTerminate:
+            TIMED(status = fmu->terminate(c));
+            checkStatus(r, status);
+            break;
+        case opGetModelStateSize:
+            TIMED(size = fmu->getModelStateSize(c));
+            if (readInt(r) != (int)size && !r->failed) mismatch(r);
+            break;
+        case opGetModelState:
+            n = readInt(r);
+            out = r->failed ? NULL : reserve(r, bfOut, n + 1);
+            if (r->failed) break;
+            TIMED(status = fmu->getModelState(c, out, n));
+            ok = checkStatus(r, status);
+            recordedOut = readArray(r, bfTrace, 1, &n2);
+            if (ok && !r->failed) compareBytes(r, recordedOut, out, n);
+            break;
+        case opSetModelState:
+            in = readArray(r, bfIn, 1, &n);
+            if (r->failed) break;
+            TIMED(status = fmu->setModelState(c, in, n));
+            checkStatus(r, status);
+            break;
+        case opGetDirectionalDerivative:
+            vr = readArray(r, bfVr, sizeof(fmiValueReference), &n);
+            vr2 = readArray(r, bfVr2, sizeof(fmiValueReference), &n2);
+            in = readArray(r, bfIn, sizeof(fmiReal), &n2);
+            out = r->failed ? NULL : reserve(r, bfOut, (n + 1) * sizeof(fmiReal));
+            if (r->failed) break;
+            TIMED(status = fmu->getDirectionalDerivative(c, (fmiValueReference*)vr, n,
+                    (fmiValueReference*)vr2, n2, (fmiReal*)in, (fmiReal*)out));
+            ok = checkStatus(r, status);
+            recordedOut = readArray(r, bfTrace, sizeof(fmiReal), &n2);
+            if (ok && !r->failed) compareReals(r, (fmiReal*)recordedOut, (fmiReal*)out, n);
+            break;
+        default:
+            break;
+    }
+    r->nCalls[op]++;
+    return 1; // success
+}
+
+static void printReplay(Replay* r) {
+    int op;
+    long nCalls = 0;
+    double seconds = 0;
+    printf("  %-27s %10s %12s %12s\n", "function", "calls", "seconds", "ns per call");
+    for (op=0; op<NUMBER_OF_OPS; op++) {
+        if (r->nCalls[op] == 0) continue;
+        printf("  %-27s %10ld %12.6f %12.1f\n", opNames[op], r->nCalls[op], r->seconds[op],
+                1e9 * r->seconds[op] / r->nCalls[op]);
+        nCalls += r->nCalls[op];
+        seconds += r->seconds[op];
+    }
+    printf("  %-27s %10ld %12.6f %12.1f\n", "total", nCalls, seconds,
+            nCalls > 0 ? 1e9 * seconds / nCalls : 0.0);
+    printf("  calls that differ . %ld", r->nMismatches);
+    if (r->nMismatches > 0) printf(", the first is call %ld", r->firstMismatch);
+    printf("\n");
+    printf("  max deviation ..... %g\n", r->maxDeviation);
+}
+
+// Replay the trace at path against fmu, and report the time spent in the
+// fmu and how its outputs differ from the recorded ones.
+// Returns 0 to indicate error
+int traceReplay(FMU* fmu, const char* path, fmiBoolean loggingOn) {
+    Replay r;
+    char magic[sizeof(TRACE_MAGIC)];
+    char* guid;
+    int op, b, ok = 1;
+    memset(&r, 0, sizeof(Replay));
+    r.fmu = fmu;
+    r.loggingOn = loggingOn;
+    r.file = fopen(path, "rb");
+    if (!r.file) {
+        printf("error: Could not open trace file %s\n", path);
+        return 0;
+    }
+    memset(magic, 0, sizeof(magic));
+    if (fread(magic, 1, strlen(TRACE_MAGIC), r.file) != strlen(TRACE_MAGIC)
+            || strcmp(magic, TRACE_MAGIC)) {
+        printf("error: %s is not a trace of fmusim\n", path);
+        fclose(r.file);
+        return 0;
+    }
+    guid = readString(&r);
+    if (guid && strcmp(guid, getString(fmu->modelDescription, att_guid)))
+        printf("warning: The trace %s was recorded with an fmu of guid %s\n", path, guid);
+    if (guid) free(guid);
+    while (ok && !r.failed && (op = fgetc(r.file)) != EOF) {
+        if (op >= NUMBER_OF_OPS) {
+            printf("error: Call %ld of the trace %s is invalid\n", r.call, path);
+            ok = 0;
+        }
+        else ok = replayCall(&r, (TraceOp)op);
+        r.call++;
+    }
+    if (r.failed) printf("error: Replay of the trace %s stopped at call %ld\n", path, r.call - 1);
+    printReplay(&r);
+    for (b=0; b<NUMBER_OF_BUFFERS; b++) {
+        if (r.buffers[b]) free(r.buffers[b]);
+    }
+    if (r.instances.c) free(r.instances.c);
+    fclose(r.file);
+    return ok && !r.failed;
+}
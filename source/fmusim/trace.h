@@ -0,0 +1,20 @@
+/* -------------------------------------------------------------------------
+ * trace.h
+ * Recording of the FMU calls of a simulation, and their replay against
+ * the FMU to time and check the model apart from the simulator
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef trace_h
+#define trace_h
+
+#include "main.h"
+
+#define TRACE_MAGIC "FMUTR001"
+
+int traceRecord(FMU* fmu, const char* path);
+int traceClose(FMU* fmu);
+int traceReplay(FMU* fmu, const char* path, fmiBoolean loggingOn);
+
+#endif // trace_h
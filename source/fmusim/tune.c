@@ -0,0 +1,248 @@
+/* -------------------------------------------------------------------------
+ * tune.c
+ * Automatic selection of integration method and step size for an FMU.
+ * The FMU is simulated over a short probe window with every method and a
+ * sequence of step sizes, each run on its own instance of the FMU.
+ * The runs are distributed over all available processors.
+ * The error of each run is measured against a reference solution computed
+ * by Richardson extrapolation of two runs of the most accurate method.
+ * The cheapest configuration, measured in derivative evaluations,
+ * that meets the requested tolerance is selected.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "tune.h"
+#include "fmuio.h"
+#include "fmuthread.h"
+
+#define PROBE_FRACTION 0.1 // length of the probe window relative to tEnd
+#define K_MIN 3            // largest probed step size is window/2^K_MIN
+#define K_MAX 14           // smallest probed step size is window/2^K_MAX
+#define K_REF (K_MAX+2)    // step size of the reference solution
+#define BUFSIZE 4096
+
+// One probe run of the FMU
+typedef struct {
+    Method method;
+    double h;
+    double* x;           // states at the end of the probe window
+    double* nominal;     // nominal values of the states, or NULL
+    long nDerivatives;   // cost of the run
+    double error;        // estimated error of x
+    int ok;              // 1 if the run succeeded
+} Probe;
+
+// Work shared by the threads
+typedef struct {
+    FMU* fmu;
+    double window;
+    Probe* probes;
+    int nProbes;
+    int next;            // index of the next probe to run
+    Mutex mutex;
+} ProbeQueue;
+
+// simulate one probe on a fresh instance of the fmu
+static int runProbe(FMU* fmu, double window, Probe* p) {
+    SimInstance sim;
+    fmiStatus fmiFlag;
+    int ok = simInstantiate(&sim, fmu, getModelIdentifier(fmu->modelDescription),
+            p->method, p->h, fmiFalse) && simInitialize(&sim, 0);
+    while (ok && sim.time < window && !sim.terminated)
+        ok = simDoStep(&sim, window);
+    if (ok) {
+        // states may have been changed by an event at the end of the window
+        fmiFlag = fmu->getContinuousStates(sim.c, p->x, sim.nx);
+        ok = fmiFlag <= fmiWarning;
+    }
+    if (ok && p->nominal) {
+        fmiFlag = fmu->getNominalContinuousStates(sim.c, p->nominal, sim.nx);
+        ok = fmiFlag <= fmiWarning;
+    }
+    p->nDerivatives = sim.nDerivatives;
+    simFree(&sim);
+    return ok;
+}
+
+static void probeWorker(void* arg) {
+    ProbeQueue* q = (ProbeQueue*)arg;
+    Probe* p;
+    for (;;) {
+        mutexLock(&q->mutex);
+        p = q->next < q->nProbes ? &q->probes[q->next++] : NULL;
+        mutexUnlock(&q->mutex);
+        if (!p) return;
+        p->ok = runProbe(q->fmu, q->window, p);
+    }
+}
+
+// run all probes on a pool of threads
+static void runProbes(ProbeQueue* q) {
+    int i;
+    int nThreads = threadCount();
+    Thread* threads = (Thread*)calloc(nThreads, sizeof(Thread));
+    if (nThreads > q->nProbes) nThreads = q->nProbes;
+    for (i=0; i<nThreads; i++) {
+        if (!threadCreate(&threads[i], probeWorker, q)) break;
+    }
+    if (i==0) probeWorker(q); // no threads available, run sequentially
+    while (i-- > 0) threadJoin(threads[i]);
+    free(threads);
+}
+
+// weighted max norm of the difference of x and the reference
+static double errorNorm(const double x[], const double ref[], const double nominal[], int nx) {
+    int i;
+    double e, err = 0;
+    for (i=0; i<nx; i++) {
+        double scale = fabs(ref[i]) > fabs(nominal[i]) ? fabs(ref[i]) : fabs(nominal[i]);
+        e = fabs(x[i] - ref[i]) / (scale > 0 ? scale : 1);
+        if (e > err || e != e) err = e; // NaN counts as error
+    }
+    return err;
+}
+
+// Select the cheapest method and step size that meets the given tolerance.
+// Returns 0 to indicate error
+int fmuTune(FMU* fmu, double tEnd, double tolerance, TuneProfile* profile) {
+    int i, k;
+    int nx = getNumberOfStates(fmu->modelDescription);
+    int nProbes = SIZEOF_MTH * (K_MAX - K_MIN + 1) + 2;
+    double* mem;
+    double* xRef;
+    double* nominal;
+    Probe* best = NULL;
+    Probe *ref1, *ref2;
+    ProbeQueue q;
+    int result = 1;
+
+    if (nx == 0) {
+        printf("model has no continuous states, nothing to tune\n");
+        return 0;
+    }
+    q.fmu = fmu;
+    q.window = tEnd * PROBE_FRACTION;
+    q.nProbes = nProbes;
+    q.next = 0;
+    q.probes = (Probe*)calloc(nProbes, sizeof(Probe));
+    mem = (double*)calloc((nProbes + 2) * nx + 1, sizeof(double));
+    if (!q.probes || !mem) return fmuError("out of memory");
+    xRef = mem + nProbes * nx;
+    nominal = xRef + nx;
+    printf("Auto-tuning for tolerance %g over t=0..%g with %d probes on %d threads\n",
+            tolerance, q.window, nProbes, threadCount());
+
+    // the two reference runs go first, they are the most expensive ones
+    ref1 = &q.probes[0];
+    ref2 = &q.probes[1];
+    ref1->method = ref2->method = mth_rk4;
+    ref1->h = q.window / pow(2, K_REF);
+    ref2->h = ref1->h / 2;
+    ref1->nominal = nominal;
+    for (i=SIZEOF_MTH-1, k=K_MIN, q.next=2; q.next<nProbes; q.next++) {
+        q.probes[q.next].method = i;
+        q.probes[q.next].h = q.window / pow(2, k);
+        if (++k > K_MAX) { k = K_MIN; i--; }
+    }
+    for (i=0; i<nProbes; i++) q.probes[i].x = mem + i*nx;
+    q.next = 0;
+    mutexInit(&q.mutex);
+    runProbes(&q);
+    mutexFree(&q.mutex);
+    if (!ref1->ok || !ref2->ok) {
+        free(q.probes);
+        free(mem);
+        return fmuError("could not compute the reference solution");
+    }
+
+    // Richardson extrapolation of the reference runs
+    for (i=0; i<nx; i++)
+        xRef[i] = ref2->x[i] + (ref2->x[i] - ref1->x[i]) / (pow(2, getOrder(mth_rk4)) - 1);
+
+    // select the cheapest probe that is accurate enough,
+    // print the cheapest accurate probe of each method
+    printf("  method  h                 error        derivatives\n");
+    for (i=2; i<nProbes; i++)
+        q.probes[i].error = q.probes[i].ok ? errorNorm(q.probes[i].x, xRef, nominal, nx) : 0;
+    for (k=0; k<SIZEOF_MTH; k++) {
+        Probe* bestOfMethod = NULL;
+        for (i=2; i<nProbes; i++) {
+            Probe* p = &q.probes[i];
+            if (!p->ok || p->method != k || p->error > tolerance) continue;
+            if (!bestOfMethod || p->nDerivatives < bestOfMethod->nDerivatives)
+                bestOfMethod = p;
+        }
+        if (!bestOfMethod) continue;
+        printf("  %-7s %-17g %-12g %ld\n", mthNames[k], bestOfMethod->h,
+                bestOfMethod->error, bestOfMethod->nDerivatives);
+        if (!best || bestOfMethod->nDerivatives < best->nDerivatives)
+            best = bestOfMethod;
+    }
+    if (!best) {
+        printf("warning: no configuration meets tolerance %g, using the most accurate one\n",
+                tolerance);
+        for (i=2; i<nProbes; i++) {
+            Probe* p = &q.probes[i];
+            if (p->ok && (!best || p->error < best->error)) best = p;
+        }
+    }
+    if (best) {
+        profile->method = best->method;
+        profile->h = best->h;
+        profile->tolerance = tolerance;
+        profile->error = best->error;
+        printf("selected method=%s h=%g (estimated error %g)\n",
+                mthNames[best->method], best->h, best->error);
+    }
+    else result = fmuError("all probe runs failed");
+    free(q.probes);
+    free(mem);
+    return result;
+}
+
+// Returns 0 if there is no profile for the given guid in file path
+int readProfile(const char* path, const char* guid, TuneProfile* profile) {
+    char line[BUFSIZE];
+    char value[BUFSIZE];
+    int guidOk = 0;
+    int n = 0;
+    FILE* file = fopen(path, "r");
+    if (!file) return 0;
+    while (fgets(line, BUFSIZE, file)) {
+        if (sscanf(line, "guid=%s", value) == 1) guidOk = !strcmp(value, guid);
+        else if (sscanf(line, "method=%s", value) == 1) {
+            int m = getMethod(value);
+            if (m != -1) {
+                profile->method = (Method)m;
+                n++;
+            }
+        }
+        else if (sscanf(line, "h=%lf", &profile->h) == 1) n++;
+        else if (sscanf(line, "tolerance=%lf", &profile->tolerance) == 1) n++;
+        else if (sscanf(line, "error=%lf", &profile->error) == 1) n++;
+    }
+    fclose(file);
+    return guidOk && n == 4;
+}
+
+// Returns 0 to indicate error
+int writeProfile(const char* path, const char* guid, TuneProfile* profile) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("could not write %s\n", path);
+        return 0; // failure
+    }
+    fprintf(file, "guid=%s\n", guid);
+    fprintf(file, "method=%s\n", mthNames[profile->method]);
+    fprintf(file, "h=%.16g\n", profile->h);
+    fprintf(file, "tolerance=%.16g\n", profile->tolerance);
+    fprintf(file, "error=%.16g\n", profile->error);
+    fclose(file);
+    printf("Profile '%s' written.\n", path);
+    return 1; // success
+}
@@ -0,0 +1,25 @@
+/* -------------------------------------------------------------------------
+ * tune.h
+ * Automatic selection of integration method and step size for an FMU.
+ * Copyright 2026 FMU SDK contributors. All rights reserved.
+ * -------------------------------------------------------------------------
+ */
+
+#ifndef tune_h
+#define tune_h
+
+#include "fmusim.h"
+
+// A solver configuration selected for a given FMU and tolerance
+typedef struct {
+    Method method;
+    double h;
+    double tolerance;  // requested accuracy
+    double error;      // estimated error in the probe window
+} TuneProfile;
+
+int fmuTune(FMU* fmu, double tEnd, double tolerance, TuneProfile* profile);
+int readProfile(const char* path, const char* guid, TuneProfile* profile);
+int writeProfile(const char* path, const char* guid, TuneProfile* profile);
+
+#endif // tune_h
@@ -8,6 +8,14 @@
  * - ceck element, attribute and enum value names, all case sensitive
  * - check for each element that is has the expected parent element
  * - check for correct sequence of elements
+ * FMI 2.0 model descriptions of Model Exchange FMUs are parsed into the same
+ * AST. Elements not needed for simulation, such as units, log categories and
+ * annotations, are skipped. After parsing, the attributes of FMI 1.0 used by
+ * the simulator are added: modelIdentifier and numberOfContinuousStates to
+ * the root, and alias to each variable that shares its value reference with
+ * an earlier one.
+ * newModelDescription builds the AST of an FMI 1.0 model description from
+ * the table of variables exported by the dll of a model, without any XML.
  * Validation to be performed by this parser
  * - check for each attribute value that it is of the expected type 
  * - check that required attributes are present  
@@ -18,6 +26,7 @@
  * -------------------------------------------------------------------------*/
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
 #include "xml_parser.h"
@@ -26,7 +35,9 @@ const char *elmNames[SIZEOF_ELM] = {
     "fmiModelDescription","UnitDefinitions","BaseUnit","DisplayUnitDefinition","TypeDefinitions",
     "Type","RealType","IntegerType","BooleanType","StringType","EnumerationType","Item",
      "DefaultExperiment","VendorAnnotations","Tool","Annotation", "ModelVariables","ScalarVariable",
-     "DirectDependency", "Name", "Real","Integer","Boolean","String","Enumeration"
+     "DirectDependency", "Name", "Real","Integer","Boolean","String","Enumeration",
+     "ModelExchange","SimpleType","ModelStructure","Outputs","Derivatives","InitialUnknowns",
+     "Unknown"
 };
 
 const char *attNames[SIZEOF_ATT] = {
@@ -34,12 +45,25 @@ const char *attNames[SIZEOF_ATT] = {
     "min","max","nominal","declaredType","start","fixed","startTime","stopTime","tolerance","value",
     "valueReference","variability","causality","alias", "modelName","modelIdentifier","guid","author",
     "version","generationTool","generationDateAndTime","variableNamingConvention","numberOfContinuousStates",
-    "numberOfEventIndicators","input"
+    "numberOfEventIndicators","input","copyright","license","needsExecutionTool",
+    "completedIntegratorStepNotNeeded","canBeInstantiatedOnlyOncePerProcess",
+    "canNotUseMemoryManagementFunctions","canGetAndSetFMUstate","canSerializeFMUstate",
+    "providesDirectionalDerivative","unbounded","stepSize","initial",
+    "canHandleMultipleSetPerTimeInstant","derivative","reinit","index","dependencies",
+    "dependenciesKind"
 };
 
 const char *enuNames[SIZEOF_ENU] = {
     "flat","structured","constant","parameter","discrete","continuous",
-    "input","output", "internal","none","noAlias","alias","negatedAlias"
+    "input","output", "internal","none","noAlias","alias","negatedAlias",
+    "fixed","tunable","local","calculatedParameter","independent","exact","approx",
+    "calculated"
+};
+
+// elements of FMI 2.0 skipped with all their content
+static const char *skippedNames2[] = {
+    "CoSimulation","SourceFiles","UnitDefinitions","LogCategories","VendorAnnotations",
+    "Annotations","Item", NULL
 };
 
 #define ANY_TYPE -1
@@ -49,6 +73,8 @@ XML_Parser parser = NULL;    // non-NULL during parsing
 Stack* stack = NULL;         // the parser stack
 char* data = NULL;           // buffer that holds element content, see handleData
 int skipData=0;              // 1 to ignore element content, 0 when recordig content
+int version2=0;              // 1 while parsing a model description of FMI 2.0
+int skipDepth=0;             // depth of the current element in a skipped element, or 0
 
 // ------------------------------------------------------------------------- 
 // Low-level functions for inspecting the model description 
@@ -127,6 +153,12 @@ Enu getEnumValue(void* element, Att a, ValueStatus* vs) {
 // Convenience methods for accessing the model description. 
 // Use is only safe after the ast has been successfuly validated.
 
+// returns 1 or 2, the major version of FMI of the model description
+int getFmiVersion(ModelDescription* md) {
+    const char* version = getString(md, att_fmiVersion);
+    return version && version[0] == '2' ? 2 : 1;
+}
+
 const char* getModelIdentifier(ModelDescription* md) {
     const char* modelId = getString(md, att_modelIdentifier);
     assert(modelId); // this is a required attribute
@@ -155,17 +187,30 @@ const char* getName(void* element) {
 }
 
 // returns one of: input, output, internal, none
-// if value is missing, the default internal is returned
+// if value is missing, the default internal is returned.
+// The other causalities of FMI 2.0 are returned as internal.
 Enu getCausality(void* scalarVariable) {
     ValueStatus vs;
-    return getEnumValue(scalarVariable, att_causality, &vs);
+    Enu causality = getEnumValue(scalarVariable, att_causality, &vs);
+    switch (causality) {
+        case enu_parameter:
+        case enu_calculatedParameter:
+        case enu_local:
+        case enu_independent:
+            return enu_internal;
+        default:
+            return causality;
+    }
 }
 
 // returns one of constant, parameter, discrete, continuous
-// if value is missing, the default continuous is returned
+// if value is missing, the default continuous is returned.
+// The variabilities fixed and tunable of FMI 2.0 are returned as parameter.
 Enu getVariability(void* scalarVariable) {
     ValueStatus vs;
-    return getEnumValue(scalarVariable, att_variability, &vs);
+    Enu variability = getEnumValue(scalarVariable, att_variability, &vs);
+    if (variability == enu_fixed || variability == enu_tunable) return enu_parameter;
+    return variability;
 }
 
 // returns one of noAlias, alias, negatedAlias
@@ -281,6 +326,42 @@ double getNominal(ModelDescription* md, fmiValueReference vr){
     return vs==valueDefined ? nominal : 1.0;
 }
 
+// Get the Unknowns of the given list of the ModelStructure of FMI 2.0:
+// Outputs, Derivatives or InitialUnknowns. Returns NULL if there is none.
+Element** getUnknowns(ModelDescription* md, Elm e) {
+    int i;
+    ListElement** lists = md->modelStructure ? (ListElement**)md->modelStructure->list : NULL;
+    if (lists)
+    for (i=0; lists[i]; i++) {
+        if (lists[i]->type == e) return lists[i]->list;
+    }
+    return NULL;
+}
+
+// Get the variable of the given index in FMI 2.0, starting with 1.
+// Returns NULL if there is none.
+ScalarVariable* getVariableByIndex(ModelDescription* md, int index) {
+    int i;
+    if (index < 1 || !md->modelVariables) return NULL;
+    for (i=0; i<index-1 && md->modelVariables[i]; i++);
+    return md->modelVariables[i];
+}
+
+// Get the indices of the variables an Unknown depends on, at most size.
+// Returns the number of dependencies, or -1 if they are not declared,
+// which means that the Unknown may depend on all known variables.
+int getDependencies(void* unknown, int dependencies[], int size) {
+    int n = 0, k, pos;
+    const char* value = getString(unknown, att_dependencies);
+    if (!value) return -1;
+    while (sscanf(value, "%d%n", &k, &pos) == 1) {
+        if (n < size) dependencies[n] = k;
+        n++;
+        value += pos;
+    }
+    return n;
+}
+
 // ------------------------------------------------------------------------- 
 // Various checks that log an error and stop the parser 
 
@@ -361,6 +442,7 @@ AstNodeType getAstNodeType(Elm e){
     case elm_fmiModelDescription: 
         return astModelDescription;
     case elm_Type:
+    case elm_SimpleType:
         return astType;
     case elm_ScalarVariable:
         return astScalarVariable;
@@ -372,6 +454,10 @@ AstNodeType getAstNodeType(Elm e){
     case elm_VendorAnnotations:
     case elm_ModelVariables:
     case elm_DirectDependency:
+    case elm_ModelStructure:
+    case elm_Outputs:
+    case elm_Derivatives:
+    case elm_InitialUnknowns:
         return astListElement;
     default:
         return astElement; 
@@ -417,11 +503,27 @@ Element* newElement(Elm type, int size, const char** attr) {
 // ------------------------------------------------------------------------- 
 // callback functions called by the XML parser 
 
+// Returns 1 if the element of the given name is skipped with its content
+static int isSkipped(const char* elm) {
+    int i;
+    if (skipDepth > 0) return 1;
+    if (!version2) return 0;
+    for (i=0; skippedNames2[i]; i++) {
+        if (!strcmp(elm, skippedNames2[i])) return 1;
+    }
+    return 0;
+}
+
 // Create and push a new element node
 static void XMLCALL startElement(void *context, const char *elm, const char **attr) {
     Elm el;
     void* e;
-    int size;
+    int size, i;
+    if (isSkipped(elm)) {
+        skipDepth++;
+        skipData = 1;
+        return;
+    }
     el = checkElement(elm);
     if (el==-1) return; // error
     skipData = (el != elm_Name); // skip element content for all elements but Name
@@ -433,6 +535,11 @@ static void XMLCALL startElement(void *context, const char *elm, const char **at
         case astModelDescription: size = sizeof(ModelDescription); break;
 		default: assert(0);
     }
+    if (el == elm_fmiModelDescription) {
+        for (i=0; attr[i]; i+=2) {
+            if (!strcmp(attr[i], attNames[att_fmiVersion])) version2 = attr[i+1][0] == '2';
+        }
+    }
     e = newElement(el, size, attr);
     checkPointer(e); 
     stackPush(stack, e);
@@ -456,10 +563,27 @@ static void popList(Elm e) {
     return; // success only if list!=NULL    
 }
 
+// Pop all elements above the ListElement of the given type from the stack
+// and add them to this ListElement, which remains on the stack.
+static void popChildren(Elm e) {
+    int n = 0;
+    Element* elm = stackPop(stack);
+    while (elm->type != e) {
+        elm = stackPop(stack);
+        n++;
+    }
+    stackPush(stack, elm);
+    ((ListElement*)elm)->list = (Element**)stackLastPopedAsArray0(stack, n);
+}
+
 // Pop the children from the stack and
 // check for correct type and sequence of children
 static void XMLCALL endElement(void *context, const char *elm) {
     Elm el;
+    if (skipDepth > 0) {
+        skipDepth--;
+        return;
+    }
     el = checkElement(elm);
     switch(el) {        
         case elm_fmiModelDescription: 
@@ -470,9 +594,17 @@ static void XMLCALL endElement(void *context, const char *elm) {
                  Element*      de = NULL;     // NULL or DefaultExperiment
                  ListElement** va = NULL;     // NULL or list of Tools
                  ScalarVariable** mv = NULL;  // NULL or list of ScalarVariable
+                 Element*      me = NULL;     // NULL or ModelExchange
+                 ListElement*  ms = NULL;     // NULL or ModelStructure
                  ListElement* child;
 
                  child = checkPop(ANY_TYPE);
+                 if (!child) return;
+                 if (child->type == elm_ModelStructure){
+                     ms = child;
+                     child = checkPop(ANY_TYPE);
+                     if (!child) return;
+                 }
                  if (child->type == elm_ModelVariables){
                      mv = (ScalarVariable**)child->list;
                      free(child);
@@ -502,6 +634,11 @@ static void XMLCALL endElement(void *context, const char *elm) {
                      child = checkPop(ANY_TYPE);
                      if (!child) return;
                  }
+                 if (child->type == elm_ModelExchange){
+                     me = (Element*)child;
+                     child = checkPop(ANY_TYPE);
+                     if (!child) return;
+                 }
                  if (!checkElementType(child, elm_fmiModelDescription)) return;
                  md = (ModelDescription*)child;
                  md->modelVariables = mv;
@@ -509,15 +646,18 @@ static void XMLCALL endElement(void *context, const char *elm) {
                  md->defaultExperiment = de;
                  md->typeDefinitions = td;
                  md->unitDefinitions = ud;
+                 md->modelExchange = me;
+                 md->modelStructure = ms;
                  stackPush(stack, md);
                  break;
             }
         case elm_Type:
+        case elm_SimpleType:
             {
                 Type* tp;
                 Element* ts = checkPop(ANY_TYPE);
                 if (!ts) return;
-                if (!checkPeek(elm_Type)) return;
+                if (!checkPeek(el)) return;
                 tp = (Type*)stackPeek(stack);
                 switch (ts->type) {
                     case elm_RealType:
@@ -563,11 +703,15 @@ static void XMLCALL endElement(void *context, const char *elm) {
         case elm_ModelVariables:    popList(elm_ScalarVariable); break;
         case elm_VendorAnnotations: popList(elm_Tool);break;
         case elm_Tool:              popList(elm_Annotation); break;
-        case elm_TypeDefinitions:   popList(elm_Type); break;
+        case elm_TypeDefinitions:   popList(version2 ? elm_SimpleType : elm_Type); break;
         case elm_EnumerationType:   popList(elm_Item); break;
         case elm_UnitDefinitions:   popList(elm_BaseUnit); break;
         case elm_BaseUnit:          popList(elm_DisplayUnitDefinition); break;
         case elm_DirectDependency:  popList(elm_Name); break;
+        case elm_Outputs:
+        case elm_Derivatives:
+        case elm_InitialUnknowns:   popList(elm_Unknown); break;
+        case elm_ModelStructure:    popChildren(elm_ModelStructure); break;
         case elm_Name:
             {
                  // Exception: the name value is represented as element content.
@@ -658,6 +802,8 @@ void printElement(int indent, void* element){
             printElement(indent, md->defaultExperiment);
             printList(indent, (void **)md->vendorAnnotations);
             printList(indent, (void **)md->modelVariables);
+            printElement(indent, md->modelExchange);
+            printElement(indent, md->modelStructure);
             break;
     }
 }
@@ -699,6 +845,8 @@ void freeElement(void* element){
             freeElement(md->defaultExperiment);
             freeList((void **)md->vendorAnnotations);
             freeList((void **)md->modelVariables);
+            freeElement(md->modelExchange);
+            freeElement(md->modelStructure);
             break;
     }
     // free the struct
@@ -713,6 +861,175 @@ static void freeList(void** list){
     free(list);
 }
 
+// ------------------------------------------------------------------------- 
+// Completion of a model description of FMI 2.0
+
+// Returns 0 to indicate error
+static int appendAttribute(Element* e, Att a, const char* value) {
+    const char** att = realloc(e->attributes, (e->n + 2) * sizeof(char*));
+    if (!checkPointer(att)) return 0;
+    e->attributes = att;
+    att[e->n] = attNames[a];
+    att[e->n + 1] = strdup(value);
+    if (!checkPointer(att[e->n + 1])) return 0;
+    e->n += 2;
+    return 1; // success
+}
+
+static int baseType(ScalarVariable* sv) {
+    return sv->typeSpec->type == elm_Enumeration ? elm_Integer : sv->typeSpec->type;
+}
+
+// order variables by base type, value reference and position
+static int compareVariables(const void* a, const void* b) {
+    ScalarVariable* v1 = **(ScalarVariable***)a;
+    ScalarVariable* v2 = **(ScalarVariable***)b;
+    fmiValueReference vr1 = getValueReference(v1);
+    fmiValueReference vr2 = getValueReference(v2);
+    if (baseType(v1) != baseType(v2)) return baseType(v1) - baseType(v2);
+    if (vr1 != vr2) return vr1 < vr2 ? -1 : 1;
+    return *(ScalarVariable***)a < *(ScalarVariable***)b ? -1 : 1;
+}
+
+// Add the attributes of FMI 1.0 that the simulator uses.
+// Returns 0 to indicate error
+static int completeModelDescription2(ModelDescription* md) {
+    int i, n = 0;
+    char buffer[32];
+    ScalarVariable*** sorted;
+    Element** derivatives = getUnknowns(md, elm_Derivatives);
+    const char* modelId = md->modelExchange ? getString(md->modelExchange, att_modelIdentifier) : NULL;
+    if (!modelId) {
+        printf("The FMU does not support Model Exchange\n");
+        return 0;
+    }
+    for (i=0; derivatives && derivatives[i]; i++);
+    sprintf(buffer, "%d", i);
+    if (!appendAttribute((Element*)md, att_modelIdentifier, modelId)
+            || !appendAttribute((Element*)md, att_numberOfContinuousStates, buffer)) return 0;
+    if (!getString(md, att_numberOfEventIndicators)
+            && !appendAttribute((Element*)md, att_numberOfEventIndicators, "0")) return 0;
+
+    // the first variable of each value reference is the one not marked as alias
+    if (md->modelVariables) for (n=0; md->modelVariables[n]; n++);
+    sorted = (ScalarVariable***)calloc(n + 1, sizeof(ScalarVariable**));
+    if (!checkPointer(sorted)) return 0;
+    for (i=0; i<n; i++) sorted[i] = &md->modelVariables[i];
+    qsort(sorted, n, sizeof(ScalarVariable**), compareVariables);
+    for (i=1; i<n; i++) {
+        ScalarVariable* sv = *sorted[i];
+        ScalarVariable* prev = *sorted[i-1];
+        if (baseType(sv) == baseType(prev) && getValueReference(sv) == getValueReference(prev)
+                && !appendAttribute((Element*)sv, att_alias, enuNames[enu_alias])) {
+            free(sorted);
+            return 0;
+        }
+    }
+    free(sorted);
+    return 1; // success
+}
+
+// ------------------------------------------------------------------------- 
+// Model description built from the table of variables of a dll
+
+static const Elm tableTypes[] = { elm_Real, elm_Integer, elm_Boolean, elm_String };
+static const Enu tableCausalities[] = { enu_input, enu_output, enu_internal, enu_none };
+static const Enu tableVariabilities[] = { enu_constant, enu_parameter, enu_discrete, enu_continuous };
+static const Enu tableAliases[] = { enu_noAlias, enu_alias, enu_negatedAlias };
+
+// Returns NULL to indicate error
+static ScalarVariable* newTableVariable(const fmiModelVariable* v) {
+    char buffer[32];
+    ScalarVariable* sv = (ScalarVariable*)calloc(1, sizeof(ScalarVariable));
+    if (!checkPointer(sv)) return NULL;
+    sv->type = elm_ScalarVariable;
+    sprintf(buffer, "%u", v->vr);
+    if (!appendAttribute((Element*)sv, att_name, v->name)
+            || !appendAttribute((Element*)sv, att_valueReference, buffer)
+            || !appendAttribute((Element*)sv, att_causality, enuNames[tableCausalities[v->causality]])
+            || !appendAttribute((Element*)sv, att_variability, enuNames[tableVariabilities[v->variability]])
+            || !appendAttribute((Element*)sv, att_alias, enuNames[tableAliases[v->alias]])) {
+        freeElement(sv);
+        return NULL;
+    }
+    sv->typeSpec = (Element*)calloc(1, sizeof(Element));
+    if (!checkPointer(sv->typeSpec)) {
+        freeElement(sv);
+        return NULL;
+    }
+    sv->typeSpec->type = tableTypes[v->type];
+    if (v->hasStart) {
+        switch (v->type) {
+            case fmiTypeReal:    sprintf(buffer, "%.17g", v->start); break;
+            case fmiTypeInteger: sprintf(buffer, "%d", (int)v->start); break;
+            case fmiTypeBoolean: strcpy(buffer, v->start ? "true" : "false"); break;
+            default: buffer[0] = 0; break;
+        }
+        if (!appendAttribute(sv->typeSpec, att_start, v->type == fmiTypeString 
+                && v->startString ? v->startString : buffer)) {
+            freeElement(sv);
+            return NULL;
+        }
+    }
+    if (v->type == fmiTypeReal && v->nominal != 1) {
+        sprintf(buffer, "%.17g", v->nominal);
+        if (!appendAttribute(sv->typeSpec, att_nominal, buffer)) {
+            freeElement(sv);
+            return NULL;
+        }
+    }
+    return sv;
+}
+
+// Returns NULL to indicate failure, also if the table has another version.
+// The receiver must call freeElement(md) to release AST memory.
+ModelDescription* newModelDescription(const fmiModelVariables* table) {
+    int i;
+    char buffer[32];
+    ModelDescription* md;
+    if (table->version != fmiModelVariablesVersion || table->size != sizeof(fmiModelVariable)
+            || !table->modelIdentifier || !table->guid)
+        return NULL;
+    for (i=0; i<table->numberOfVariables; i++) {
+        const fmiModelVariable* v = &table->variables[i];
+        if (!v->name || (unsigned)v->type > fmiTypeString || (unsigned)v->causality > fmiCausalityNone
+                || (unsigned)v->variability > fmiVariabilityContinuous || (unsigned)v->alias > fmiNegatedAlias) {
+            printf("Invalid variable %d in the table of model %s\n", i, table->modelIdentifier);
+            return NULL;
+        }
+    }
+    md = (ModelDescription*)calloc(1, sizeof(ModelDescription));
+    if (!checkPointer(md)) return NULL;
+    md->type = elm_fmiModelDescription;
+    md->modelVariables = (ScalarVariable**)calloc(table->numberOfVariables + 1, sizeof(ScalarVariable*));
+    if (!checkPointer(md->modelVariables)
+            || !appendAttribute((Element*)md, att_fmiVersion, "1.0")
+            || !appendAttribute((Element*)md, att_modelName, table->modelIdentifier)
+            || !appendAttribute((Element*)md, att_modelIdentifier, table->modelIdentifier)
+            || !appendAttribute((Element*)md, att_guid, table->guid)) {
+        freeElement(md);
+        return NULL;
+    }
+    sprintf(buffer, "%d", table->numberOfContinuousStates);
+    if (!appendAttribute((Element*)md, att_numberOfContinuousStates, buffer)) {
+        freeElement(md);
+        return NULL;
+    }
+    sprintf(buffer, "%d", table->numberOfEventIndicators);
+    if (!appendAttribute((Element*)md, att_numberOfEventIndicators, buffer)) {
+        freeElement(md);
+        return NULL;
+    }
+    for (i=0; i<table->numberOfVariables; i++) {
+        md->modelVariables[i] = newTableVariable(&table->variables[i]);
+        if (!md->modelVariables[i]) {
+            freeElement(md);
+            return NULL;
+        }
+    }
+    return md; // success
+}
+
 // ------------------------------------------------------------------------- 
 // Entry function parse() of the XML parser 
 
@@ -731,6 +1048,8 @@ ModelDescription* parse(const char* xmlPath) {
     ModelDescription* md = NULL;
     FILE *file;
     int done = 0;
+    version2 = 0;
+    skipDepth = 0;
     stack = stackNew(100, 10);
     if (!checkPointer(stack)) return NULL;  // failure
     parser = XML_ParserCreate(NULL);
@@ -760,6 +1079,10 @@ ModelDescription* parse(const char* xmlPath) {
     md = stackPop(stack);
     assert(stackIsEmpty(stack));
     cleanup(file);
+    if (version2 && !completeModelDescription2(md)) {
+        freeElement(md);
+        return NULL; // failure
+    }
     //printElement(1, md); // debug
     return md; // success if all refs are valid    
 }
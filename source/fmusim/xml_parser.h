@@ -12,15 +12,16 @@
 #define XML_STATIC 
 #include "expat.h"
 #include "fmiModelTypes.h"
+#include "fmiModelVariables.h"
 #include "stack.h"
 
-#define SIZEOF_ELM 25
+#define SIZEOF_ELM 32
 extern const char *elmNames[SIZEOF_ELM];
 
-#define SIZEOF_ATT 34
+#define SIZEOF_ATT 52
 extern const char *attNames[SIZEOF_ATT];
 
-#define SIZEOF_ENU 13
+#define SIZEOF_ENU 21
 extern const char *enuNames[SIZEOF_ENU];
 
 // Attributes
@@ -28,7 +29,9 @@ typedef enum {
     elm_fmiModelDescription,elm_UnitDefinitions,elm_BaseUnit,elm_DisplayUnitDefinition,elm_TypeDefinitions,
     elm_Type,elm_RealType,elm_IntegerType,elm_BooleanType,elm_StringType,elm_EnumerationType,elm_Item,
     elm_DefaultExperiment,elm_VendorAnnotations,elm_Tool,elm_Annotation,elm_ModelVariables,elm_ScalarVariable,
-    elm_DirectDependency,elm_Name,elm_Real,elm_Integer,elm_Boolean,elm_String,elm_Enumeration
+    elm_DirectDependency,elm_Name,elm_Real,elm_Integer,elm_Boolean,elm_String,elm_Enumeration,
+    elm_ModelExchange,elm_SimpleType,elm_ModelStructure,elm_Outputs,elm_Derivatives,elm_InitialUnknowns,
+    elm_Unknown
 } Elm;
 
 // Attributes
@@ -37,13 +40,20 @@ typedef enum {
   att_min,att_max,att_nominal,att_declaredType,att_start,att_fixed,att_startTime,att_stopTime,att_tolerance,att_value,
   att_valueReference,att_variability,att_causality,att_alias,att_modelName,att_modelIdentifier,att_guid,att_author,
   att_version,att_generationTool,att_generationDateAndTime,att_variableNamingConvention,att_numberOfContinuousStates,
-  att_numberOfEventIndicators,att_input
+  att_numberOfEventIndicators,att_input,att_copyright,att_license,att_needsExecutionTool,
+  att_completedIntegratorStepNotNeeded,att_canBeInstantiatedOnlyOncePerProcess,
+  att_canNotUseMemoryManagementFunctions,att_canGetAndSetFMUstate,att_canSerializeFMUstate,
+  att_providesDirectionalDerivative,att_unbounded,att_stepSize,att_initial,
+  att_canHandleMultipleSetPerTimeInstant,att_derivative,att_reinit,att_index,att_dependencies,
+  att_dependenciesKind
 } Att;
 
 // Enumeration values
 typedef enum {
     enu_flat,enu_structured,enu_constant,enu_parameter,enu_discrete,enu_continuous,
-    enu_input,enu_output,enu_internal,enu_none,enu_noAlias,enu_alias,enu_negatedAlias    
+    enu_input,enu_output,enu_internal,enu_none,enu_noAlias,enu_alias,enu_negatedAlias,
+    enu_fixed,enu_tunable,enu_local,enu_calculatedParameter,enu_independent,enu_exact,enu_approx,
+    enu_calculated
 } Enu;
 
 // AST node for element 
@@ -64,7 +74,7 @@ typedef struct {
     Element** list;    // null-terminated array of pointers to elements, not null
 } ListElement;
 
-// AST node for element Type
+// AST node for element Type, and SimpleType of FMI 2.0
 typedef struct {
     Elm type;          // element type 
     const char** attributes; // null or n attribute value strings
@@ -91,6 +101,8 @@ typedef struct {
     Element*      defaultExperiment;  // NULL or DefaultExperiment
     ListElement** vendorAnnotations;  // NULL or null-terminated list of Tools
     ScalarVariable** modelVariables;  // NULL or null-terminated list of ScalarVariable
+    Element*      modelExchange;      // NULL or ModelExchange, FMI 2.0 only
+    ListElement*  modelStructure;     // NULL or ModelStructure with lists of Unknowns, FMI 2.0 only
 } ModelDescription;
 
 // types of AST nodes used to represent an element
@@ -111,6 +123,7 @@ typedef enum {
 
 // Public methods: Parsing and low-level AST access
 ModelDescription* parse(const char* xmlPath);
+ModelDescription* newModelDescription(const fmiModelVariables* table);
 const char* getString(void* element, Att a);
 double getDouble     (void* element, Att a, ValueStatus* vs);
 int getInt           (void* element, Att a, ValueStatus* vs);
@@ -120,6 +133,7 @@ Enu getEnumValue     (void* element, Att a, ValueStatus* vs);
 void freeElement     (void* element);
 
 // Convenience methods for AST access. To be used afer successful validation only.
+int getFmiVersion(ModelDescription* md);
 const char* getModelIdentifier(ModelDescription* md);
 int getNumberOfStates(ModelDescription* md);
 int getNumberOfEventIndicators(ModelDescription* md);
@@ -136,6 +150,9 @@ const char * getDescription(ModelDescription* md, ScalarVariable* sv);
 const char * getVariableAttributeString(ModelDescription* md, fmiValueReference vr, Elm type, Att a);
 double getVariableAttributeDouble(ModelDescription* md, fmiValueReference vr, Elm type, Att a, ValueStatus* vs);
 double getNominal(ModelDescription* md, fmiValueReference vr);
+Element** getUnknowns(ModelDescription* md, Elm e);
+ScalarVariable* getVariableByIndex(ModelDescription* md, int index);
+int getDependencies(void* unknown, int dependencies[], int size);
 
 #endif // xml_parser_h
 
@@ -25,6 +25,14 @@
 // - if k is the vr of a real state, then k+1 is the vr of its derivative
 #define counter_ 0
 
+// define the table of variables returned by fmiGetModelVariables,
+// in the order of modelDescription.xml
+// fields: name, vr, type, causality, variability, alias, hasStart, start,
+// start of a string, nominal
+#define MODEL_VARIABLES { \
+    { "counter", counter_, fmiTypeInteger, fmiCausalityOutput, fmiVariabilityContinuous, fmiNoAlias, fmiTrue, 1, NULL, 1 } \
+}
+
 // called by fmiInstantiateModel
 // Set values for all variables that define a start value
 // Settings used unless changed by fmiSetX before fmiInitialize
@@ -0,0 +1,72 @@
+/* ---------------------------------------------------------------------------*
+ * fmiModelVariables.h
+ * Non-standard extension of FMI 1.0: a static, versioned table of the
+ * variables of a model, exported by its dll. A simulator that finds the
+ * table, with the GUID of modelDescription.xml, can use it instead of
+ * parsing the model description.
+ * (c) 2026 FMU SDK contributors
+ * ---------------------------------------------------------------------------*/
+
+#ifndef fmiModelVariables_h
+#define fmiModelVariables_h
+
+#include "fmiModelTypes.h"
+
+// layout of fmiModelVariables and fmiModelVariable, incremented on change
+#define fmiModelVariablesVersion 1
+
+typedef enum {
+    fmiTypeReal,
+    fmiTypeInteger,
+    fmiTypeBoolean,
+    fmiTypeString
+} fmiBaseType;
+
+typedef enum {
+    fmiCausalityInput,
+    fmiCausalityOutput,
+    fmiCausalityInternal,
+    fmiCausalityNone
+} fmiCausality;
+
+typedef enum {
+    fmiVariabilityConstant,
+    fmiVariabilityParameter,
+    fmiVariabilityDiscrete,
+    fmiVariabilityContinuous
+} fmiVariability;
+
+typedef enum {
+    fmiNoAlias,
+    fmiAlias,
+    fmiNegatedAlias
+} fmiAliasKind;
+
+// one ScalarVariable of the model description
+typedef struct {
+    fmiString name;
+    fmiValueReference vr;
+    fmiBaseType type;
+    fmiCausality causality;
+    fmiVariability variability;
+    fmiAliasKind alias;
+    fmiBoolean hasStart;
+    fmiReal start;              // start value of a Real, Integer or Boolean
+    fmiString startString;      // start value of a String
+    fmiReal nominal;            // of a Real, 1 if not declared
+} fmiModelVariable;
+
+// the attributes of fmiModelDescription and the variables, in the order
+// of the model description
+typedef struct {
+    int version;                // fmiModelVariablesVersion
+    int size;                   // sizeof(fmiModelVariable)
+    fmiString modelIdentifier;
+    fmiString guid;
+    int numberOfContinuousStates;
+    int numberOfEventIndicators;
+    int numberOfVariables;
+    const fmiModelVariable* variables;
+} fmiModelVariables;
+
+#endif // fmiModelVariables_h
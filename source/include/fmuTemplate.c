@@ -495,4 +495,94 @@ fmiStatus fmiTerminate(fmiComponent c){
     return fmiOK;
 }
 
+// ---------------------------------------------------------------------------
+// Non-standard extension: get and set the internal state of a model instance
+// ---------------------------------------------------------------------------
+
+// the state consists of the variables, the signs of the event indicators
+// and the time. Strings are copied as pointers.
+#define STATE_SIZE (NUMBER_OF_REALS * sizeof(fmiReal) + NUMBER_OF_INTEGERS * sizeof(fmiInteger) \
+        + NUMBER_OF_BOOLEANS * sizeof(fmiBoolean) + NUMBER_OF_STRINGS * sizeof(fmiString) \
+        + NUMBER_OF_EVENT_INDICATORS * sizeof(fmiBoolean) + sizeof(fmiReal))
+
+size_t fmiGetModelStateSize(fmiComponent c) {
+    return STATE_SIZE;
+}
+
+fmiStatus fmiGetModelState(fmiComponent c, void* state, size_t size) {
+    ModelInstance* comp = (ModelInstance *)c;
+    char* p = (char*)state;
+    if (invalidState(comp, "fmiGetModelState", modelInitialized))
+         return fmiError;
+    if (nullPointer(comp, "fmiGetModelState", "state", state))
+         return fmiError;
+    if (size < STATE_SIZE) {
+        comp->functions.logger(c, comp->instanceName, fmiError, "error", 
+                "fmiGetModelState: Buffer of %d bytes too small", (int)size);
+        return fmiError;
+    }
+    if (comp->loggingOn) comp->functions.logger(c, comp->instanceName, fmiOK, "log", 
+            "fmiGetModelState");
+    memcpy(p, comp->r, NUMBER_OF_REALS * sizeof(fmiReal));
+    p += NUMBER_OF_REALS * sizeof(fmiReal);
+    memcpy(p, comp->i, NUMBER_OF_INTEGERS * sizeof(fmiInteger));
+    p += NUMBER_OF_INTEGERS * sizeof(fmiInteger);
+    memcpy(p, comp->b, NUMBER_OF_BOOLEANS * sizeof(fmiBoolean));
+    p += NUMBER_OF_BOOLEANS * sizeof(fmiBoolean);
+    memcpy(p, comp->s, NUMBER_OF_STRINGS * sizeof(fmiString));
+    p += NUMBER_OF_STRINGS * sizeof(fmiString);
+    memcpy(p, comp->isPositive, NUMBER_OF_EVENT_INDICATORS * sizeof(fmiBoolean));
+    p += NUMBER_OF_EVENT_INDICATORS * sizeof(fmiBoolean);
+    memcpy(p, &comp->time, sizeof(fmiReal));
+    return fmiOK;
+}
 
+fmiStatus fmiSetModelState(fmiComponent c, const void* state, size_t size) {
+    ModelInstance* comp = (ModelInstance *)c;
+    const char* p = (const char*)state;
+    if (invalidState(comp, "fmiSetModelState", modelInitialized))
+         return fmiError;
+    if (nullPointer(comp, "fmiSetModelState", "state", state))
+         return fmiError;
+    if (size < STATE_SIZE) {
+        comp->functions.logger(c, comp->instanceName, fmiError, "error", 
+                "fmiSetModelState: Buffer of %d bytes too small", (int)size);
+        return fmiError;
+    }
+    if (comp->loggingOn) comp->functions.logger(c, comp->instanceName, fmiOK, "log", 
+            "fmiSetModelState");
+    memcpy(comp->r, p, NUMBER_OF_REALS * sizeof(fmiReal));
+    p += NUMBER_OF_REALS * sizeof(fmiReal);
+    memcpy(comp->i, p, NUMBER_OF_INTEGERS * sizeof(fmiInteger));
+    p += NUMBER_OF_INTEGERS * sizeof(fmiInteger);
+    memcpy(comp->b, p, NUMBER_OF_BOOLEANS * sizeof(fmiBoolean));
+    p += NUMBER_OF_BOOLEANS * sizeof(fmiBoolean);
+    memcpy(comp->s, p, NUMBER_OF_STRINGS * sizeof(fmiString));
+    p += NUMBER_OF_STRINGS * sizeof(fmiString);
+    memcpy(comp->isPositive, p, NUMBER_OF_EVENT_INDICATORS * sizeof(fmiBoolean));
+    p += NUMBER_OF_EVENT_INDICATORS * sizeof(fmiBoolean);
+    memcpy(&comp->time, p, sizeof(fmiReal));
+    return fmiOK;
+}
+
+// ---------------------------------------------------------------------------
+// Non-standard extension: the table of variables, see fmiModelVariables.h
+// ---------------------------------------------------------------------------
+
+#ifdef MODEL_VARIABLES
+#define fmiQuote(name)  #name
+#define fmiQuoteB(name) fmiQuote(name)
+
+static const fmiModelVariable modelVariables[] = MODEL_VARIABLES;
+
+static const fmiModelVariables modelVariableTable = {
+    fmiModelVariablesVersion, sizeof(fmiModelVariable),
+    fmiQuoteB(MODEL_IDENTIFIER), MODEL_GUID,
+    NUMBER_OF_STATES, NUMBER_OF_EVENT_INDICATORS,
+    sizeof(modelVariables) / sizeof(fmiModelVariable), modelVariables
+};
+
+const fmiModelVariables* fmiGetModelVariables() {
+    return &modelVariableTable;
+}
+#endif
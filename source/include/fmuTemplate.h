@@ -8,6 +8,7 @@
 #include <string.h>
 #include <assert.h>
 #include "fmiModelFunctions.h"
+#include "fmiModelVariables.h"
 
 // macros used to define variables
 #define  r(vr) comp->r[vr]
@@ -39,5 +40,18 @@ typedef struct {
     ModelState state;
 } ModelInstance;
 
-
+// Non-standard extension of FMI 1.0, used by fmusim to roll back a simulation:
+// copy the internal state of an initialized instance to or from a buffer
+#define fmiGetModelStateSize fmiFullName(_fmiGetModelStateSize)
+#define fmiGetModelState     fmiFullName(_fmiGetModelState)
+#define fmiSetModelState     fmiFullName(_fmiSetModelState)
+DllExport size_t    fmiGetModelStateSize(fmiComponent c);
+DllExport fmiStatus fmiGetModelState(fmiComponent c, void* state, size_t size);
+DllExport fmiStatus fmiSetModelState(fmiComponent c, const void* state, size_t size);
+
+// Non-standard extension of FMI 1.0, used by fmusim to skip parsing the model
+// description: the table of variables defined by the includer as MODEL_VARIABLES.
+// The function is exported only if MODEL_VARIABLES is defined.
+#define fmiGetModelVariables fmiFullName(_fmiGetModelVariables)
+DllExport const fmiModelVariables* fmiGetModelVariables();
 
@@ -0,0 +1,84 @@
+/* ---------------------------------------------------------------------------*
+ * Synthetic FMU for benchmarks - N_STATES / 2 harmonic oscillators.
+ *   der(p_i) =  w_i * q_i
+ *   der(q_i) = -w_i * p_i
+ *   with w_i = 1 + 2 * i / N_STATES, p_i(0) = 1 and q_i(0) = 0.
+ * Event indicator j is p_(j mod N_STATES/2), so each of the N_INDICATORS
+ * indicators causes a state event every half period of its oscillator.
+ * The events change no state, they only cost the event handling.
+ * N_STATES, even, and N_INDICATORS are given by the Makefile, which also
+ * generates modelDescription.xml and synthStates.h for them.
+ * ---------------------------------------------------------------------------*/
+
+// define class name and unique id
+#define MODEL_IDENTIFIER synth
+#define MODEL_GUID "{8c4e810f-3df3-4a00-8276-176fa3c9f010}"
+
+// define model size
+#define NUMBER_OF_REALS (2 * N_STATES)
+#define NUMBER_OF_INTEGERS 0
+#define NUMBER_OF_BOOLEANS 0
+#define NUMBER_OF_STRINGS 0
+#define NUMBER_OF_STATES N_STATES
+#define NUMBER_OF_EVENT_INDICATORS N_INDICATORS
+
+// include fmu header files, typedefs and macros
+#include "fmuTemplate.h"
+
+// define all model variables and their value references
+// conventions used here:
+// - state k has vr 2k, its derivative 2k+1
+// - oscillator i has the states p_i = 2i and q_i = 2i+1
+#define p_(i) (4 * (i))
+#define q_(i) (4 * (i) + 2)
+#define N_OSCILLATORS (N_STATES / 2)
+
+// define state vector as vector of value references, { 0, 2, 4, ... }
+#include "synthStates.h"
+
+// called by fmiInstantiateModel
+// Set values for all variables that define a start value
+// Settings used unless changed by fmiSetX before fmiInitialize
+void setStartValues(ModelInstance *comp) {
+    int i;
+    for (i=0; i<N_OSCILLATORS; i++) {
+        r(p_(i)) = 1;
+        r(q_(i)) = 0;
+    }
+    for (i=0; i<N_INDICATORS; i++) pos(i) = 1;
+}
+
+// called by fmiInitialize() after setting eventInfo to defaults
+// Used to set the first time event, if any.
+void initialize(ModelInstance* comp, fmiEventInfo* eventInfo) {
+}
+
+// called by fmiGetReal, fmiGetContinuousStates and fmiGetDerivatives
+fmiReal getReal(ModelInstance* comp, fmiValueReference vr){
+    int k = vr / 2;                  // the state of vr or its derivative
+    int i = k / 2;                   // its oscillator
+    fmiReal w = 1 + 2.0 * i / N_STATES;
+    if (vr % 2 == 0) return r(vr);
+    return k % 2 == 0 ? w * r(q_(i)) : -w * r(p_(i));
+}
+
+// offset for event indicator, adds hysteresis and prevents z=0 at restart 
+#define EPS_INDICATORS 1e-14
+
+fmiReal getEventIndicator(ModelInstance* comp, int z) {
+    return r(p_(z % N_OSCILLATORS)) + (pos(z) ? EPS_INDICATORS : -EPS_INDICATORS);
+}
+
+// Used to set the next time event, if any.
+void eventUpdate(ModelInstance* comp, fmiEventInfo* eventInfo) {
+    int j;
+    for (j=0; j<N_INDICATORS; j++) pos(j) = r(p_(j % N_OSCILLATORS)) > 0;
+    eventInfo->iterationConverged  = fmiTrue;
+    eventInfo->stateValueReferencesChanged = fmiFalse;
+    eventInfo->stateValuesChanged  = fmiFalse;
+    eventInfo->terminateSimulation = fmiFalse;
+    eventInfo->upcomingTimeEvent   = fmiFalse;
+} 
+
+// include code that implements the FMI based on the above definitions
+#include "fmuTemplate.c"
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Generate modelDescription.xml and synthStates.h of synth.c for
+# $1 states and $2 event indicators
+n=$1
+m=$2
+k=0
+states=""
+{
+    echo '<?xml version="1.0" encoding="ISO-8859-1"?>'
+    echo '<fmiModelDescription'
+    echo '  fmiVersion="1.0"'
+    echo '  modelName="synth"'
+    echo '  modelIdentifier="synth"'
+    echo '  guid="{8c4e810f-3df3-4a00-8276-176fa3c9f010}"'
+    echo "  numberOfContinuousStates=\"$n\""
+    echo "  numberOfEventIndicators=\"$m\">"
+    echo '<ModelVariables>'
+    while [ $k -lt $n ]; do
+        i=$((k / 2))
+        if [ $((k % 2)) -eq 0 ]; then name=p$i; start=1; else name=q$i; start=0; fi
+        echo "  <ScalarVariable name=\"$name\" valueReference=\"$((2 * k))\">"
+        echo "     <Real start=\"$start\" fixed=\"true\"/>"
+        echo '  </ScalarVariable>'
+        echo "  <ScalarVariable name=\"der($name)\" valueReference=\"$((2 * k + 1))\">"
+        echo '     <Real/>'
+        echo '  </ScalarVariable>'
+        states="$states${states:+, }$((2 * k))"
+        k=$((k + 1))
+    done
+    echo '</ModelVariables>'
+    echo '</fmiModelDescription>'
+} > modelDescription.xml
+echo "#define STATES { $states }" > synthStates.h
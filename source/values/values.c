@@ -36,6 +36,21 @@
 // define state vector as vector of value references
 #define STATES { x_ }
 
+// define the table of variables returned by fmiGetModelVariables,
+// in the order of modelDescription.xml
+// fields: name, vr, type, causality, variability, alias, hasStart, start,
+// start of a string, nominal
+#define MODEL_VARIABLES { \
+    { "x",          x_,          fmiTypeReal,    fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias, fmiTrue,  1, NULL,      1 }, \
+    { "der(x)",     der_x_,      fmiTypeReal,    fmiCausalityInternal, fmiVariabilityContinuous, fmiNoAlias, fmiFalse, 0, NULL,      1 }, \
+    { "int_in",     int_in_,     fmiTypeInteger, fmiCausalityInput,    fmiVariabilityContinuous, fmiNoAlias, fmiTrue,  2, NULL,      1 }, \
+    { "int_out",    int_out_,    fmiTypeInteger, fmiCausalityOutput,   fmiVariabilityContinuous, fmiNoAlias, fmiTrue,  0, NULL,      1 }, \
+    { "bool_in",    bool_in_,    fmiTypeBoolean, fmiCausalityInput,    fmiVariabilityContinuous, fmiNoAlias, fmiTrue,  1, NULL,      1 }, \
+    { "bool_out",   bool_out_,   fmiTypeBoolean, fmiCausalityOutput,   fmiVariabilityContinuous, fmiNoAlias, fmiFalse, 0, NULL,      1 }, \
+    { "string_in",  string_in_,  fmiTypeString,  fmiCausalityInput,    fmiVariabilityContinuous, fmiNoAlias, fmiTrue,  0, "QTronic", 1 }, \
+    { "string_out", string_out_, fmiTypeString,  fmiCausalityOutput,   fmiVariabilityContinuous, fmiNoAlias, fmiFalse, 0, NULL,      1 } \
+}
+
 const char* month[] = {
     "jan","feb","march","april","may","june","july",
     "august","sept","october","november","december"